@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <triqs/arrays.hpp>
+
+using namespace triqs::arrays;
+
+// ===== Assignment of an expression of arrays, real and complex
+
+static void ArrayExprAssignReal(benchmark::State &state) {
+  long n = state.range(0);
+  array<double, 2> A(n, n), B(n, n), C(n, n);
+  A() = 1.5;
+  B() = -2;
+  for (auto _ : state) {
+    C() = 2 * A + B * 3 - A / 4;
+    benchmark::DoNotOptimize(C.data_start());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * 3 * n * n * sizeof(double));
+}
+BENCHMARK(ArrayExprAssignReal)->RangeMultiplier(4)->Range(1 << 4, 1 << 10);
+
+static void ArrayExprAssignComplex(benchmark::State &state) {
+  long n = state.range(0);
+  array<dcomplex, 2> A(n, n), B(n, n), C(n, n);
+  A() = 1.5 + 1i;
+  B() = -2i;
+  for (auto _ : state) {
+    C() = 2 * A + B * 3 - A / 4;
+    benchmark::DoNotOptimize(C.data_start());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * 3 * n * n * sizeof(dcomplex));
+}
+BENCHMARK(ArrayExprAssignComplex)->RangeMultiplier(4)->Range(1 << 4, 1 << 10);
+
+// ===== Same expression on a strided view (every second column)
+
+static void ArrayExprAssignStrided(benchmark::State &state) {
+  long n = state.range(0);
+  array<double, 2> A(n, 2 * n), B(n, 2 * n), C(n, 2 * n);
+  A() = 1.5;
+  B() = -2;
+  auto _s = range(0, 2 * n, 2);
+  for (auto _ : state) {
+    C(range(), _s) = 2 * A(range(), _s) + B(range(), _s) * 3 - A(range(), _s) / 4;
+    benchmark::DoNotOptimize(C.data_start());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * 3 * n * n * sizeof(double));
+}
+BENCHMARK(ArrayExprAssignStrided)->RangeMultiplier(4)->Range(1 << 4, 1 << 10);
+
+BENCHMARK_MAIN();
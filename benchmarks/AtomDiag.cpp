@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <triqs/atom_diag/atom_diag.hpp>
+#include <triqs/hilbert_space/fundamental_operator_set.hpp>
+#include <triqs/operators/many_body_operator.hpp>
+
+using namespace triqs::arrays;
+using namespace triqs::operators;
+using triqs::hilbert_space::fundamental_operator_set;
+
+// Kanamori Hamiltonian for n_orb orbitals, with a hopping between orbitals 0 and 1
+static auto make_kanamori(int n_orb, double U, double J, double t) {
+  auto orbs = range(n_orb);
+  many_body_operator_real h;
+  for (int o : orbs) h += U * n("up", o) * n("dn", o);
+  for (int o1 : orbs)
+    for (int o2 : orbs) {
+      if (o1 == o2) continue;
+      h += (U - 2 * J) * n("up", o1) * n("dn", o2);
+      h += -J * c_dag("up", o1) * c_dag("dn", o1) * c("up", o2) * c("dn", o2);
+      h += -J * c_dag("up", o1) * c_dag("dn", o2) * c("up", o2) * c("dn", o1);
+      if (o2 < o1) h += (U - 3 * J) * (n("up", o1) * n("up", o2) + n("dn", o1) * n("dn", o2));
+    }
+  for (auto s : {"up", "dn"}) h += t * (c_dag(s, 0) * c(s, 1) + c_dag(s, 1) * c(s, 0));
+  return h;
+}
+
+static auto make_fops(int n_orb) {
+  fundamental_operator_set fops;
+  for (auto s : {"dn", "up"})
+    for (int o : range(n_orb)) fops.insert(s, o);
+  return fops;
+}
+
+// ===== Construction with the automatic partition of the Hilbert space
+
+static void AtomDiagConstruct(benchmark::State &state) {
+  int n_orb = state.range(0);
+  auto h    = make_kanamori(n_orb, 3.0, 0.3, 0.1);
+  auto fops = make_fops(n_orb);
+  for (auto _ : state) {
+    auto ad = triqs::atom_diag::atom_diag<false>(h, fops);
+    benchmark::DoNotOptimize(ad.get_gs_energy());
+  }
+}
+BENCHMARK(AtomDiagConstruct)->DenseRange(2, 4)->Unit(benchmark::kMillisecond);
+
+// ===== Construction with the partition by the quantum numbers N_up, N_dn
+
+static void AtomDiagConstructQN(benchmark::State &state) {
+  int n_orb = state.range(0);
+  auto h    = make_kanamori(n_orb, 3.0, 0.3, 0.1);
+  auto fops = make_fops(n_orb);
+  many_body_operator_real N_up, N_dn;
+  for (int o : range(n_orb)) {
+    N_up += n("up", o);
+    N_dn += n("dn", o);
+  }
+  for (auto _ : state) {
+    auto ad = triqs::atom_diag::atom_diag<false>(h, fops, {N_up, N_dn});
+    benchmark::DoNotOptimize(ad.get_gs_energy());
+  }
+}
+BENCHMARK(AtomDiagConstructQN)->DenseRange(2, 4)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <triqs/det_manip/det_manip.hpp>
+#include <triqs/mc_tools/random_generator.hpp>
+
+// A smooth antiperiodic kernel, as for the hybridization function of a CT-HYB calculation
+struct fun {
+  double operator()(double x, double y) const {
+    double beta = 10.0, epsi = 0.1;
+    double tau  = x - y;
+    bool s      = (tau > 0);
+    tau         = (s ? tau : beta + tau);
+    double r    = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (M_PI / beta) / std::sin(M_PI * r);
+  }
+};
+
+// A matrix of size n, with random times
+static auto make_det(long n, triqs::mc_tools::random_generator &RNG) {
+  triqs::det_manip::det_manip<fun> D{fun{}, 100};
+  while (D.size() < n) {
+    long s = D.size();
+    if (std::abs(D.try_insert(RNG(s + 1), RNG(s + 1), RNG(10.0), RNG(10.0))) > 1e-3)
+      D.complete_operation();
+    else
+      D.reject_last_try();
+  }
+  return D;
+}
+
+// ===== Insertion of a row and a column, followed by their removal : the matrix is unchanged
+
+static void DetManipInsertRemove(benchmark::State &state) {
+  triqs::mc_tools::random_generator RNG("mt19937", 23432);
+  auto D = make_det(state.range(0), RNG);
+  for (auto _ : state) {
+    long s = D.size(), i = RNG(s + 1), j = RNG(s + 1);
+    benchmark::DoNotOptimize(D.try_insert(i, j, RNG(10.0), RNG(10.0)));
+    D.complete_operation();
+    benchmark::DoNotOptimize(D.try_remove(i, j));
+    D.complete_operation();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+}
+BENCHMARK(DetManipInsertRemove)->RangeMultiplier(2)->Range(8, 256);
+
+// ===== Ratio of the determinants for an insertion, rejected : the typical Monte Carlo case
+
+static void DetManipTryInsert(benchmark::State &state) {
+  triqs::mc_tools::random_generator RNG("mt19937", 23432);
+  auto D = make_det(state.range(0), RNG);
+  for (auto _ : state) {
+    long s = D.size();
+    benchmark::DoNotOptimize(D.try_insert(RNG(s + 1), RNG(s + 1), RNG(10.0), RNG(10.0)));
+    D.reject_last_try();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(DetManipTryInsert)->RangeMultiplier(2)->Range(8, 256);
+
+// ===== Same, for a batch of 16 candidates with a single gemm. Items are the candidates.
+
+static void DetManipTryInsertBatch(benchmark::State &state) {
+  triqs::mc_tools::random_generator RNG("mt19937", 23432);
+  auto D = make_det(state.range(0), RNG);
+  std::vector<double> X(16), Y(16);
+  for (auto _ : state) {
+    long s = D.size();
+    for (int k = 0; k < 16; ++k) {
+      X[k] = RNG(10.0);
+      Y[k] = RNG(10.0);
+    }
+    benchmark::DoNotOptimize(D.try_insert_batch(RNG(s + 1), RNG(s + 1), X, Y));
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * 16);
+}
+BENCHMARK(DetManipTryInsertBatch)->RangeMultiplier(2)->Range(8, 256);
+
+// ===== Insertion and removal of two rows and columns
+
+static void DetManipInsertRemove2(benchmark::State &state) {
+  triqs::mc_tools::random_generator RNG("mt19937", 23432);
+  auto D = make_det(state.range(0), RNG);
+  for (auto _ : state) {
+    long s = D.size();
+    benchmark::DoNotOptimize(D.try_insert2(0, s + 1, 0, s + 1, RNG(10.0), RNG(10.0), RNG(10.0), RNG(10.0)));
+    D.complete_operation();
+    benchmark::DoNotOptimize(D.try_remove2(0, s + 1, 0, s + 1));
+    D.complete_operation();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+}
+BENCHMARK(DetManipInsertRemove2)->RangeMultiplier(2)->Range(8, 256);
+
+BENCHMARK_MAIN();
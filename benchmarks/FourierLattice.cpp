@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::arrays;
+using namespace triqs::gfs;
+using namespace triqs::lattice;
+
+// G(iw, k) with a 2x2 matrix target on a n_k x n_k lattice
+static auto make_g_iw_r(long n_k) {
+  auto bl      = bravais_lattice{make_unit_matrix<double>(2)};
+  auto iw_mesh = gf_mesh<imfreq>{10.0, Fermion, 64};
+  auto r_mesh  = gf_mesh<cyclic_lattice>{bl, int(n_k)};
+  auto g       = gf<cartesian_product<imfreq, cyclic_lattice>, matrix_valued>{{iw_mesh, r_mesh}, {2, 2}};
+  g.data()     = 1.0;
+  return g;
+}
+
+// ===== Strided transform of the lattice mesh, directly on the gf data
+
+static void FourierLatticeStrided(benchmark::State &state) {
+  auto g_iw_r = make_g_iw_r(state.range(0));
+  auto g_iw_k = make_gf_from_fourier<1>(g_iw_r);
+  for (auto _ : state) g_iw_k() = fourier<1>(g_iw_r);
+  state.SetBytesProcessed(int64_t(state.iterations()) * g_iw_r.data().size() * sizeof(dcomplex));
+}
+BENCHMARK(FourierLatticeStrided)->RangeMultiplier(2)->Range(1 << 3, 1 << 6);
+
+// ===== Same transform through the flatten_2d copies
+
+static void FourierLatticeFlatten(benchmark::State &state) {
+  auto g_iw_r = make_g_iw_r(state.range(0));
+  auto g_iw_k = make_gf_from_fourier<1>(g_iw_r);
+  auto k_mesh = std::get<1>(g_iw_k.mesh());
+  for (auto _ : state) {
+    auto g_flat  = flatten_gf_2d<1>(make_const_view(g_iw_r));
+    auto gk_flat = _fourier_impl(k_mesh, make_const_view(g_flat));
+    auto g_rot   = rotate_index_view(g_iw_k.data(), 1);
+    for (auto const &k : k_mesh) {
+      auto g_rot_sl = g_rot(k.linear_index(), ellipsis());
+      auto gk_col   = gk_flat.data()(k.linear_index(), ellipsis());
+      assign_foreach(g_rot_sl, [&gk_col, c = 0ll](auto &&... i) mutable { return gk_col(c++); });
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * g_iw_r.data().size() * sizeof(dcomplex));
+}
+BENCHMARK(FourierLatticeFlatten)->RangeMultiplier(2)->Range(1 << 3, 1 << 6);
+
+BENCHMARK_MAIN();
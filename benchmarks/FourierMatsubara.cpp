@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::arrays;
+using namespace triqs::gfs;
+
+// G(tau) with a 2x2 matrix target and the known moments of the tail, on a mesh with n_tau points
+static auto make_g_tau(long n_tau) {
+  double beta = 100;
+  auto gt     = gf<imtime, matrix_valued>{{beta, Fermion, n_tau}, {2, 2}};
+  for (auto const &t : gt.mesh()) gt[t] = -exp(-double(t)) / (1 + exp(-beta)) * make_unit_matrix<dcomplex>(2);
+  return gt;
+}
+
+// ===== Direct transform : tail subtraction, fft, tail addition
+
+static void FourierMatsubaraDirect(benchmark::State &state) {
+  auto gt    = make_g_tau(state.range(0));
+  auto gw    = make_gf_from_fourier(gt, (gt.mesh().size() - 1) / 6);
+  auto km    = make_zero_tail(gt, 4);
+  km(1, 0, 0) = 1;
+  km(1, 1, 1) = 1;
+  for (auto _ : state) gw() = fourier(gt, km);
+  state.SetItemsProcessed(int64_t(state.iterations()) * gt.mesh().size());
+}
+BENCHMARK(FourierMatsubaraDirect)->RangeMultiplier(2)->Range(10000, 100000);
+
+// ===== Inverse transform
+
+static void FourierMatsubaraInverse(benchmark::State &state) {
+  auto gt    = make_g_tau(state.range(0));
+  auto gw    = make_gf_from_fourier(gt, (gt.mesh().size() - 1) / 6);
+  auto km    = make_zero_tail(gw, 4);
+  km(1, 0, 0) = 1;
+  km(1, 1, 1) = 1;
+  for (auto _ : state) gt() = fourier(gw, km);
+  state.SetItemsProcessed(int64_t(state.iterations()) * gt.mesh().size());
+}
+BENCHMARK(FourierMatsubaraInverse)->RangeMultiplier(2)->Range(10000, 100000);
+
+BENCHMARK_MAIN();
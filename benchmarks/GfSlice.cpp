@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::arrays;
+using namespace triqs::gfs;
+
+// ===== Access to the target matrix at each point of the mesh
+
+static void GfSliceMeshPoint(benchmark::State &state) {
+  auto g   = gf<imfreq, matrix_valued>{{10.0, Fermion, int(state.range(0))}, {4, 4}};
+  g.data() = 1;
+  for (auto _ : state) {
+    dcomplex r = 0;
+    for (auto const &w : g.mesh()) r += g[w](1, 2);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * g.mesh().size());
+}
+BENCHMARK(GfSliceMeshPoint)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+
+// ===== Slice of the target, copied into a new gf
+
+static void GfSliceTarget(benchmark::State &state) {
+  auto g   = gf<imfreq, matrix_valued>{{10.0, Fermion, int(state.range(0))}, {4, 4}};
+  g.data() = 1;
+  for (auto _ : state) {
+    auto g_sl = gf<imfreq, matrix_valued>{slice_target(g, range(0, 2), range(0, 2))};
+    benchmark::DoNotOptimize(g_sl.data().data_start());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * g.mesh().size() * 4 * sizeof(dcomplex));
+}
+BENCHMARK(GfSliceTarget)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+
+// ===== Partial evaluation of a two-frequency gf at fixed first frequency
+
+static void GfSlicePartialEval(benchmark::State &state) {
+  int n_iw     = state.range(0);
+  auto iw_mesh = gf_mesh<imfreq>{10.0, Fermion, n_iw};
+  auto g       = gf<cartesian_product<imfreq, imfreq>, scalar_valued>{{iw_mesh, iw_mesh}};
+  g.data()     = 1;
+  for (auto _ : state) {
+    dcomplex r = 0;
+    for (auto const &w : iw_mesh) {
+      auto g_w = g[w, all_t{}];
+      r += g_w[w];
+    }
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * iw_mesh.size());
+}
+BENCHMARK(GfSlicePartialEval)->RangeMultiplier(4)->Range(1 << 4, 1 << 8);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include <triqs/mc_tools/mc_generic.hpp>
+#include <triqs/mc_tools/static_mc_generic.hpp>
+
+// A random walker on the integers
+struct configuration {
+  long x = 0;
+};
+
+// Move the walker by step, accepted with probability proba
+struct move_step {
+  configuration *config;
+  long step;
+  double proba;
+  double attempt() { return proba; }
+  double accept() {
+    config->x += step;
+    return 1;
+  }
+  void reject() {}
+};
+
+struct measure_x {
+  configuration *config;
+  double sum = 0;
+  void accumulate(double sign) { sum += sign * config->x; }
+  void collect_results(mpi::communicator const &) {}
+};
+
+// ===== Throughput of the Metropolis loop : attempt, accept/reject, with n_moves moves to choose from
+
+static void McGenericMoves(benchmark::State &state) {
+  int n_moves       = state.range(0);
+  long length_cycle = 100, n_cycles = 1000;
+  triqs::mc_tools::mc_generic<double> mc("mt19937", 1234, 0);
+  configuration config;
+  for (int m = 0; m < n_moves; ++m) mc.add_move(move_step{&config, (m % 2 ? 1 : -1), 0.5 + 0.5 * m / n_moves}, "move " + std::to_string(m));
+  mc.add_measure(measure_x{&config}, "x", false);
+  for (auto _ : state) mc.accumulate(n_cycles, length_cycle, []() { return false; });
+  state.SetItemsProcessed(int64_t(state.iterations()) * n_cycles * length_cycle);
+}
+BENCHMARK(McGenericMoves)->RangeMultiplier(4)->Range(1, 16);
+
+// ===== Same loop with static_mc_generic, with 2 moves : the moves are inlined in the loop
+
+static void StaticMcGenericMoves(benchmark::State &state) {
+  long length_cycle = 100, n_cycles = 1000;
+  triqs::mc_tools::static_mc_generic<double, move_step, move_step> mc("mt19937", 1234, 0);
+  configuration config;
+  mc.set_moves({move_step{&config, -1, 0.5}, move_step{&config, 1, 0.75}}, {"move 0", "move 1"});
+  mc.add_measure(measure_x{&config}, "x", false);
+  for (auto _ : state) mc.accumulate(n_cycles, length_cycle, []() { return false; });
+  state.SetItemsProcessed(int64_t(state.iterations()) * n_cycles * length_cycle);
+}
+BENCHMARK(StaticMcGenericMoves);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <triqs/mc_tools/random_generator.hpp>
+#include <triqs/mc_tools/counter_based_rng.hpp>
+#include <vector>
+
+const std::vector<std::string> names = {"mt19937", "lagged_fibonacci607", "philox4x32", "threefry4x64"};
+
+// ===== Throughput of random_generator : one double per call, from the buffer
+
+static void RandomGeneratorCall(benchmark::State &state) {
+  triqs::mc_tools::random_generator rng(names[state.range(0)], 1234);
+  state.SetLabel(names[state.range(0)]);
+  double s = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1000; ++i) s += rng();
+  }
+  benchmark::DoNotOptimize(s);
+  state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+BENCHMARK(RandomGeneratorCall)->DenseRange(0, 3);
+
+// ===== Same, with the size of the buffer : {generator, buffer size}
+
+static void RandomGeneratorBufferSize(benchmark::State &state) {
+  triqs::mc_tools::random_generator rng(names[state.range(0)], 1234, 0, state.range(1));
+  state.SetLabel(names[state.range(0)]);
+  double s = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1000; ++i) s += rng();
+  }
+  benchmark::DoNotOptimize(s);
+  state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+BENCHMARK(RandomGeneratorBufferSize)->ArgsProduct({{0, 2}, {64, 256, 1000, 4096}});
+
+// ===== The counter-based engines : uniform one by one, or fill_uniform by blocks
+
+template <typename Engine> static void CounterBasedUniform(benchmark::State &state) {
+  Engine e(1234);
+  std::vector<double> v(1000);
+  for (auto _ : state) {
+    for (auto &x : v) x = e.uniform();
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * v.size());
+}
+BENCHMARK_TEMPLATE(CounterBasedUniform, triqs::mc_tools::RandomGenerators::philox4x32);
+BENCHMARK_TEMPLATE(CounterBasedUniform, triqs::mc_tools::RandomGenerators::threefry4x64);
+
+template <typename Engine> static void CounterBasedFill(benchmark::State &state) {
+  Engine e(1234);
+  std::vector<double> v(1000);
+  for (auto _ : state) {
+    e.fill_uniform(v.data(), v.data() + v.size());
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * v.size());
+}
+BENCHMARK_TEMPLATE(CounterBasedFill, triqs::mc_tools::RandomGenerators::philox4x32);
+BENCHMARK_TEMPLATE(CounterBasedFill, triqs::mc_tools::RandomGenerators::threefry4x64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include <triqs/gfs.hpp>
+
+using namespace triqs::arrays;
+using namespace triqs::gfs;
+
+// G(iw) with three poles on a n_iw mesh, with a 2x2 matrix target
+static auto make_g_iw(int n_iw) {
+  triqs::clef::placeholder<0> iw_;
+  auto g = gf<imfreq, matrix_valued>{{10.0, Fermion, n_iw}, {2, 2}};
+  g(iw_) << 1 / (iw_ - 1) + 0.5 / (iw_ + 2) + 0.2 / (iw_ - 0.3);
+  return g;
+}
+
+// ===== Fit of the high-frequency moments
+
+static void TailFitterFit(benchmark::State &state) {
+  auto g = make_g_iw(state.range(0));
+  for (auto _ : state) {
+    auto [tail, err] = fit_tail(g);
+    benchmark::DoNotOptimize(err);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * g.mesh().size());
+}
+BENCHMARK(TailFitterFit)->RangeMultiplier(4)->Range(1 << 7, 1 << 13);
+
+// ===== Fit with the known 0th and 1st moments
+
+static void TailFitterFitKnownMoments(benchmark::State &state) {
+  auto g     = make_g_iw(state.range(0));
+  auto km    = make_zero_tail(g, 2);
+  km(1, 0, 0) = 1.7;
+  km(1, 1, 1) = 1.7;
+  for (auto _ : state) {
+    auto [tail, err] = fit_tail(g, km);
+    benchmark::DoNotOptimize(err);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * g.mesh().size());
+}
+BENCHMARK(TailFitterFitKnownMoments)->RangeMultiplier(4)->Range(1 << 7, 1 << 13);
+
+BENCHMARK_MAIN();
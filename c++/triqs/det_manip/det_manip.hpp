@@ -23,6 +23,8 @@
 #include <triqs/utility/first_include.hpp>
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <functional>
 #include <numeric>
 #include <cmath>
 #include <triqs/arrays.hpp>
@@ -32,17 +34,69 @@
 #include <triqs/arrays/blas_lapack/ger.hpp>
 #include <triqs/arrays/blas_lapack/gemm.hpp>
 #include <triqs/arrays/blas_lapack/gemv.hpp>
+#include <triqs/arrays/blas_lapack/getrf.hpp>
+#include <triqs/arrays/blas_lapack/getri.hpp>
 #include <triqs/utility/function_arg_ret_type.hpp>
+#include "./log_det.hpp"
 
 namespace triqs {
   namespace det_manip {
 
     namespace blas = arrays::blas;
 
+    /**
+     * A view of values in the order given by a permutation, without copy.
+     * E.g. the x of a det_manip in the order of the rows (cf det_manip::get_x_view).
+     */
+    template <typename T> class permuted_view {
+      std::vector<T> const *values;
+      std::vector<size_t> const *perm;
+
+      public:
+      permuted_view(std::vector<T> const &values, std::vector<size_t> const &perm) : values(&values), perm(&perm) {}
+
+      size_t size() const { return perm->size(); }
+      T const &operator[](size_t i) const { return (*values)[(*perm)[i]]; }
+
+      class const_iterator {
+        permuted_view const *v;
+        size_t i;
+
+        public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T const *;
+        using reference         = T const &;
+
+        const_iterator(permuted_view const *v, size_t i) : v(v), i(i) {}
+        reference operator*() const { return (*v)[i]; }
+        pointer operator->() const { return &(*v)[i]; }
+        const_iterator &operator++() {
+          ++i;
+          return *this;
+        }
+        const_iterator operator++(int) {
+          auto c = *this;
+          ++i;
+          return c;
+        }
+        bool operator==(const_iterator const &other) const { return i == other.i; }
+        bool operator!=(const_iterator const &other) const { return i != other.i; }
+      };
+
+      const_iterator begin() const { return {this, 0}; }
+      const_iterator end() const { return {this, size()}; }
+    };
+
     /**
   * @brief Standard matrix/det manipulations used in several QMC.
+  *
+  * @tparam FunctionType The function f(x,y) giving the elements of the matrix
+  * @tparam LogDet If true, the determinant is kept as log|det| and its phase (cf log_det),
+  *                to avoid its over/underflow for large matrices. The ratios are unchanged.
   */
-    template <typename FunctionType> class det_manip {
+    template <typename FunctionType, bool LogDet = false> class det_manip {
       private:
       using f_tr = utility::function_arg_ret_type<FunctionType>;
       static_assert(f_tr::arity == 2, "det_manip : the function must take two arguments !");
@@ -51,9 +105,8 @@ namespace triqs {
       using x_type     = typename f_tr::template decay_arg<0>::type;
       using y_type     = typename f_tr::template decay_arg<1>::type;
       using value_type = typename f_tr::result_type;
-      // options the det could be kept in a long double to minimize overflow
-      //using det_type = std::conditional_t<std::is_same<value_type, double>::value, long double, std::complex<long double>>;
-      using det_type = value_type;
+      // the det is kept as a log|det| and a phase in the LogDet case, to avoid overflow
+      using det_type = std::conditional_t<LogDet, log_det<value_type>, value_type>;
       static_assert(std::is_floating_point<value_type>::value || triqs::is_complex<value_type>::value,
                     "det_manip : the function must return a floating number or a complex number");
 
@@ -86,18 +139,35 @@ namespace triqs {
       std::vector<x_type> x_values;
       std::vector<y_type> y_values;
       int sign = 1;
-      matrix_type mat_inv;
+      matrix_type mat_inv; // NB : with delayed updates, the inverse is mat_inv + U V, see inv below
       uint64_t n_opts                  = 0;   // count the number of operation
       uint64_t n_opts_max_before_check = 100; // max number of ops before the test of deviation of the det, M^-1 is performed.
+      bool fixed_capacity              = false; // if true, Nmax can not grow : cf set_fixed_capacity
       double singular_threshold = -1; // the test to see if the matrix is singular is abs(det) > singular_threshold. If <0, it is !isnormal(abs(det))
       double precision_warning  = 1.e-8; // bound for warning message in check for singular matrix
       double precision_error    = 1.e-5; // bound for throwing error in check for singular matrix
 
+      public:
+      /// Counters of the control of the numerical drift of the inverse matrix
+      struct drift_stats_t {
+        uint64_t n_checks        = 0; // number of residual estimations (adaptive mode)
+        uint64_t n_regenerations = 0; // number of full regenerations of the inverse
+        double last_drift        = 0; // last estimated drift
+        double max_drift         = 0; // largest estimated drift
+      };
+
+      protected:
+      double drift_tolerance       = -1;  // if > 0, adaptive control of the drift. Cf set_drift_tolerance
+      uint64_t n_opts_max_adaptive = 100; // the current interval between two drift estimations in the adaptive mode
+      uint64_t drift_rng_state     = 0x9E3779B97F4A7C15ull; // for the random vectors of the drift estimation
+      drift_stats_t drift_stats;
+
       private:
       //  ------------     BOOST Serialization ------------
       //  What about f ? Not serialized at the moment.
       friend class boost::serialization::access;
       template <class Archive> void serialize(Archive &ar, const unsigned int version) {
+        flush_delayed_updates();
         ar &Nmax;
         ar &N;
         ar &n_opts;
@@ -110,13 +180,14 @@ namespace triqs {
         ar &col_num;
         ar &x_values;
         ar &y_values;
+        resize_delayed_updates();
       }
 
       /// Write into HDF5
       friend void h5_write(h5::group fg, std::string subgroup_name, det_manip const &g) {
         auto gr = fg.create_group(subgroup_name);
         h5_write(gr, "N", g.N);
-        h5_write(gr, "mat_inv", g.mat_inv);
+        h5_write(gr, "mat_inv", g.mat_inv_with_delayed_updates());
         h5_write(gr, "det", g.det);
         h5_write(gr, "sign", g.sign);
         h5_write(gr, "row_num", g.row_num);
@@ -144,6 +215,8 @@ namespace triqs {
         h5_read(gr, "n_opts", g.n_opts);
         h5_read(gr, "n_opts_max_before_check", g.n_opts_max_before_check);
         h5_read(gr, "singular_threshold", g.singular_threshold);
+        g.n_delayed = 0;
+        g.resize_delayed_updates();
       }
 
       private:
@@ -157,6 +230,7 @@ namespace triqs {
         // ksi = newdet/det
         value_type ksi;
         size_t i, j, ireal, jreal;
+        size_t i_new, j_new; // the positions of the row/col after a change (shift moves)
         void reserve(size_t s) {
           B.resize(s);
           C.resize(s);
@@ -183,25 +257,212 @@ namespace triqs {
           MC() = 0;
         }
         value_type det_ksi() const { return ksi(0, 0) * ksi(1, 1) - ksi(1, 0) * ksi(0, 1); }
+        // ksi <- ksi^-1, in place
+        void invert_ksi() {
+          value_type d = det_ksi();
+          std::swap(ksi(0, 0), ksi(1, 1));
+          ksi(0, 0) /= d;
+          ksi(1, 1) /= d;
+          ksi(0, 1) /= -d;
+          ksi(1, 0) /= -d;
+        }
       };
 
       struct work_data_type_refill {
         std::vector<x_type> x_values;
         std::vector<y_type> y_values;
         matrix_type M;
+        arrays::vector<int> ipiv; // the pivots and the workspace of getrf/getri, to invert M in place
+        vector_type lapack_work;
         void reserve(size_t s) {
           x_values.reserve(s);
           y_values.reserve(s);
-          if (s > first_dim(M)) M.resize(s, s);
+          if (s <= first_dim(M)) return;
+          M.resize(s, s);
+          ipiv.resize(s);
+          value_type lw[2];
+          int info;
+          arrays::lapack::f77::getri(s, M.data_start(), s, ipiv.data_start(), lw, -1, info); // query of the optimal workspace
+          lapack_work.resize(std::max(s, arrays::lapack::r_round(lw[0])));
+        }
+        // LU factorization of M(R, R), R = [0, n), in place. Returns the determinant of M(R, R)
+        det_type lu(size_t n) {
+          auto a   = M(range(0, n), range(0, n));
+          int info = arrays::lapack::getrf(a, ipiv);
+          if (info < 0) TRIQS_RUNTIME_ERROR << "det_manip : failure of getrf lapack routine, info = " << info;
+          det_type d = value_type(1);
+          for (size_t i = 0; i < n; ++i) {
+            d *= a(i, i);
+            if (ipiv(i) != int(i) + 1) d *= value_type(-1);
+          }
+          return d;
+        }
+        // M(R, R) <- M(R, R)^-1, after lu(n)
+        void inverse_from_lu(size_t n) {
+          int info;
+          arrays::lapack::f77::getri(n, M.data_start(), second_dim(M), ipiv.data_start(), lapack_work.data_start(), lapack_work.size(), info);
+          if (info != 0) TRIQS_RUNTIME_ERROR << "det_manip : failure of getri lapack routine, info = " << info;
+        }
+      };
+
+      // The batches of candidates of try_insert_batch, try_change_col_batch.
+      // The candidates are the columns of B, MB = A^(-1)*B and the rows of C.
+      struct work_data_type_batch {
+        std::vector<x_type> x;
+        std::vector<y_type> y;
+        matrix_type B, MB, C;
+        vector_type ratio;
+        size_t i, j, jreal;
+        int kind = NoTry; // the try_xxx_from_batch allowed, NoTry if the batch is outdated
+        void resize(size_t s, size_t n) {
+          if (first_dim(B) == s and second_dim(B) >= n) return;
+          B.resize(s, n);
+          MB.resize(s, n);
+          C.resize(n, s);
+          ratio.resize(n);
+        }
+      };
+
+      // The delayed updates of the inverse matrix : the true inverse is mat_inv + U * V,
+      // U being the first n_delayed columns of U (Nmax x n_delayed_max) and V the first n_delayed rows of V.
+      struct delayed_updates_type {
+        matrix_type U, V;
+        vector_type tmp; // U^T b or V b for a vector b
+        matrix_type tmp2; // same for the 2 columns of a matrix b
+        void resize(size_t s, size_t k) {
+          U.resize(s, k);
+          V.resize(k, s);
+          tmp.resize(k);
+          tmp2.resize(k, 2);
         }
       };
 
       work_data_type1 w1;
       work_data_type2 w2;
       work_data_type_refill w_refill;
+      work_data_type_batch w_batch;
+      size_t n_delayed_max = 0; // maximal rank of the delayed updates. 0 : the updates are applied at once
+      size_t n_delayed     = 0; // current rank of the delayed updates
+      delayed_updates_type w_delayed;
       det_type newdet;
       int newsign;
 
+      private:
+      // ------------------------- Delayed updates -----------------------------------------
+
+      void resize_delayed_updates() { w_delayed.resize(Nmax, n_delayed_max); }
+
+      // A copy of mat_inv with the pending delayed updates applied. The const accessors use it (or inv) and do not flush :
+      // they do not modify the object, and can be called concurrently.
+      matrix_type mat_inv_with_delayed_updates() const {
+        matrix_type r = mat_inv;
+        range R(0, N), K(0, n_delayed);
+        if (n_delayed > 0 and N > 0) blas::gemm(1.0, w_delayed.U(R, K), w_delayed.V(K, R), 1.0, r(R, R));
+        return r;
+      }
+
+      // The element (a, b) of the inverse matrix, in the internal order
+      value_type inv(size_t a, size_t b) const {
+        if (n_delayed == 0) return mat_inv(a, b);
+        value_type r = mat_inv(a, b);
+        for (size_t k = 0; k < n_delayed; ++k) r += w_delayed.U(a, k) * w_delayed.V(k, b);
+        return r;
+      }
+
+      // out = row a (resp. column b) of the inverse matrix, restricted to the out.size() first columns (rows)
+      void inv_row(size_t a, arrays::vector_view<value_type> out) const {
+        range R(0, out.size()), K(0, n_delayed);
+        out = mat_inv(a, R);
+        if (n_delayed > 0) blas::gemv(1.0, w_delayed.V(K, R).transpose(), w_delayed.U(a, K), 1.0, out);
+      }
+
+      void inv_col(size_t b, arrays::vector_view<value_type> out) const {
+        range R(0, out.size()), K(0, n_delayed);
+        out = mat_inv(R, b);
+        if (n_delayed > 0) blas::gemv(1.0, w_delayed.U(R, K), w_delayed.V(K, b), 1.0, out);
+      }
+
+      // out += (U V) b, resp. (U V)^T b, i.e. the pending part of mat_inv * b, resp. mat_inv^T * b
+      void add_delayed_gemv(arrays::vector_const_view<value_type> b, arrays::vector_view<value_type> out) {
+        if (n_delayed == 0) return;
+        range R(0, b.size()), K(0, n_delayed);
+        blas::gemv(1.0, w_delayed.V(K, R), b, 0.0, w_delayed.tmp(K));
+        blas::gemv(1.0, w_delayed.U(R, K), w_delayed.tmp(K), 1.0, out);
+      }
+
+      void add_delayed_gemv_transpose(arrays::vector_const_view<value_type> b, arrays::vector_view<value_type> out) {
+        if (n_delayed == 0) return;
+        range R(0, b.size()), K(0, n_delayed);
+        blas::gemv(1.0, w_delayed.U(R, K).transpose(), b, 0.0, w_delayed.tmp(K));
+        blas::gemv(1.0, w_delayed.V(K, R).transpose(), w_delayed.tmp(K), 1.0, out);
+      }
+
+      // out += (U V) b for b with 2 columns, resp. out += b (U V) for b with 2 rows
+      void add_delayed_gemm(matrix_const_view_type b, matrix_view_type out) {
+        if (n_delayed == 0) return;
+        range R(0, first_dim(b)), K(0, n_delayed), R2(0, 2);
+        blas::gemm(1.0, w_delayed.V(K, R), b, 0.0, w_delayed.tmp2(K, R2));
+        blas::gemm(1.0, w_delayed.U(R, K), w_delayed.tmp2(K, R2), 1.0, out);
+      }
+
+      void add_delayed_gemm_left(matrix_const_view_type b, matrix_view_type out) {
+        if (n_delayed == 0) return;
+        range R(0, second_dim(b)), K(0, n_delayed), R2(0, 2);
+        blas::gemm(1.0, w_delayed.U(R, K).transpose(), b.transpose(), 0.0, w_delayed.tmp2(K, R2));
+        blas::gemm(1.0, w_delayed.tmp2(K, R2).transpose(), w_delayed.V(K, R), 1.0, out);
+      }
+
+      // The new row/col a of the inverse matrix, after an insertion, is 0
+      void zero_inv_row_col(size_t a) {
+        range R(0, N), K(0, n_delayed);
+        mat_inv(R, a) = 0;
+        mat_inv(a, R) = 0;
+        if (n_delayed == 0) return;
+        w_delayed.U(a, K) = 0;
+        w_delayed.V(K, a) = 0;
+      }
+
+      // Exchange rows (resp. cols) a and b of the inverse matrix
+      void swap_inv_rows(size_t a, size_t b) {
+        range R(0, N), K(0, n_delayed);
+        arrays::deep_swap(mat_inv(a, R), mat_inv(b, R));
+        if (n_delayed > 0) arrays::deep_swap(w_delayed.U(a, K), w_delayed.U(b, K));
+      }
+
+      void swap_inv_cols(size_t a, size_t b) {
+        range R(0, N), K(0, n_delayed);
+        arrays::deep_swap(mat_inv(R, a), mat_inv(R, b));
+        if (n_delayed > 0) arrays::deep_swap(w_delayed.V(K, a), w_delayed.V(K, b));
+      }
+
+      // mat_inv += alpha u v^T on the first u.size() rows and cols, at once or delayed
+      void update_inverse(value_type alpha, arrays::vector_const_view<value_type> u, arrays::vector_const_view<value_type> v) {
+        range R(0, u.size());
+        if (n_delayed_max == 0) {
+          blas::ger(alpha, u, v, mat_inv(R, R));
+          return;
+        }
+        if (n_delayed == n_delayed_max) flush_delayed_updates();
+        w_delayed.U(R, n_delayed) = alpha * u;
+        w_delayed.V(n_delayed, R) = v;
+        ++n_delayed;
+      }
+
+      // mat_inv += alpha u v for u with 2 columns and v with 2 rows, at once or delayed
+      void update_inverse(value_type alpha, matrix_const_view_type u, matrix_const_view_type v) {
+        range R(0, first_dim(u));
+        if (n_delayed_max < 2) {
+          flush_delayed_updates();
+          blas::gemm(alpha, u, v, 1.0, mat_inv(R, R));
+          return;
+        }
+        if (n_delayed + 2 > n_delayed_max) flush_delayed_updates();
+        range K2(n_delayed, n_delayed + 2);
+        w_delayed.U(R, K2) = alpha * u;
+        w_delayed.V(K2, R) = v;
+        n_delayed += 2;
+      }
+
       private: // for the move constructor, I need to separate the swap since f may not be defaulted constructed
       void swap_but_f(det_manip &rhs) noexcept {
         using std::swap;
@@ -218,8 +479,17 @@ namespace triqs {
         SW(mat_inv);
         SW(n_opts);
         SW(n_opts_max_before_check);
+        SW(fixed_capacity);
+        SW(drift_tolerance);
+        SW(n_opts_max_adaptive);
+        SW(drift_rng_state);
+        SW(drift_stats);
         SW(w1);
         SW(w2);
+        SW(w_batch);
+        SW(n_delayed_max);
+        SW(n_delayed);
+        SW(w_delayed);
         SW(newdet);
         SW(newsign);
 #undef SW
@@ -241,6 +511,8 @@ namespace triqs {
      */
       void reserve(size_t new_size) {
         if (new_size <= Nmax) return;
+        if (fixed_capacity) TRIQS_RUNTIME_ERROR << "det_manip : the fixed capacity " << Nmax << " is exceeded";
+        flush_delayed_updates();
         matrix_type Mcopy(mat_inv);
         size_t N0 = Nmax;
         Nmax      = new_size;
@@ -252,6 +524,25 @@ namespace triqs {
         y_values.reserve(Nmax);
         w1.reserve(Nmax);
         w2.reserve(Nmax);
+        resize_delayed_updates();
+      }
+
+      /**
+     * Allocate all the buffers once, for matrices up to size nmax (or the current capacity if larger), and forbid any later growth.
+     *
+     * Going beyond nmax is then an error instead of a reallocation. In this mode, the try_xxx,
+     * complete_operation and reject_last_try of a steady-state Monte Carlo make no heap allocation,
+     * including the periodic regeneration of the inverse (cf set_n_operations_before_check),
+     * except for the first call of the batched tries.
+     * get_x_view, get_y_view and inverse_matrix_internal_order give access to the data without copies.
+     *
+     * @param nmax The maximal size of the matrix
+     */
+      void set_fixed_capacity(size_t nmax) {
+        fixed_capacity = false;
+        reserve(nmax);
+        w_refill.reserve(Nmax);
+        fixed_capacity = true;
       }
 
       /// Get the number below which abs(det) is considered 0. If <0, the test will be isnormal(abs(det))
@@ -266,6 +557,28 @@ namespace triqs {
       /// Sets the number of operations done before a check in the dets.
       void set_n_operations_before_check(uint64_t n) { n_opts_max_before_check = n; }
 
+      /**
+     * Adaptive control of the numerical drift of the inverse matrix.
+     *
+     * With tol > 0, the full O(N^3) regeneration of the inverse is not done every n_operations_before_check operations.
+     * Instead, the drift is estimated there at O(N^2) cost from the residual max|M M^-1 v - v| for a random vector v of +-1,
+     * and the inverse is regenerated (and checked) only if it exceeds tol.
+     * The interval between two estimations is adapted : doubled while the drift stays below tol/16 (up to 64 times
+     * n_operations_before_check), halved after a regeneration.
+     *
+     * @param tol The tolerance on the drift. If <= 0 (default), the periodic regeneration is used.
+     */
+      void set_drift_tolerance(double tol) {
+        drift_tolerance     = tol;
+        n_opts_max_adaptive = n_opts_max_before_check;
+      }
+
+      /// Get the tolerance of the adaptive control of the drift. Cf set_drift_tolerance
+      double get_drift_tolerance() const { return drift_tolerance; }
+
+      /// Counters of the checks, regenerations, and estimated drift of the inverse matrix
+      drift_stats_t const &get_drift_stats() const { return drift_stats; }
+
       /// Get the bound for warning messages in the singular tests
       double get_precision_warning() const { return precision_warning; }
 
@@ -278,6 +591,37 @@ namespace triqs {
       /// Set the bound for throwing error in the singular tests
       void set_precision_error(double threshold) { precision_error = threshold; }
 
+      /**
+     * Sets the maximal rank k of the delayed updates of the inverse matrix.
+     *
+     * With k > 0, complete_operation does not update the whole inverse matrix with a rank-1 (rank-2) ger (gemm).
+     * The updates are accumulated as two thin panels U (N x k) and V (k x N), the ratios of the next try_xxx are computed
+     * through them, and they are applied with a single gemm when k updates are pending.
+     * This is faster for large matrices, where the ger are memory bound. The API is unchanged.
+     * The ratios, the determinant with its sign and the inverse matrix are the ones of the immediate updates,
+     * computed in another order : they differ only by rounding errors, amplified by the condition number of the matrix.
+     * The test det_manip_delayed checks an agreement to 1e-10 (relative for the ratios and the determinant)
+     * along random sequences of try, complete and reject.
+     *
+     * @param k Maximal rank of the delayed updates. 0 (default) : the updates are applied at once.
+     */
+      void set_n_delayed_updates(size_t k) {
+        flush_delayed_updates();
+        n_delayed_max = k;
+        resize_delayed_updates();
+      }
+
+      /// Get the maximal rank of the delayed updates
+      size_t get_n_delayed_updates() const { return n_delayed_max; }
+
+      /// Apply the pending delayed updates to the inverse matrix
+      void flush_delayed_updates() {
+        if (n_delayed == 0) return;
+        range R(0, N), K(0, n_delayed);
+        if (N > 0) blas::gemm(1.0, w_delayed.U(R, K), w_delayed.V(K, R), 1.0, mat_inv(R, R));
+        n_delayed = 0;
+      }
+
       /**
      * @brief Constructor.
      *
@@ -317,7 +661,7 @@ namespace triqs {
           for (size_t j = 0; j < N; ++j) mat_inv(i, j) = f(x_values[i], y_values[j]);
         }
         range R(0, N);
-        det           = arrays::determinant(mat_inv(R, R));
+        det           = compute_determinant(mat_inv(R, R));
         mat_inv(R, R) = inverse(mat_inv(R, R));
       }
 
@@ -335,10 +679,12 @@ namespace triqs {
 
       /// Put to size 0 : like a vector
       void clear() {
-        N        = 0;
-        sign     = 1;
-        det      = 1;
-        last_try = NoTry;
+        N            = 0;
+        sign         = 1;
+        det          = 1;
+        last_try     = NoTry;
+        n_delayed    = 0;
+        w_batch.kind = NoTry;
         row_num.clear();
         col_num.clear();
         x_values.clear();
@@ -372,6 +718,12 @@ namespace triqs {
         return res;
       }
 
+      /// Returns a view of all x_values, in the order of the rows, without copy. Invalidated by the next complete_operation
+      permuted_view<x_type> get_x_view() const { return {x_values, row_num}; }
+
+      /// Returns a view of all y_values, in the order of the cols, without copy. Invalidated by the next complete_operation
+      permuted_view<y_type> get_y_view() const { return {y_values, col_num}; }
+
       /**
      * Advanced: Returns the vector of x_values using the INTERNAL STORAGE ORDER,
      * which differs by some permutation from the one given by the user.
@@ -389,7 +741,7 @@ namespace triqs {
       /// Returns the function f
       FunctionType const &get_function() const { return f; }
 
-      /** det M of the current state of the matrix.  */
+      /** det M of the current state of the matrix. A log_det in the LogDet case. */
       det_type determinant() {
         if (is_singular()) regenerate();
         return sign * det;
@@ -397,7 +749,7 @@ namespace triqs {
 
       /** Returns M^{-1}(i,j) */
       // warning : need to invert the 2 permutations: (AP)^-1= P^-1 A^-1.
-      value_type inverse_matrix(int i, int j) const { return mat_inv(col_num[i], row_num[j]); }
+      value_type inverse_matrix(int i, int j) const { return inv(col_num[i], row_num[j]); }
 
       /// Returns the inverse matrix. Warning : this is slow, since it create a new copy, and reorder the lines/cols
       matrix_type inverse_matrix() const {
@@ -411,13 +763,29 @@ namespace triqs {
      * Advanced: Returns the inverse matrix using the INTERNAL STORAGE ORDER.
      * See doc of get_x_internal_order.
      */
-      value_type inverse_matrix_internal_order(int i, int j) const { return mat_inv(i, j); }
+      value_type inverse_matrix_internal_order(int i, int j) const { return inv(i, j); }
+
+      /**
+     * Advanced: Returns the inverse matrix using the INTERNAL STORAGE ORDER.
+     * See doc of get_x_internal_order.
+     * The pending delayed updates are applied first : the view is invalidated by the next complete_operation.
+     */
+      matrix_const_view_type inverse_matrix_internal_order() {
+        flush_delayed_updates();
+        return mat_inv(range(N), range(N));
+      }
 
       /**
      * Advanced: Returns the inverse matrix using the INTERNAL STORAGE ORDER.
      * See doc of get_x_internal_order.
+     * Const version : the object is not modified. Without pending delayed updates, it is a view of the inverse matrix, as the
+     * non const version. With pending delayed updates, it is a view of a new N x N copy, to which the updates are added.
      */
-      matrix_const_view_type inverse_matrix_internal_order() const { return mat_inv(range(N), range(N)); }
+      matrix_const_view_type inverse_matrix_internal_order() const {
+        if (n_delayed == 0) return mat_inv(range(N), range(N));
+        matrix_type r = mat_inv_with_delayed_updates();
+        return r(range(N), range(N)); // the view shares the ownership of the copy
+      }
 
       /// Rebuild the matrix. Warning : this is slow, since it create a new matrix and re-evaluate the function.
       matrix_type matrix() const {
@@ -434,7 +802,7 @@ namespace triqs {
         //for (size_t j=0; j<d.N;j++)
         // f(d.x_values[i], d.y_values[j], d.mat_inv(j,i));
         range R(0, d.N);
-        foreach (d.mat_inv(R, R), [&f, &d](int i, int j) { return f(d.x_values[i], d.y_values[j], d.mat_inv(j, i)); })
+        foreach (d.mat_inv(R, R), [&f, &d](int i, int j) { return f(d.x_values[i], d.y_values[j], d.inv(j, i)); })
           ;
       }
 
@@ -493,6 +861,7 @@ namespace triqs {
         range R(0, N);
         //w1.MB(R) = mat_inv(R,R) * w1.B(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.B(R), 0.0, w1.MB(R));
+        add_delayed_gemv(w1.B(R), w1.MB(R));
         w1.ksi  = f(x, y) - arrays::dot(w1.C(R), w1.MB(R));
         newdet  = det * w1.ksi;
         newsign = ((i + j) % 2 == 0 ? sign : -sign); // since N-i0 + N-j0  = i0+j0 [2]
@@ -517,7 +886,7 @@ namespace triqs {
         if (N == 0) {
           newdet  = ksi;
           newsign = 1;
-          return newdet;
+          return ksi;
         }
 
         // I add the row and col and the end. If the move is rejected,
@@ -529,12 +898,95 @@ namespace triqs {
         range R(0, N);
         //w1.MB(R) = mat_inv(R,R) * w1.B(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.B(R), 0.0, w1.MB(R));
+        add_delayed_gemv(w1.B(R), w1.MB(R));
         w1.ksi  = ksi - arrays::dot(w1.C(R), w1.MB(R));
         newdet  = det * w1.ksi;
         newsign = ((i + j) % 2 == 0 ? sign : -sign); // since N-i0 + N-j0  = i0+j0 [2]
         return w1.ksi * (newsign * sign);            // sign is unity, hence 1/sign == sign
       }
 
+      //------------------------------------------------------------------------------------------
+      public:
+      /**
+     * Ratios of a batch of candidate insertions, of (X[k], Y[k]) at row i and column j.
+     *
+     * The products of the inverse matrix with the new columns of all the candidates are done with a single gemm
+     * instead of one gemv per try_insert. The ratio of the insertion of the same (X[k], Y[k]) at another (i', j')
+     * only differs by a factor (-1)^(i + j + i' + j').
+     *
+     * This routine does NOT make any modification. One of the candidates can then be chosen (e.g. heat bath, multiple-try Metropolis)
+     * with try_insert_from_batch, and completed with complete_operation().
+     *
+     * @return The ratios det Minv_new / det Minv for all candidates. The batch is valid until the next complete_operation().
+     */
+      template <typename ArgumentContainer1, typename ArgumentContainer2>
+      arrays::vector_const_view<value_type> try_insert_batch(size_t i, size_t j, ArgumentContainer1 const &X, ArgumentContainer2 const &Y) {
+        TRIQS_ASSERT(last_try == NoTry);
+        TRIQS_ASSERT(i <= N);
+        TRIQS_ASSERT(j <= N);
+        TRIQS_ASSERT(X.size() == Y.size());
+        if (N == Nmax) reserve(2 * Nmax);
+        flush_delayed_updates();
+
+        size_t n = X.size();
+        w_batch.resize(Nmax, n);
+        w_batch.x.assign(X.begin(), X.end());
+        w_batch.y.assign(Y.begin(), Y.end());
+        w_batch.i    = i;
+        w_batch.j    = j;
+        w_batch.kind = Insert;
+
+        range R(0, N), Rn(0, n);
+        for (size_t k = 0; k < n; ++k)
+          for (size_t r = 0; r < N; ++r) {
+            w_batch.B(r, k) = f(x_values[r], w_batch.y[k]);
+            w_batch.C(k, r) = f(w_batch.x[k], y_values[r]);
+          }
+        if (N > 0) blas::gemm(1.0, mat_inv(R, R), w_batch.B(R, Rn), 0.0, w_batch.MB(R, Rn));
+
+        bool flip = ((i + j) % 2 == 1);
+        for (size_t k = 0; k < n; ++k) {
+          value_type ksi = f(w_batch.x[k], w_batch.y[k]);
+          if (N > 0) ksi -= arrays::dot(w_batch.C(k, R), w_batch.MB(R, k));
+          w_batch.ratio(k) = (flip ? -ksi : ksi);
+        }
+        return w_batch.ratio(Rn);
+      }
+
+      /**
+     * Consider the insertion of the candidate k of the last try_insert_batch.
+     *
+     * Returns the ratio of det Minv_new / det Minv, as try_insert, without recomputing it.
+     * This routine does NOT make any modification. It has to be completed with complete_operation().
+     */
+      value_type try_insert_from_batch(size_t k) {
+        TRIQS_ASSERT(last_try == NoTry);
+        TRIQS_ASSERT(w_batch.kind == Insert);
+        TRIQS_ASSERT(k < w_batch.x.size());
+        last_try = Insert;
+        w1.i     = w_batch.i;
+        w1.j     = w_batch.j;
+        w1.x     = w_batch.x[k];
+        w1.y     = w_batch.y[k];
+        auto r   = w_batch.ratio(k);
+
+        if (N == 0) {
+          newdet  = r;
+          newsign = 1;
+          return r;
+        }
+
+        range R(0, N);
+        w1.B(R)  = w_batch.B(R, k);
+        w1.C(R)  = w_batch.C(k, R);
+        w1.MB(R) = w_batch.MB(R, k);
+        bool flip = ((w1.i + w1.j) % 2 == 1);
+        w1.ksi    = (flip ? -r : r);
+        newdet    = det * w1.ksi;
+        newsign   = (flip ? -sign : sign);
+        return r;
+      }
+
       //------------------------------------------------------------------------------------------
       private:
       void complete_insert() {
@@ -554,6 +1006,7 @@ namespace triqs {
         range R1(0, N);
         //w1.MC(R1) = mat_inv(R1,R1).transpose() * w1.C(R1); //OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R1, R1).transpose(), w1.C(R1), 0.0, w1.MC(R1));
+        add_delayed_gemv_transpose(w1.C(R1), w1.MC(R1));
         w1.MC(N) = -1;
         w1.MB(N) = -1;
 
@@ -574,10 +1027,9 @@ namespace triqs {
         // compute the change to the inverse
         // M += w1.ksi w1.MB w1.MC with BLAS. first put the 0
         range R(0, N);
-        mat_inv(R, N - 1) = 0;
-        mat_inv(N - 1, R) = 0;
+        zero_inv_row_col(N - 1);
         //mat_inv(R,R) += w1.ksi* w1.MB(R) * w1.MC(R)// OPTIMIZE BELOW
-        blas::ger(w1.ksi, w1.MB(R), w1.MC(R), mat_inv(R, R));
+        update_inverse(w1.ksi, w1.MB(R), w1.MC(R));
       }
 
       public:
@@ -655,6 +1107,7 @@ namespace triqs {
         range R(0, N), R2(0, 2);
         //w2.MB(R,R2) = mat_inv(R,R) * w2.B(R,R2); // OPTIMIZE BELOW
         blas::gemm(1.0, mat_inv(R, R), w2.B(R, R2), 0.0, w2.MB(R, R2));
+        add_delayed_gemm(w2.B(R, R2), w2.MB(R, R2));
         //w2.ksi -= w2.C (R2, R) * w2.MB(R, R2); // OPTIMIZE BELOW
         blas::gemm(-1.0, w2.C(R2, R), w2.MB(R, R2), 1.0, w2.ksi);
         auto ksi = w2.det_ksi();
@@ -678,7 +1131,8 @@ namespace triqs {
         // treat empty matrix separately
         if (N == 0) {
           N                = 2;
-          mat_inv(R2, R2)  = inverse(w2.ksi);
+          w2.invert_ksi();
+          mat_inv(R2, R2)  = w2.ksi;
           row_num[w2.i[1]] = 1;
           col_num[w2.j[1]] = 1;
           return;
@@ -687,6 +1141,7 @@ namespace triqs {
         range Ri(0, N);
         //w2.MC(R2,Ri) = w2.C(R2,Ri) * mat_inv(Ri,Ri);// OPTIMIZE BELOW
         blas::gemm(1.0, w2.C(R2, Ri), mat_inv(Ri, Ri), 0.0, w2.MC(R2, Ri));
+        add_delayed_gemm_left(w2.C(R2, Ri), w2.MC(R2, Ri));
         w2.MC(R2, range(N, N + 2)) = -1; // -identity matrix
         w2.MB(range(N, N + 2), R2) = -1; // -identity matrix !
 
@@ -701,12 +1156,13 @@ namespace triqs {
           for (int_type i = N - 2; i >= int_type(w2.j[k]); i--) col_num[i + 1] = col_num[i];
           col_num[w2.j[k]] = N - 1;
         }
-        w2.ksi = inverse(w2.ksi);
+        w2.invert_ksi();
         range R(0, N);
-        mat_inv(R, range(N - 2, N)) = 0;
-        mat_inv(range(N - 2, N), R) = 0;
+        zero_inv_row_col(N - 2);
+        zero_inv_row_col(N - 1);
         //mat_inv(R,R) += w2.MB(R,R2) * (w2.ksi * w2.MC(R2,R)); // OPTIMIZE BELOW
-        blas::gemm(1.0, w2.MB(R, R2), (w2.ksi * w2.MC(R2, R)), 1.0, mat_inv(R, R));
+        blas::gemm(1.0, w2.ksi, w2.MC(R2, R), 0.0, w2.C(R2, R)); // w2.C is free now
+        update_inverse(1.0, w2.MB(R, R2), w2.C(R2, R));
       }
 
       public:
@@ -732,7 +1188,7 @@ namespace triqs {
         // compute the newdet
         // first we resolve the w1.ireal,w1.jreal, with the permutation of the Minv, then we pick up what
         // will become the 'corner' coefficient, if the move is accepted, after the exchange of row and col.
-        w1.ksi   = mat_inv(w1.jreal, w1.ireal);
+        w1.ksi   = inv(w1.jreal, w1.ireal);
         auto ksi = w1.ksi;
         newdet   = det * ksi;
         newsign  = ((i + j) % 2 == 0 ? sign : -sign);
@@ -749,28 +1205,31 @@ namespace triqs {
         // repack the matrix inv_mat
         // swap the rows w1.ireal and N, w1.jreal and N in inv_mat
         // Remember that for M row/col is interchanged by inversion, transposition.
-        {
-          range R(0, N);
-          if (w1.jreal != N - 1) {
-            arrays::deep_swap(mat_inv(w1.jreal, R), mat_inv(N - 1, R));
-            y_values[w1.jreal] = y_values[N - 1];
-          }
+        if (w1.jreal != N - 1) {
+          swap_inv_rows(w1.jreal, N - 1);
+          y_values[w1.jreal] = y_values[N - 1];
+        }
 
-          if (w1.ireal != N - 1) {
-            arrays::deep_swap(mat_inv(R, w1.ireal), mat_inv(R, N - 1));
-            x_values[w1.ireal] = x_values[N - 1];
-          }
+        if (w1.ireal != N - 1) {
+          swap_inv_cols(w1.ireal, N - 1);
+          x_values[w1.ireal] = x_values[N - 1];
         }
 
         N--;
 
         // M <- a - d^-1 b c with BLAS
-        w1.ksi = -1 / mat_inv(N, N);
+        w1.ksi = -1 / inv(N, N);
         ASSERT(std::isfinite(std::abs(w1.ksi)));
         range R(0, N);
 
         //mat_inv(R,R) += w1.ksi, * mat_inv(R,N) * mat_inv(N,R);
-        blas::ger(w1.ksi, mat_inv(R, N), mat_inv(N, R), mat_inv(R, R));
+        if (n_delayed_max == 0)
+          blas::ger(w1.ksi, mat_inv(R, N), mat_inv(N, R), mat_inv(R, R));
+        else {
+          inv_col(N, w1.MB(R));
+          inv_row(N, w1.MC(R));
+          update_inverse(w1.ksi, w1.MB(R), w1.MC(R));
+        }
 
         // modify the permutations
         for (size_t k = w1.i; k < N; k++) { row_num[k] = row_num[k + 1]; }
@@ -825,10 +1284,10 @@ namespace triqs {
         w2.jreal[1] = col_num[w2.j[1]];
 
         // compute the newdet
-        w2.ksi(0, 0) = mat_inv(w2.jreal[0], w2.ireal[0]);
-        w2.ksi(1, 0) = mat_inv(w2.jreal[1], w2.ireal[0]);
-        w2.ksi(0, 1) = mat_inv(w2.jreal[0], w2.ireal[1]);
-        w2.ksi(1, 1) = mat_inv(w2.jreal[1], w2.ireal[1]);
+        w2.ksi(0, 0) = inv(w2.jreal[0], w2.ireal[0]);
+        w2.ksi(1, 0) = inv(w2.jreal[1], w2.ireal[0]);
+        w2.ksi(0, 1) = inv(w2.jreal[0], w2.ireal[1]);
+        w2.ksi(1, 1) = inv(w2.jreal[1], w2.ireal[1]);
         auto ksi     = w2.det_ksi();
         newdet       = det * ksi;
         newsign      = ((i0 + j0 + i1 + j1) % 2 == 0 ? sign : -sign);
@@ -848,22 +1307,20 @@ namespace triqs {
         size_t j_real_max = std::max(w2.jreal[0], w2.jreal[1]);
         size_t j_real_min = std::min(w2.jreal[0], w2.jreal[1]);
 
-        range R(0, N);
-
         if (j_real_max != N - 1) {
-          arrays::deep_swap(mat_inv(j_real_max, R), mat_inv(N - 1, R));
+          swap_inv_rows(j_real_max, N - 1);
           y_values[j_real_max] = y_values[N - 1];
         }
         if (j_real_min != N - 2) {
-          arrays::deep_swap(mat_inv(j_real_min, R), mat_inv(N - 2, R));
+          swap_inv_rows(j_real_min, N - 2);
           y_values[j_real_min] = y_values[N - 2];
         }
         if (i_real_max != N - 1) {
-          arrays::deep_swap(mat_inv(R, i_real_max), mat_inv(R, N - 1));
+          swap_inv_cols(i_real_max, N - 1);
           x_values[i_real_max] = x_values[N - 1];
         }
         if (i_real_min != N - 2) {
-          arrays::deep_swap(mat_inv(R, i_real_min), mat_inv(R, N - 2));
+          swap_inv_cols(i_real_min, N - 2);
           x_values[i_real_min] = x_values[N - 2];
         }
 
@@ -873,11 +1330,23 @@ namespace triqs {
         range Rn(0, N), Rl(N, N + 2);
         //w2.ksi = mat_inv(Rl,Rl);
         //w2.ksi = inverse( w2.ksi);
-        w2.ksi = inverse(mat_inv(Rl, Rl));
-
-        // write explicitely the second product on ksi for speed ?
-        //mat_inv(Rn,Rn) -= mat_inv(Rn,Rl) * (w2.ksi * mat_inv(Rl,Rn)); // OPTIMIZE BELOW
-        blas::gemm(-1.0, mat_inv(Rn, Rl), w2.ksi * mat_inv(Rl, Rn), 1.0, mat_inv(Rn, Rn));
+        if (n_delayed_max == 0) {
+          w2.ksi = mat_inv(Rl, Rl);
+          w2.invert_ksi();
+
+          //mat_inv(Rn,Rn) -= mat_inv(Rn,Rl) * (w2.ksi * mat_inv(Rl,Rn)); // OPTIMIZE BELOW
+          blas::gemm(1.0, w2.ksi, mat_inv(Rl, Rn), 0.0, w2.MC(range(0, 2), Rn));
+          blas::gemm(-1.0, mat_inv(Rn, Rl), w2.MC(range(0, 2), Rn), 1.0, mat_inv(Rn, Rn));
+        } else {
+          for (int k = 0; k < 2; ++k) {
+            inv_col(N + k, w2.MB(Rn, k));
+            inv_row(N + k, w2.MC(k, Rn));
+            for (int l = 0; l < 2; ++l) w2.ksi(k, l) = inv(N + k, N + l);
+          }
+          w2.invert_ksi();
+          blas::gemm(1.0, w2.ksi, w2.MC(range(0, 2), Rn), 0.0, w2.C(range(0, 2), Rn));
+          update_inverse(-1.0, w2.MB(Rn, range(0, 2)), w2.C(range(0, 2), Rn));
+        }
 
         // modify the permutations
         for (size_t k = w2.i[0]; k < w2.i[1] - 1; k++) row_num[k] = row_num[k + 1];
@@ -911,6 +1380,7 @@ namespace triqs {
         TRIQS_ASSERT(j < N);
         TRIQS_ASSERT(j >= 0);
         w1.j     = j;
+        w1.j_new = j;
         last_try = ChangeCol;
         w1.jreal = col_num[j];
         w1.y     = y;
@@ -920,6 +1390,7 @@ namespace triqs {
         range R(0, N);
         //w1.MB(R) = mat_inv(R,R) * w1.MC(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.MC(R), 0.0, w1.MB(R));
+        add_delayed_gemv(w1.MC(R), w1.MB(R));
 
         // compute the newdet
         w1.ksi   = (1 + w1.MB(w1.jreal));
@@ -929,6 +1400,62 @@ namespace triqs {
 
         return ksi; // newsign/sign is unity
       }
+      //------------------------------------------------------------------------------------------
+      public:
+      /**
+     * Ratios of a batch of candidate changes of the column j, with the new y being Y[k].
+     *
+     * As try_insert_batch, with a single gemm for all candidates. One of them can then be chosen
+     * with try_change_col_from_batch, and completed with complete_operation().
+     *
+     * @return The ratios det Minv_new / det Minv for all candidates. The batch is valid until the next complete_operation().
+     */
+      template <typename ArgumentContainer> arrays::vector_const_view<value_type> try_change_col_batch(size_t j, ArgumentContainer const &Y) {
+        TRIQS_ASSERT(last_try == NoTry);
+        TRIQS_ASSERT(j < N);
+        flush_delayed_updates();
+
+        size_t n = Y.size();
+        w_batch.resize(Nmax, n);
+        w_batch.x.clear();
+        w_batch.y.assign(Y.begin(), Y.end());
+        w_batch.j     = j;
+        w_batch.jreal = col_num[j];
+        w_batch.kind  = ChangeCol;
+
+        range R(0, N), Rn(0, n);
+        for (size_t k = 0; k < n; ++k)
+          for (size_t r = 0; r < N; ++r) w_batch.B(r, k) = f(x_values[r], w_batch.y[k]) - f(x_values[r], y_values[w_batch.jreal]);
+        blas::gemm(1.0, mat_inv(R, R), w_batch.B(R, Rn), 0.0, w_batch.MB(R, Rn));
+        for (size_t k = 0; k < n; ++k) w_batch.ratio(k) = 1 + w_batch.MB(w_batch.jreal, k);
+        return w_batch.ratio(Rn);
+      }
+
+      /**
+     * Consider the change of column of the candidate k of the last try_change_col_batch.
+     *
+     * Returns the ratio of det Minv_new / det Minv, as try_change_col, without recomputing it.
+     * This routine does NOT make any modification. It has to be completed with complete_operation().
+     */
+      value_type try_change_col_from_batch(size_t k) {
+        TRIQS_ASSERT(last_try == NoTry);
+        TRIQS_ASSERT(w_batch.kind == ChangeCol);
+        TRIQS_ASSERT(k < w_batch.y.size());
+        last_try = ChangeCol;
+        w1.j     = w_batch.j;
+        w1.j_new = w_batch.j;
+        w1.jreal = w_batch.jreal;
+        w1.y     = w_batch.y[k];
+
+        range R(0, N);
+        w1.MC(R) = w_batch.B(R, k);
+        w1.MB(R) = w_batch.MB(R, k);
+        w1.ksi   = w_batch.ratio(k);
+        newdet   = det * w1.ksi;
+        newsign  = sign;
+        return w1.ksi;
+      }
+
       //------------------------------------------------------------------------------------------
       private:
       void complete_change_col() {
@@ -939,7 +1466,13 @@ namespace triqs {
         // using Shermann Morrison formula.
         // implemented in 2 times : first Bn=0 so that Mnj is not modified ! and then change Mnj
         // Cf notes : simply multiply by -w1.ksi
-        w1.ksi          = -1 / w1.ksi;
+        w1.ksi = -1 / w1.ksi;
+        if (n_delayed_max > 0) { // the same, as a single rank 1 update : the row jreal is multiplied by -w1.ksi
+          w1.MB(w1.jreal) = -(1 + w1.ksi) / w1.ksi;
+          inv_row(w1.jreal, w1.C(R));
+          update_inverse(w1.ksi, w1.MB(R), w1.C(R));
+          return;
+        }
         w1.MB(w1.jreal) = 0;
         //mat_inv(R,R) += w1.ksi * w1.MB(R) * mat_inv(w1.jreal,R)); // OPTIMIZE BELOW
         blas::ger(w1.ksi, w1.MB(R), mat_inv(w1.jreal, R), mat_inv(R, R));
@@ -959,6 +1492,7 @@ namespace triqs {
         TRIQS_ASSERT(i < N);
         TRIQS_ASSERT(i >= 0);
         w1.i     = i;
+        w1.i_new = i;
         last_try = ChangeRow;
         w1.ireal = row_num[i];
         w1.x     = x;
@@ -968,6 +1502,7 @@ namespace triqs {
         range R(0, N);
         //w1.MC(R) = mat_inv(R,R).transpose() * w1.MB(R); // OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R).transpose(), w1.MB(R), 0.0, w1.MC(R));
+        add_delayed_gemv_transpose(w1.MB(R), w1.MC(R));
 
         // compute the newdet
         w1.ksi   = (1 + w1.MC(w1.ireal));
@@ -985,7 +1520,13 @@ namespace triqs {
         // modifying M : M ij += w1.ksi Min Cj
         // using Shermann Morrison formula.
         // impl. Cf case 3
-        w1.ksi          = -1 / w1.ksi;
+        w1.ksi = -1 / w1.ksi;
+        if (n_delayed_max > 0) { // the same, as a single rank 1 update : the col ireal is multiplied by -w1.ksi
+          w1.MC(w1.ireal) = -(1 + w1.ksi) / w1.ksi;
+          inv_col(w1.ireal, w1.B(R));
+          update_inverse(w1.ksi, w1.B(R), w1.MC(R));
+          return;
+        }
         w1.MC(w1.ireal) = 0;
         //mat_inv(R,R) += w1.ksi * mat_inv(R,w1.ireal) * w1.MC(R);
         blas::ger(w1.ksi, mat_inv(R, w1.ireal), w1.MC(R), mat_inv(R, R));
@@ -1010,6 +1551,8 @@ namespace triqs {
         last_try = ChangeRowCol;
         w1.i     = i;
         w1.j     = j;
+        w1.i_new = i;
+        w1.j_new = j;
         w1.ireal = row_num[i];
         w1.jreal = col_num[j];
         w1.x     = x;
@@ -1027,14 +1570,16 @@ namespace triqs {
         // C : X, B : Y
         //w1.C(R) = mat_inv(R,R) * w1.MC(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.MC(R), 0.0, w1.C(R));
+        add_delayed_gemv(w1.MC(R), w1.C(R));
         //w1.B(R) = mat_inv(R,R).transpose() * w1.MB(R); // OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R).transpose(), w1.MB(R), 0.0, w1.B(R));
+        add_delayed_gemv_transpose(w1.MB(R), w1.B(R));
 
         // compute the det_ratio
         auto Xn        = w1.C(w1.jreal);
         auto Yn        = w1.B(w1.ireal);
         auto Z         = arrays::dot(w1.MB(R), w1.C(R));
-        auto Mnn       = mat_inv(w1.jreal, w1.ireal);
+        auto Mnn       = inv(w1.jreal, w1.ireal);
         auto det_ratio = (1 + Xn) * (1 + Yn) - Mnn * Z;
         w1.ksi         = det_ratio;
         newdet         = det * det_ratio;
@@ -1051,7 +1596,7 @@ namespace triqs {
         // FIXME : Use blas for this ? Is it better
         auto Xn  = w1.C(w1.jreal);
         auto Yn  = w1.B(w1.ireal);
-        auto Mnn = mat_inv(w1.jreal, w1.ireal);
+        auto Mnn = inv(w1.jreal, w1.ireal);
 
         auto D   = w1.ksi;        // get back
         auto a   = -(1 + Yn) / D; // D in the notes
@@ -1059,6 +1604,18 @@ namespace triqs {
         auto Z   = arrays::dot(w1.MB(R), w1.C(R)); // FIXME : store this ?
         Z        = Z / D;
         Mnn      = Mnn / D;
+
+        if (n_delayed_max > 0) { // the same, as the rank 2 update X (a Mnj + Mnn Y)^T + Min (b Y + Z Mnj)^T
+          range R2(0, 2);
+          inv_row(w1.jreal, w2.MC(0, R)); // Mnj
+          inv_col(w1.ireal, w2.MB(R, 1)); // Min
+          w2.MB(R, 0) = w1.C(R);
+          w2.MC(1, R) = b * w1.B(R) + Z * w2.MC(0, R);
+          w2.MC(0, R) = a * w2.MC(0, R) + Mnn * w1.B(R);
+          update_inverse(1.0, w2.MB(R, R2), w2.MC(R2, R));
+          return;
+        }
+
         w1.MB(R) = mat_inv(w1.jreal, R); // Mnj
         w1.MC(R) = mat_inv(R, w1.ireal); // Min
 
@@ -1095,7 +1652,7 @@ namespace triqs {
         if (s == 0) {
           w_refill.x_values.clear();
           w_refill.y_values.clear();
-          return 1 / (sign * det);
+          return value_type(1) / (sign * det);
         }
 
         w_refill.reserve(s);
@@ -1107,7 +1664,7 @@ namespace triqs {
         for (size_t i = 0; i < s; ++i)
           for (size_t j = 0; j < s; ++j) w_refill.M(i, j) = f(w_refill.x_values[i], w_refill.y_values[j]);
         range R(0, s);
-        newdet  = arrays::determinant(w_refill.M(R, R));
+        newdet  = compute_determinant(w_refill.M(R, R));
         newsign = 1;
 
         return newdet / (sign * det);
@@ -1137,32 +1694,41 @@ namespace triqs {
 
         range R(0, N);
         mat_inv(R, R) = inverse(w_refill.M(R, R));
+        n_delayed     = 0;
       }
 
       //------------------------------------------------------------------------------------------
       private:
       void _regenerate_with_check(bool do_check, double precision_warning, double precision_error) {
+        flush_delayed_updates();
         if (N == 0) {
           det  = 1;
           sign = 1;
           return;
         }
 
+        // the matrix is built and inverted in place in w_refill.M : no allocation once Nmax is reached
+        TRIQS_ASSERT(last_try != Refill);
+        w_refill.reserve(Nmax);
         range R(0, N);
-        matrix_type res(N, N);
+        auto res = w_refill.M(R, R);
         for (int i = 0; i < N; i++)
           for (int j = 0; j < N; j++) res(i, j) = f(x_values[i], y_values[j]);
-        det = arrays::determinant(res);
+        det = w_refill.lu(N);
 
         if (is_singular()) TRIQS_RUNTIME_ERROR << "ERROR in det_manip regenerate: Determinant is singular";
-        res = inverse(res);
+        w_refill.inverse_from_lu(N);
 
         if (do_check) { // check that mat_inv is close to res
           const bool relative = true;
-          double r            = max_element(abs(res - mat_inv(R, R)));
-          double r2           = max_element(abs(res + mat_inv(R, R)));
-          bool err            = !(r < (relative ? precision_error * r2 : precision_error));
-          bool war            = !(r < (relative ? precision_warning * r2 : precision_warning));
+          double r            = 0, r2 = 0;
+          for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++) {
+              r  = std::max(r, double(std::abs(res(i, j) - mat_inv(i, j))));
+              r2 = std::max(r2, double(std::abs(res(i, j) + mat_inv(i, j))));
+            }
+          bool err = !(r < (relative ? precision_error * r2 : precision_error));
+          bool war = !(r < (relative ? precision_warning * r2 : precision_warning));
           if (err || war) {
             std::cerr << "matrix  = " << matrix() << std::endl;
             std::cerr << "inverse_matrix = " << inverse_matrix() << std::endl;
@@ -1180,23 +1746,72 @@ namespace triqs {
         // since we have the proper inverse, replace the matrix and the det
         mat_inv(R, R) = res;
         n_opts        = 0;
+        ++drift_stats.n_regenerations;
 
-        // find the sign (there must be a better way...)
-        double s = 1.0;
-        arrays::matrix<double> m(N, N);
-        m() = 0.0;
-        for (int i = 0; i < N; i++) m(i, row_num[i]) = 1;
-        s *= arrays::determinant(m);
-        m() = 0.0;
-        for (int i = 0; i < N; i++) m(i, col_num[i]) = 1;
-        s *= arrays::determinant(m);
-        sign = (s > 0 ? 1 : -1);
+        // the sign is the product of the signatures of the permutations row_num and col_num
+        sign = permutation_sign(row_num) * permutation_sign(col_num);
+      }
+
+      // The signature of the permutation p, from the parity of its number of inversions
+      static int permutation_sign(std::vector<size_t> const &p) {
+        bool odd = false;
+        for (size_t i = 0; i < p.size(); ++i)
+          for (size_t j = i + 1; j < p.size(); ++j)
+            if (p[i] > p[j]) odd = !odd;
+        return (odd ? -1 : 1);
       }
 
       void check_mat_inv() { _regenerate_with_check(true, precision_warning, precision_error); }
 
+      // Estimate of the drift max|M M^-1 v - v| for a random v of +-1, in O(N^2). Uses w1.B, w1.C as work space.
+      double estimate_drift() {
+        flush_delayed_updates();
+        if (N == 0) return 0;
+        range R(0, N);
+        for (size_t i = 0; i < N; ++i) {
+          drift_rng_state = drift_rng_state * 6364136223846793005ull + 1442695040888963407ull;
+          w1.B(i)         = ((drift_rng_state >> 63) ? 1 : -1);
+        }
+        blas::gemv(1.0, mat_inv(R, R), w1.B(R), 0.0, w1.C(R));
+        double r = 0;
+        for (size_t i = 0; i < N; ++i) {
+          value_type mw = 0;
+          for (size_t j = 0; j < N; ++j) mw += f(x_values[i], y_values[j]) * w1.C(j);
+          r = std::max(r, double(std::abs(mw - w1.B(i))));
+        }
+        return r;
+      }
+
+      // Adaptive mode : regenerate only if the estimated drift is above the tolerance, and adapt the interval
+      void check_drift() {
+        double drift = estimate_drift();
+        n_opts       = 0;
+        ++drift_stats.n_checks;
+        drift_stats.last_drift = drift;
+        drift_stats.max_drift  = std::max(drift_stats.max_drift, drift);
+        if (drift > drift_tolerance) {
+          check_mat_inv();
+          n_opts_max_adaptive = std::max<uint64_t>(n_opts_max_adaptive / 2, 1);
+        } else if (drift < drift_tolerance / 16)
+          n_opts_max_adaptive = std::min(2 * n_opts_max_adaptive, 64 * n_opts_max_before_check);
+      }
+
+      // The determinant of m, as a det_type. In the LogDet case, from the LU factorization without forming the det itself
+      static det_type compute_determinant(matrix_const_view_type m) {
+        if constexpr (LogDet)
+          return log_determinant<value_type>(m);
+        else
+          return arrays::determinant(m);
+      }
+
       /// it the det 0 ? I.e. (singular_threshold <0 ? not std::isnormal(std::abs(det)) : (std::abs(det)<singular_threshold))
-      bool is_singular() const { return (singular_threshold < 0 ? not std::isnormal(std::abs(det)) : (std::abs(det) < singular_threshold)); }
+      /// In the LogDet case, only an exact 0 (or a nan) is singular for a negative singular_threshold.
+      bool is_singular() const {
+        if constexpr (LogDet)
+          return (singular_threshold < 0 ? not std::isfinite(det.log_abs()) : (det.log_abs() < std::log(singular_threshold)));
+        else
+          return (singular_threshold < 0 ? not std::isnormal(std::abs(det)) : (std::abs(det) < singular_threshold));
+      }
 
       //------------------------------------------------------------------------------------------
       public:
@@ -1211,9 +1826,19 @@ namespace triqs {
         switch (last_try) {
           case (Insert): complete_insert(); break;
           case (Remove): complete_remove(); break;
-          case (ChangeCol): complete_change_col(); break;
-          case (ChangeRow): complete_change_row(); break;
-          case (ChangeRowCol): complete_change_col_row(); break;
+          case (ChangeCol):
+            complete_change_col();
+            move_position(col_num, w1.j, w1.j_new);
+            break;
+          case (ChangeRow):
+            complete_change_row();
+            move_position(row_num, w1.i, w1.i_new);
+            break;
+          case (ChangeRowCol):
+            complete_change_col_row();
+            move_position(row_num, w1.i, w1.i_new);
+            move_position(col_num, w1.j, w1.j_new);
+            break;
           case (Insert2): complete_insert2(); break;
           case (Remove2): complete_remove2(); break;
           case (Refill): complete_refill(); break;
@@ -1224,8 +1849,12 @@ namespace triqs {
         det  = newdet;
         sign = newsign;
         ++n_opts;
-        if (n_opts > n_opts_max_before_check) check_mat_inv();
-        last_try = NoTry;
+        if (drift_tolerance <= 0) {
+          if (n_opts > n_opts_max_before_check) check_mat_inv();
+        } else if (n_opts > n_opts_max_adaptive)
+          check_drift();
+        last_try     = NoTry;
+        w_batch.kind = NoTry; // the matrix has changed
       }
 
       /**
@@ -1234,6 +1863,101 @@ namespace triqs {
      */
       void reject_last_try() { last_try = NoTry; }
 
+      // ----------------- Sorted rows and columns  -----------------
+
+      private:
+      // First position p in [0, N) such that !comp(values[perm[p]], v), by bisection
+      template <typename V, typename T, typename Compare>
+      size_t sorted_position(std::vector<V> const &values, std::vector<size_t> const &perm, T const &v, Compare const &comp) const {
+        size_t lo = 0, hi = N;
+        while (lo < hi) {
+          size_t mid = (lo + hi) / 2;
+          if (comp(values[perm[mid]], v))
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        return lo;
+      }
+
+      // Move the row/col at position from to position to, shifting the ones in between
+      static void move_position(std::vector<size_t> &perm, size_t from, size_t to) {
+        if (from < to)
+          std::rotate(perm.begin() + from, perm.begin() + from + 1, perm.begin() + to + 1);
+        else if (to < from)
+          std::rotate(perm.begin() + to, perm.begin() + from, perm.begin() + from + 1);
+      }
+
+      // The new position of the element at position i, with value v, in a sorted sequence : p or p-1 if it is after i
+      static size_t shifted_position(size_t i, size_t p) { return (p > i ? p - 1 : p); }
+
+      public:
+      /**
+     * Position of the row x, for rows kept sorted with comp, i.e. the first position i with !comp(x_i, x).
+     *
+     * It is a bisection : O(log N). The rows are sorted if all insertions are done at these positions,
+     * e.g. with try_insert_sorted, and the changes of rows with try_shift_row.
+     */
+      template <typename Compare = std::less<>> size_t row_position(x_type const &x, Compare const &comp = {}) const {
+        return sorted_position(x_values, row_num, x, comp);
+      }
+
+      /// Position of the col y, for cols kept sorted with comp. Cf row_position
+      template <typename Compare = std::less<>> size_t col_position(y_type const &y, Compare const &comp = {}) const {
+        return sorted_position(y_values, col_num, y, comp);
+      }
+
+      /**
+     * Consider the insertion of the row x and the col y at their positions in the sorted rows and cols.
+     *
+     * As try_insert(row_position(x, comp), col_position(y, comp), x, y).
+     * This routine does NOT make any modification. It has to be completed with complete_operation().
+     */
+      template <typename Compare = std::less<>> value_type try_insert_sorted(x_type const &x, y_type const &y, Compare const &comp = {}) {
+        return try_insert(row_position(x, comp), col_position(y, comp), x, y);
+      }
+
+      /**
+     * Consider the shift of the row i to the new x, i.e. its change followed by the move of the row to its new position
+     * in the sorted rows.
+     *
+     * It is a rank 1 update as try_change_row, instead of a removal and an insertion.
+     * The move of the row only changes the sign of the det, by (-1)^(i - i_new).
+     * Returns the ratio of det Minv_new / det Minv.
+     * This routine does NOT make any modification. It has to be completed with complete_operation().
+     */
+      template <typename Compare = std::less<>> value_type try_shift_row(size_t i, x_type const &x, Compare const &comp = {}) {
+        auto r   = try_change_row(i, x);
+        w1.i_new = shifted_position(i, row_position(x, comp));
+        if ((i + w1.i_new) % 2 == 0) return r;
+        newsign = -newsign;
+        return -r;
+      }
+
+      /// Consider the shift of the col j to the new y. Cf try_shift_row
+      template <typename Compare = std::less<>> value_type try_shift_col(size_t j, y_type const &y, Compare const &comp = {}) {
+        auto r   = try_change_col(j, y);
+        w1.j_new = shifted_position(j, col_position(y, comp));
+        if ((j + w1.j_new) % 2 == 0) return r;
+        newsign = -newsign;
+        return -r;
+      }
+
+      /**
+     * Consider the shift of the row i and the col j to the new x and y, e.g. of a vertex in time.
+     *
+     * It is a rank 2 update as try_change_col_row, instead of a removal and an insertion. Cf try_shift_row
+     */
+      template <typename Compare = std::less<>>
+      value_type try_shift_col_row(size_t i, size_t j, x_type const &x, y_type const &y, Compare const &comp = {}) {
+        auto r   = try_change_col_row(i, j, x, y);
+        w1.i_new = shifted_position(i, row_position(x, comp));
+        w1.j_new = shifted_position(j, col_position(y, comp));
+        if ((i + w1.i_new + j + w1.j_new) % 2 == 0) return r;
+        newsign = -newsign;
+        return -r;
+      }
+
       // ----------------- A few short cuts   -----------------
 
       public:
@@ -0,0 +1,114 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+#include <triqs/arrays.hpp>
+#include <triqs/arrays/blas_lapack/getrf.hpp>
+
+namespace triqs {
+  namespace det_manip {
+
+    /**
+     * A determinant stored as log|d| and its phase d/|d| (the sign for a real d).
+     *
+     * It does not over/underflow for large matrices. Products with numbers are done on the log,
+     * and the ratio of two log_det is a plain number, computed from the difference of the logs.
+     *
+     * @tparam T double or std::complex<double>
+     */
+    template <typename T> class log_det {
+      double _log_abs = 0; // log |d|
+      T _phase        = 1; // d / |d|
+
+      public:
+      log_det() = default;
+
+      /// From a number
+      template <typename U, typename = std::enable_if_t<std::is_convertible<U, T>::value>> log_det(U const &x) { *this *= T(x); }
+
+      /// From log|d| and the phase
+      static log_det from_log(double log_abs, T phase) {
+        log_det r;
+        r._log_abs = log_abs;
+        r._phase   = phase;
+        return r;
+      }
+
+      /// log |d|
+      double log_abs() const { return _log_abs; }
+
+      /// d / |d|
+      T phase() const { return _phase; }
+
+      /// d itself. NB : may over/underflow
+      T value() const { return _phase * std::exp(_log_abs); }
+      explicit operator T() const { return value(); }
+
+      log_det &operator*=(T const &x) {
+        double a = std::abs(x);
+        _log_abs += std::log(a);
+        if (a > 0) _phase *= x / a;
+        return *this;
+      }
+
+      friend log_det operator*(log_det d, T const &x) { return d *= x; }
+      friend log_det operator*(T const &x, log_det d) { return d *= x; }
+      friend log_det operator*(int s, log_det d) { return d *= T(s); }
+
+      /// Ratio of two determinants
+      friend T operator/(log_det const &a, log_det const &b) { return (a._phase / b._phase) * std::exp(a._log_abs - b._log_abs); }
+      friend T operator/(T const &x, log_det const &b) { return (x / b._phase) * std::exp(-b._log_abs); }
+
+      friend std::ostream &operator<<(std::ostream &out, log_det const &d) { return out << d._phase << " * exp(" << d._log_abs << ")"; }
+
+      // ------------- BOOST Serialization and HDF5 --------------------
+
+      template <class Archive> void serialize(Archive &ar, const unsigned int version) {
+        ar &_log_abs;
+        ar &_phase;
+      }
+
+      friend void h5_write(h5::group fg, std::string subgroup_name, log_det const &d) {
+        auto gr = fg.create_group(subgroup_name);
+        h5_write(gr, "log_abs", d._log_abs);
+        h5_write(gr, "phase", d._phase);
+      }
+
+      friend void h5_read(h5::group fg, std::string subgroup_name, log_det &d) {
+        auto gr = fg.open_group(subgroup_name);
+        h5_read(gr, "log_abs", d._log_abs);
+        h5_read(gr, "phase", d._phase);
+      }
+    };
+
+    /// The determinant of m as a log_det, from its LU factorization, without forming the product of the diagonal
+    template <typename T> log_det<T> log_determinant(arrays::matrix_const_view<T> m) {
+      auto a = arrays::matrix<T>(m, FORTRAN_LAYOUT);
+      arrays::vector<int> ipiv(first_dim(a));
+      int info = arrays::lapack::getrf(a, ipiv);
+      if (info < 0) TRIQS_RUNTIME_ERROR << "log_determinant : failure of getrf lapack routine, info = " << info;
+      auto d = log_det<T>{T(1)};
+      for (long i = 0; i < first_dim(a); ++i) {
+        d *= a(i, i);
+        if (ipiv(i) != i + 1) d *= T(-1);
+      }
+      return d;
+    }
+
+  } // namespace det_manip
+} // namespace triqs
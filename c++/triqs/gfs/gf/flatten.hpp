@@ -19,21 +19,17 @@
 
 namespace triqs::gfs {
   /**
-   * Makes a copy of the array in matrix, whose first dimension is the n-th dimension of a
-   * and the second dimension are the flattening of the other dimensions, in the original order
+   * Flattens a as flatten_2d(a, n) below, but into a given matrix, e.g. a block of columns of a larger matrix
    *
    * @param a : array
    * @param n : the dimension to preserve.
-   *
-   * @return : a matrix, copy of the data
+   * @param mat : the result, of shape (a.shape()[n], a.size() / a.shape()[n])
    * */
-  template <typename T, int R> array<T, 2> flatten_2d(array_const_view<T, R> a, int n) {
+  template <typename T, int R> void flatten_2d(array_const_view<T, R> a, int n, array_view<T, 2> mat) {
 
-    if (a.is_empty()) return array<T, 2>{};
-    a.rebind(rotate_index_view(a, n));    // Swap relevant dim to front. The view is passed by value, we modify it.
-    long nrows = first_dim(a);            // # rows of the result, i.e. n-th dim, which is now at 0.
-    long ncols = a.size() / nrows;        // # columns of the result. Everything but n-th dim.
-    array<T, 2> mat(first_dim(a), ncols); // result
+    if (a.is_empty()) return;
+    a.rebind(rotate_index_view(a, n)); // Swap relevant dim to front. The view is passed by value, we modify it.
+    TRIQS_ASSERT2((first_dim(mat) == first_dim(a) and second_dim(mat) == a.size() / first_dim(a)), "flatten_2d : mat has the wrong shape");
 
     auto a_0 = a(0, ellipsis()); // FIXME for_each should take only the lengths ...
     for (long n : range(first_dim(a))) {
@@ -43,26 +39,40 @@ namespace triqs::gfs {
         foreach (a_0, [&a, &mat, n, c = 0ll](auto &&... i) mutable { mat(n, c++) = a(n, i...); })
           ;
     }
+  }
+
+  /**
+   * Makes a copy of the array in matrix, whose first dimension is the n-th dimension of a
+   * and the second dimension are the flattening of the other dimensions, in the original order
+   *
+   * @param a : array
+   * @param n : the dimension to preserve.
+   *
+   * @return : a matrix, copy of the data
+   * */
+  template <typename T, int R> array<T, 2> flatten_2d(array_const_view<T, R> a, int n) {
+
+    if (a.is_empty()) return array<T, 2>{};
+    long nrows = a.shape()[n];                // # rows of the result, i.e. n-th dim
+    array<T, 2> mat(nrows, a.size() / nrows); // result
+    flatten_2d(a, n, mat());
     return std::move(mat);
   }
 
   //-------------------------------------
 
+  // Real-valued gf are flattened into real-valued gf, the Fourier transform has a dedicated real-data path
+  template <typename Target> using _flatten_target_t = typename _target_from_type_rank<typename Target::scalar_t, 1>::type;
+
   template <int N, typename... Ms, typename Target> auto flatten_gf_2d(gf_const_view<cartesian_product<Ms...>, Target> g) {
     auto const &m = std::get<N>(g.mesh());
-    using gf_t = gf<typename std::decay_t<decltype(m)>::var_t, tensor_valued<1>>;
-    if constexpr (Target::is_real) // FIXME Remove hard-copy once real fourier is implemented
-      return gf_t{m, array<dcomplex, 2>(flatten_2d(g.data(), N)), {}};
-    else
-      return gf_t{m, flatten_2d(g.data(), N), {}};
+    using gf_t    = gf<typename std::decay_t<decltype(m)>::var_t, _flatten_target_t<Target>>;
+    return gf_t{m, flatten_2d(g.data(), N), {}};
   }
 
-  template <int N, typename Var, typename Target> gf<Var, tensor_valued<1>> flatten_gf_2d(gf_const_view<Var, Target> g) {
+  template <int N, typename Var, typename Target> gf<Var, _flatten_target_t<Target>> flatten_gf_2d(gf_const_view<Var, Target> g) {
     static_assert(N == 0, "Internal error");
-    if constexpr (Target::is_real) // FIXME Remove hard-copy once real fourier is implemented
-      return {g.mesh(), array<dcomplex, 2>(flatten_2d(g.data(), 0)), {}};
-    else
-      return {g.mesh(), flatten_2d(g.data(), 0), {}};
+    return {g.mesh(), flatten_2d(g.data(), 0), {}};
   }
 
 } // namespace triqs::gfs
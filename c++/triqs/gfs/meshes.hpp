@@ -37,6 +37,7 @@
 
 #include "./meshes/imtime.hpp"
 #include "./meshes/imfreq.hpp"
+#include "./meshes/sparse_imfreq.hpp"
 #include "./meshes/retime.hpp"
 #include "./meshes/refreq.hpp"
 #include "./meshes/legendre.hpp"
@@ -0,0 +1,184 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include "./dlr_basis.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace triqs::gfs {
+
+  namespace {
+
+    // Number of Chebyshev nodes per panel of the fine discretizations
+    constexpr int n_cheb = 24;
+
+    // Matsubara indices below this cutoff are all candidates for the nodes, beyond it they are sampled logarithmically
+    constexpr long n_dense = 1024;
+
+    double conj_(double x) { return x; }
+    dcomplex conj_(dcomplex x) { return std::conj(x); }
+
+    // Chebyshev nodes of the first kind on [a, b]
+    std::vector<double> chebyshev_nodes(double a, double b) {
+      std::vector<double> x(n_cheb);
+      for (int i = 0; i < n_cheb; ++i) x[i] = (a + b) / 2 - (b - a) / 2 * std::cos(M_PI * (i + 0.5) / n_cheb);
+      return x;
+    }
+
+    // Row-pivoted Gram-Schmidt : select at most max_rank rows of A spanning its row space up to eps (relative to the largest row).
+    // The selected row is reorthogonalized against the previous ones before normalization.
+    template <typename T> std::vector<long> pivoted_gram_schmidt(matrix<T> A, double eps, long max_rank) {
+      long M = A.shape()[0], N = A.shape()[1];
+      std::vector<double> norm2(M, 0);
+      for (long i = 0; i < M; ++i)
+        for (long k = 0; k < N; ++k) norm2[i] += std::norm(A(i, k));
+      double norm2_max = *std::max_element(begin(norm2), end(norm2));
+
+      std::vector<long> pivots;
+      std::vector<bool> selected(M, false);
+      while (long(pivots.size()) < std::min(max_rank, M)) {
+        long j = -1;
+        for (long i = 0; i < M; ++i)
+          if (!selected[i] and (j == -1 or norm2[i] > norm2[j])) j = i;
+        if (norm2[j] <= eps * eps * norm2_max or norm2[j] == 0) break;
+
+        for (long p : pivots) {
+          T d = 0;
+          for (long k = 0; k < N; ++k) d += conj_(A(p, k)) * A(j, k);
+          for (long k = 0; k < N; ++k) A(j, k) -= d * A(p, k);
+        }
+        double nr = 0;
+        for (long k = 0; k < N; ++k) nr += std::norm(A(j, k));
+        nr = std::sqrt(nr);
+        for (long k = 0; k < N; ++k) A(j, k) /= nr;
+        selected[j] = true;
+        pivots.push_back(j);
+
+        for (long i = 0; i < M; ++i) {
+          if (selected[i]) continue;
+          T d = 0;
+          for (long k = 0; k < N; ++k) d += conj_(A(j, k)) * A(i, k);
+          norm2[i] = 0;
+          for (long k = 0; k < N; ++k) {
+            A(i, k) -= d * A(j, k);
+            norm2[i] += std::norm(A(i, k));
+          }
+        }
+      }
+      return pivots;
+    }
+
+  } // namespace
+
+  //-------------------------------------------------------
+
+  double dlr_basis::k_tau(double tau, double omega) {
+    if (omega >= 0) return -std::exp(-tau * omega) / (1 + std::exp(-omega));
+    return -std::exp((1 - tau) * omega) / (1 + std::exp(omega));
+  }
+
+  dcomplex dlr_basis::k_iw(long n, double omega) const {
+    if (_statistic == Fermion) return 1.0 / (dcomplex{0, M_PI * (2 * n + 1)} - omega);
+    if (n == 0 and omega == 0) return -0.5;
+    return std::tanh(omega / 2) / (dcomplex{0, 2 * M_PI * n} - omega);
+  }
+
+  //-------------------------------------------------------
+
+  dlr_basis::dlr_basis(double lambda, double eps, statistic_enum statistic) : _lambda(lambda), _eps(eps), _statistic(statistic) {
+    if (lambda <= 0) TRIQS_RUNTIME_ERROR << "dlr_basis : lambda must be > 0, got " << lambda;
+    if (eps <= 0 or eps >= 1) TRIQS_RUNTIME_ERROR << "dlr_basis : eps must be in (0,1), got " << eps;
+
+    // Fine composite Chebyshev grids, with panels refined dyadically towards omega = 0 and towards tau = 0 and tau = 1
+    int log2_lambda = std::ceil(std::log2(lambda));
+    int n_panels_om = std::max(log2_lambda, 1);
+    int n_panels_tau = std::max(log2_lambda - 2, 1);
+
+    std::vector<double> om_fine, tau_fine;
+    for (int i = 0; i < n_panels_om; ++i) {
+      double a = (i == 0 ? 0 : lambda / std::pow(2, n_panels_om - i)), b = lambda / std::pow(2, n_panels_om - i - 1);
+      for (double x : chebyshev_nodes(a, b)) {
+        om_fine.push_back(x);
+        om_fine.push_back(-x);
+      }
+    }
+    for (int i = 0; i < n_panels_tau; ++i) {
+      double a = (i == 0 ? 0 : std::pow(2, i - n_panels_tau - 1)), b = std::pow(2, i - n_panels_tau);
+      for (double x : chebyshev_nodes(a, b)) {
+        tau_fine.push_back(x);
+        tau_fine.push_back(1 - x);
+      }
+    }
+
+    // Real frequencies : the columns of K(tau, omega) spanning the kernel up to eps
+    auto K_fine = matrix<double>(om_fine.size(), tau_fine.size());
+    for (long i = 0; i < long(om_fine.size()); ++i)
+      for (long j = 0; j < long(tau_fine.size()); ++j) K_fine(i, j) = k_tau(tau_fine[j], om_fine[i]);
+
+    for (long i : pivoted_gram_schmidt(K_fine, eps, om_fine.size())) _omega.push_back(om_fine[i]);
+    std::sort(begin(_omega), end(_omega));
+    long r = _omega.size();
+
+    // Imaginary times : r rows of K(tau, omega_k)
+    auto K_tau = matrix<double>(tau_fine.size(), r);
+    for (long i = 0; i < long(tau_fine.size()); ++i)
+      for (long k = 0; k < r; ++k) K_tau(i, k) = k_tau(tau_fine[i], _omega[k]);
+    for (long i : pivoted_gram_schmidt(K_tau, 0, r)) _tau_nodes.push_back(tau_fine[i]);
+    std::sort(begin(_tau_nodes), end(_tau_nodes));
+
+    // Matsubara indices : r rows of K_n(omega_k), among all |n| < n_dense and a logarithmic sampling up to n_max ~ lambda
+    long n_max = std::max(long(std::ceil(lambda)), 128l);
+    std::vector<long> n_pos;
+    for (long n = 0; n <= std::min(n_max, n_dense); ++n) n_pos.push_back(n);
+    for (double x = n_dense * 1.01; x < n_max; x *= 1.01)
+      if (long(x) > n_pos.back()) n_pos.push_back(long(x));
+    if (n_pos.back() < n_max) n_pos.push_back(n_max);
+
+    std::vector<long> n_candidates;
+    bool is_fermion = (statistic == Fermion);
+    for (auto it = n_pos.rbegin(); it != n_pos.rend(); ++it)
+      if (is_fermion or *it != 0) n_candidates.push_back(-*it - (is_fermion ? 1 : 0));
+    for (long n : n_pos) n_candidates.push_back(n);
+
+    auto K_iw = matrix<dcomplex>(n_candidates.size(), r);
+    for (long i = 0; i < long(n_candidates.size()); ++i)
+      for (long k = 0; k < r; ++k) K_iw(i, k) = k_iw(n_candidates[i], _omega[k]);
+    for (long i : pivoted_gram_schmidt(K_iw, 0, r)) _iw_nodes.push_back(n_candidates[i]);
+    std::sort(begin(_iw_nodes), end(_iw_nodes));
+
+    if (long(_tau_nodes.size()) != r or long(_iw_nodes.size()) != r)
+      TRIQS_RUNTIME_ERROR << "dlr_basis : node selection failed for lambda = " << lambda << ", eps = " << eps;
+
+    _k_iw_nodes = matrix<dcomplex>(r, r);
+    for (long l = 0; l < r; ++l)
+      for (long k = 0; k < r; ++k) _k_iw_nodes(l, k) = k_iw(_iw_nodes[l], _omega[k]);
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<const dlr_basis> get_dlr_basis(double lambda, double eps, statistic_enum statistic) {
+    static std::mutex mtx;
+    static std::map<std::tuple<double, double, int>, std::shared_ptr<const dlr_basis>> cache;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto &b = cache[{lambda, eps, int(statistic)}];
+    if (!b) b = std::make_shared<const dlr_basis>(lambda, eps, statistic);
+    return b;
+  }
+
+} // namespace triqs::gfs
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include "./mesh_tools.hpp"
+#include <memory>
+#include <vector>
+
+namespace triqs::gfs {
+
+  /**
+   * Discrete Lehmann representation (DLR) of imaginary time and Matsubara Green functions
+   *
+   * A Green function whose spectral function has support in [-omega_max, omega_max] is represented to accuracy eps by
+   *
+   *   G(tau) = sum_k c_k K(tau / beta, omega_k)     G(i nu_n) = beta sum_k c_k K_n(omega_k)
+   *
+   * with the (dimensionless) kernels K(tau, omega) = -exp(-tau omega) / (1 + exp(-omega)) and its Fourier transform,
+   * K_n(omega) = 1 / (i nu_n - omega) for fermions and tanh(omega / 2) / (i nu_n - omega) for bosons, nu_n = pi (2n + statistic).
+   *
+   * The rank r (number of terms) grows only as log(lambda) log(1/eps), with lambda = beta omega_max.
+   * The r real frequencies omega_k are selected by a pivoted Gram-Schmidt on a composite Chebyshev discretization of K,
+   * the r Matsubara indices n_l (and the r imaginary times tau_l) by a pivoted Gram-Schmidt on the rows of K_n(omega_k) (resp. K(tau, omega_k)).
+   * The values of G on the r Matsubara frequencies determine the c_k, and hence G everywhere.
+   *
+   * Ref : J. Kaye, K. Chen, O. Parcollet, Phys. Rev. B 105, 235115 (2022)
+   */
+  class dlr_basis {
+
+    public:
+    /**
+     * @param lambda Dimensionless cutoff beta * omega_max
+     * @param eps Accuracy of the representation
+     * @param statistic Fermion or Boson
+     */
+    dlr_basis(double lambda, double eps, statistic_enum statistic);
+
+    double lambda() const { return _lambda; }
+    double eps() const { return _eps; }
+    statistic_enum statistic() const { return _statistic; }
+
+    /// Number of terms r of the representation
+    long rank() const { return _omega.size(); }
+
+    /// The real frequencies omega_k (in units of 1 / beta), sorted
+    std::vector<double> const &omega() const { return _omega; }
+
+    /// The Matsubara indices n_l of the sparse frequency mesh, sorted
+    std::vector<long> const &matsubara_nodes() const { return _iw_nodes; }
+
+    /// The imaginary times tau_l (in units of beta, in [0, 1]), sorted
+    std::vector<double> const &tau_nodes() const { return _tau_nodes; }
+
+    /// The imaginary time kernel K(tau, omega), tau in [0, 1]
+    static double k_tau(double tau, double omega);
+
+    /// The Matsubara kernel K_n(omega)
+    dcomplex k_iw(long n, double omega) const;
+
+    /**
+     * The r x r matrix K_{n_l}(omega_k), mapping the c_k to G(i nu_{n_l}) / beta
+     *
+     * NB : This matrix is ill-conditioned (its condition number is of order 1 / eps). Solve with a backward stable method (LU, SVD),
+     * the error on the c_k lies in the directions which are negligible for G. Do not use its explicit inverse.
+     */
+    matrix<dcomplex> const &k_iw_nodes() const { return _k_iw_nodes; }
+
+    private:
+    double _lambda, _eps;
+    statistic_enum _statistic;
+    std::vector<double> _omega, _tau_nodes;
+    std::vector<long> _iw_nodes;
+    matrix<dcomplex> _k_iw_nodes;
+  };
+
+  /// The dlr_basis for (lambda, eps, statistic). The bases are constructed once and shared.
+  std::shared_ptr<const dlr_basis> get_dlr_basis(double lambda, double eps, statistic_enum statistic);
+
+} // namespace triqs::gfs
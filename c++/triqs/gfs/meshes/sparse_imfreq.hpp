@@ -0,0 +1,238 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include "./mesh_tools.hpp"
+#include "../domains/matsubara.hpp"
+#include "./dlr_basis.hpp"
+#include <algorithm>
+
+namespace triqs::gfs {
+
+  struct sparse_imfreq {};
+
+  template <> struct mesh_point<gf_mesh<sparse_imfreq>>; //forward
+
+  /// Sparse Matsubara frequency mesh
+  /**
+   * The r Matsubara frequencies $i\omega_{n_l}$ selected by the discrete Lehmann representation (see dlr_basis) for
+   * the cutoff $\Lambda = \beta \omega_{max}$ and the accuracy $\epsilon$.
+   *
+   * A Green function with spectral support in $[-\omega_{max}, \omega_{max}]$ is determined to accuracy $\epsilon$ by its values on the mesh.
+   * The number of points grows only as $\log(\Lambda) \log(1/\epsilon)$, to be compared with $\Lambda$ for a gf_mesh<imfreq>.
+   * The transforms from and to gf_mesh<imtime> are done by make_gf_from_fourier, or fourier.
+   *
+   * The index of the mesh is the linear index l of the frequency, $n_l$ is given by matsubara_index(l).
+   */
+  template <> struct gf_mesh<sparse_imfreq> {
+    ///type of the domain: matsubara_domain<true>
+    using domain_t = matsubara_domain<true>;
+    ///type of the index l of the frequency $i\omega_{n_l}$
+    using index_t = long;
+    ///type of the linear index
+    using linear_index_t = long;
+    ///type of the domain point
+    using domain_pt_t = typename domain_t::point_t;
+    using var_t       = sparse_imfreq;
+
+    // -------------------- Constructors -------------------
+
+    ///default constructor
+    gf_mesh() = default;
+
+    /**
+     * @param dom domain
+     * @param lambda Dimensionless cutoff $\Lambda = \beta \omega_{max}$
+     * @param eps Accuracy of the representation
+     */
+    gf_mesh(domain_t dom, double lambda, double eps = 1e-10)
+       : _dom(std::move(dom)), _lambda(lambda), _eps(eps), _basis(get_dlr_basis(lambda, eps, _dom.statistic)) {}
+
+    /**
+     * @param beta inverse temperature
+     * @param S statistic (Fermion or Boson)
+     * @param lambda Dimensionless cutoff $\Lambda = \beta \omega_{max}$
+     * @param eps Accuracy of the representation
+     */
+    gf_mesh(double beta, statistic_enum S, double lambda, double eps = 1e-10) : gf_mesh({beta, S}, lambda, eps) {}
+
+    // -------------------- Comparisons -------------------
+
+    bool operator==(gf_mesh const &M) const { return (std::tie(_dom, _lambda, _eps) == std::tie(M._dom, M._lambda, M._eps)); }
+    bool operator!=(gf_mesh const &M) const { return !(operator==(M)); }
+
+    // -------------------- Accessors (from concept) -------------------
+
+    /// The corresponding domain
+    domain_t const &domain() const { return _dom; }
+
+    /// Size (linear) of the mesh
+    long size() const { return (_basis ? _basis->rank() : 0); }
+
+    ///
+    utility::mini_vector<size_t, 1> size_of_components() const { return {size_t(size())}; }
+
+    /// Is the point in mesh ?
+    static constexpr bool is_within_boundary(all_t) { return true; }
+    bool is_within_boundary(index_t l) const { return ((l >= 0) && (l < size())); }
+
+    /// From an index of a point in the mesh, returns the corresponding point in the domain
+    domain_pt_t index_to_point(index_t l) const {
+      EXPECTS(is_within_boundary(l));
+      return 1i * M_PI * (2 * matsubara_index(l) + (_dom.statistic == Fermion)) / _dom.beta;
+    }
+
+    /// Flatten the index in the positive linear index for memory storage (trivial here).
+    long index_to_linear(index_t l) const {
+      EXPECTS(is_within_boundary(l));
+      return l;
+    }
+
+    // -------------------- Accessors (other) -------------------
+
+    /// Dimensionless cutoff $\Lambda$
+    double lambda() const { return _lambda; }
+
+    /// Accuracy of the representation
+    double eps() const { return _eps; }
+
+    /// The Matsubara index $n_l$ of the l-th frequency
+    long matsubara_index(long l) const { return _basis->matsubara_nodes()[l]; }
+
+    /// The linear index of the Matsubara frequency of index n, or -1 if it is not in the mesh
+    long linear_index_of(long n) const {
+      auto const &nodes = _basis->matsubara_nodes();
+      auto it           = std::lower_bound(nodes.begin(), nodes.end(), n);
+      return ((it != nodes.end() and *it == n) ? it - nodes.begin() : -1);
+    }
+
+    /// The discrete Lehmann representation underlying the mesh
+    dlr_basis const &basis() const { return *_basis; }
+
+    // -------------------- mesh_point -------------------
+
+    /// Type of the mesh point
+    using mesh_point_t = mesh_point<gf_mesh>;
+
+    /// Accessing a point of the mesh from its index
+    inline mesh_point_t operator[](index_t l) const; //impl below
+
+    /// Iterating on all the points...
+    using const_iterator = mesh_pt_generator<gf_mesh>;
+    inline const_iterator begin() const; // impl below
+    inline const_iterator end() const;
+    inline const_iterator cbegin() const;
+    inline const_iterator cend() const;
+
+    // -------------- Evaluation of a function on the grid --------------------------
+
+    // For multivar evaluation
+    interpol_data_all_t get_interpolation_data(all_t) const { return {}; }
+    interpol_data_0d_t<index_t> get_interpolation_data(long l) const { return {l}; }
+
+    // For one var evaluation
+    template <typename F> auto evaluate(F const &f, long l) const { return f[l]; }
+
+    /// Value on a Matsubara frequency of the mesh
+    template <typename F> auto evaluate(F const &f, matsubara_freq const &w) const {
+      long l = linear_index_of(w.n);
+      if (l < 0) TRIQS_RUNTIME_ERROR << "The Matsubara frequency of index " << w.n << " is not in the sparse mesh";
+      return f[l];
+    }
+
+    friend std::ostream &operator<<(std::ostream &sout, gf_mesh const &m) {
+      return sout << "Sparse Matsubara Freq Mesh of size " << m.size() << ", Domain: " << m.domain() << ", lambda : " << m.lambda()
+                  << ", eps : " << m.eps();
+    }
+
+    // -------------------- HDF5 -------------------
+
+    static std::string hdf5_format() { return "MeshSparseImFreq"; }
+
+    /// Write into HDF5
+    friend void h5_write(h5::group fg, std::string subgroup_name, gf_mesh const &m) {
+      h5::group gr = fg.create_group(subgroup_name);
+      write_hdf5_format(gr, m);
+      h5_write(gr, "domain", m.domain());
+      h5_write(gr, "lambda", m.lambda());
+      h5_write(gr, "eps", m.eps());
+    }
+
+    /// Read from HDF5
+    friend void h5_read(h5::group fg, std::string subgroup_name, gf_mesh &m) {
+      h5::group gr = fg.open_group(subgroup_name);
+      assert_hdf5_format(gr, m, true);
+      typename gf_mesh::domain_t dom;
+      double lambda, eps;
+      h5_read(gr, "domain", dom);
+      h5_read(gr, "lambda", lambda);
+      h5_read(gr, "eps", eps);
+      m = gf_mesh{std::move(dom), lambda, eps};
+    }
+
+    // -------------------- boost serialization -------------------
+
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive &ar, const unsigned int version) {
+      ar &_dom;
+      ar &_lambda;
+      ar &_eps;
+      _basis = get_dlr_basis(_lambda, _eps, _dom.statistic); // after a load
+    }
+
+    // ------------------------------------------------
+    private:
+    domain_t _dom;
+    double _lambda = 1, _eps = 1e-10;
+    std::shared_ptr<const dlr_basis> _basis;
+  };
+
+  // ---------------------------------------------------------------------------
+  //                     The mesh point
+  //  NB : the mesh point is also in this case a matsubara_freq.
+  // ---------------------------------------------------------------------------
+
+  template <> struct mesh_point<gf_mesh<sparse_imfreq>> : matsubara_freq {
+    using index_t = typename gf_mesh<sparse_imfreq>::index_t;
+    mesh_point()  = default;
+    mesh_point(gf_mesh<sparse_imfreq> const &m, index_t const &l)
+       : matsubara_freq((l < m.size() ? m.matsubara_index(l) : 0), m.domain().beta, m.domain().statistic), _l(l), _mesh(&m) {}
+    mesh_point(gf_mesh<sparse_imfreq> const &m) : mesh_point(m, 0) {}
+    void advance() {
+      ++_l;
+      if (_l < _mesh->size()) n = _mesh->matsubara_index(_l);
+    }
+    long linear_index() const { return _l; }
+    long index() const { return _l; }
+    bool at_end() const { return (_l == _mesh->size()); } // at_end means " one after the last one", as in STL
+    void reset() {
+      _l = 0;
+      if (_mesh->size() > 0) n = _mesh->matsubara_index(0);
+    }
+    gf_mesh<sparse_imfreq> const &mesh() const { return *_mesh; }
+
+    private:
+    long _l = 0;
+    gf_mesh<sparse_imfreq> const *_mesh = nullptr;
+  };
+
+  // ------------------- implementations -----------------------------
+  inline mesh_point<gf_mesh<sparse_imfreq>> gf_mesh<sparse_imfreq>::operator[](index_t l) const { return {*this, l}; }
+  inline gf_mesh<sparse_imfreq>::const_iterator gf_mesh<sparse_imfreq>::begin() const { return const_iterator(this); }
+  inline gf_mesh<sparse_imfreq>::const_iterator gf_mesh<sparse_imfreq>::end() const { return const_iterator(this, true); }
+  inline gf_mesh<sparse_imfreq>::const_iterator gf_mesh<sparse_imfreq>::cbegin() const { return const_iterator(this); }
+  inline gf_mesh<sparse_imfreq>::const_iterator gf_mesh<sparse_imfreq>::cend() const { return const_iterator(this, true); }
+
+} // namespace triqs::gfs
@@ -25,6 +25,81 @@ namespace triqs::gfs {
 
   using namespace triqs::arrays;
 
+  /*------------------------------------------------------------------------------------------------------
+  *                                  FFTW plan management
+  *-----------------------------------------------------------------------------------------------------*/
+
+  /**
+   * Rigor of the fftw planner used for the Fourier transforms.
+   *
+   * Plans are cached and reused for all transforms of identical geometry (dimensions, strides, alignment),
+   * so the cost of a measured plan is paid only once per geometry.
+   * estimate (default) : no measurement. measure / patient : time candidate algorithms, see FFTW_MEASURE / FFTW_PATIENT.
+   */
+  enum class fourier_plan_rigor { estimate, measure, patient };
+
+  /// Set the rigor of the fftw planner for all plans created from now on
+  void set_fourier_plan_rigor(fourier_plan_rigor r);
+
+  /// The current rigor of the fftw planner
+  fourier_plan_rigor get_fourier_plan_rigor();
+
+  /// Destroy all cached fftw plans, and the tables of the tail model of the Matsubara transforms cached with them.
+  /// Can be called while other threads run transforms : the plans they execute are destroyed when they are done.
+  void clear_fourier_plan_cache();
+
+  /// Number of fftw plans currently in the cache
+  long fourier_plan_cache_size();
+
+  /**
+   * Import fftw wisdom from a file, e.g. exported in a previous run with export_fourier_wisdom
+   *
+   * @param filename Name of the wisdom file
+   * @return true if the wisdom could be read
+   */
+  bool import_fourier_wisdom(std::string const &filename);
+
+  /**
+   * Export the accumulated fftw wisdom to a file
+   *
+   * @param filename Name of the wisdom file
+   */
+  void export_fourier_wisdom(std::string const &filename);
+
+  /**
+   * Set the number of threads used by the Fourier transforms (default : 1)
+   *
+   * The threads are used for the loops over the mesh before and after the fft (tail subtraction, normalization)
+   * and, if triqs is linked with the fftw threads library (TRIQS_FFTW_THREADS), for the fft itself.
+   *
+   * @param n Number of threads, 0 : std::thread::hardware_concurrency()
+   */
+  void set_fourier_n_threads(int n);
+
+  /// The number of threads used by the Fourier transforms of the calling thread
+  int get_fourier_n_threads();
+
+  /**
+   * Use a given number of threads for the Fourier transforms of the calling thread, as long as the object is alive.
+   *
+   * @code
+   * {
+   *   auto _ = fourier_n_threads_guard{4};
+   *   gw() = fourier(gt);
+   * }
+   * @endcode
+   */
+  class fourier_n_threads_guard {
+    int _previous;
+
+    public:
+    /// @param n Number of threads, 0 : std::thread::hardware_concurrency()
+    fourier_n_threads_guard(int n);
+    ~fourier_n_threads_guard();
+    fourier_n_threads_guard(fourier_n_threads_guard const &) = delete;
+    fourier_n_threads_guard &operator=(fourier_n_threads_guard const &) = delete;
+  };
+
   /*------------------------------------------------------------------------------------------------------
   *                                  Mesh calculator
   *-----------------------------------------------------------------------------------------------------*/
@@ -44,6 +119,12 @@ namespace triqs::gfs {
     return {m.domain(), n_tau};
   }
 
+  // The imaginary time mesh of a sparse Matsubara mesh. By default, one point per beta / (2 lambda), i.e. resolving the frequencies up to omega_max
+  inline gf_mesh<imtime> make_adjoint_mesh(gf_mesh<sparse_imfreq> const &m, int n_tau = -1) {
+    if (n_tau == -1) n_tau = 2 * long(std::ceil(m.lambda())) + 1;
+    return {m.domain(), n_tau};
+  }
+
   // FIXME : DOC
   inline gf_mesh<refreq> make_adjoint_mesh(gf_mesh<retime> const &m, bool shift_half_bin = false) {
     int L       = m.size();
@@ -68,6 +149,10 @@ namespace triqs::gfs {
   // trait for error messages later
   template <typename V> using _mesh_fourier_image = typename decltype(make_adjoint_mesh(gf_mesh<V>()))::var_t;
 
+  // Is there a Fourier transform from V1 to V2 ? From a mesh to its adjoint mesh, and from imtime to sparse_imfreq
+  template <typename V1, typename V2> inline constexpr bool _is_fourier_pair_v = std::is_same_v<V2, _mesh_fourier_image<V1>>;
+  template <> inline constexpr bool _is_fourier_pair_v<imtime, sparse_imfreq> = true;
+
   /*------------------------------------------------------------------------------------------------------
             Implementation
   *-----------------------------------------------------------------------------------------------------*/
@@ -80,6 +165,11 @@ namespace triqs::gfs {
   gf_vec_t<imfreq> _fourier_impl(gf_mesh<imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt, array_const_view<dcomplex, 2> known_moments = {});
   gf_vec_t<imtime> _fourier_impl(gf_mesh<imtime> const &tau_mesh, gf_vec_cvt<imfreq> gw, array_const_view<dcomplex, 2> known_moments = {});
 
+  // sparse matsubara (discrete Lehmann representation, no known moments)
+  gf_vec_t<sparse_imfreq> _fourier_impl(gf_mesh<sparse_imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt,
+                                        array_const_view<dcomplex, 2> known_moments = {});
+  gf_vec_t<imtime> _fourier_impl(gf_mesh<imtime> const &tau_mesh, gf_vec_cvt<sparse_imfreq> gw, array_const_view<dcomplex, 2> known_moments = {});
+
   // real
   gf_vec_t<refreq> _fourier_impl(gf_mesh<refreq> const &w_mesh, gf_vec_cvt<retime> gt, array_const_view<dcomplex, 2> known_moments= {});
   gf_vec_t<retime> _fourier_impl(gf_mesh<retime> const &t_mesh, gf_vec_cvt<refreq> gw, array_const_view<dcomplex, 2> known_moments= {});
@@ -88,6 +178,64 @@ namespace triqs::gfs {
   gf_vec_t<cyclic_lattice> _fourier_impl(gf_mesh<cyclic_lattice> const &r_mesh, gf_vec_cvt<brillouin_zone> gk);
   gf_vec_t<brillouin_zone> _fourier_impl(gf_mesh<brillouin_zone> const &k_mesh, gf_vec_cvt<cyclic_lattice> gr);
 
+  // real-valued input : real-data fftw transforms exploiting the hermitian symmetry
+  template <typename V> using gf_vec_real_cvt = gf_const_view<V, tensor_real_valued<1>>;
+
+  gf_vec_t<imfreq> _fourier_impl(gf_mesh<imfreq> const &iw_mesh, gf_vec_real_cvt<imtime> gt, array_const_view<dcomplex, 2> known_moments = {});
+  gf_vec_t<cyclic_lattice> _fourier_impl(gf_mesh<cyclic_lattice> const &r_mesh, gf_vec_real_cvt<brillouin_zone> gk);
+  gf_vec_t<brillouin_zone> _fourier_impl(gf_mesh<brillouin_zone> const &k_mesh, gf_vec_real_cvt<cyclic_lattice> gr);
+
+  // real-valued input for the other meshes : no dedicated implementation, transform the complex copy
+  template <typename V1, typename V2, typename... Args>
+  gf_vec_t<V1> _fourier_impl(gf_mesh<V1> const &out_mesh, gf_vec_real_cvt<V2> g, Args const &... args) {
+    auto g_cplx = gf_vec_t<V2>{g.mesh(), array<dcomplex, 2>(g.data()), {}};
+    return _fourier_impl(out_mesh, make_const_view(g_cplx), args...);
+  }
+
+  // The complete tail used by the transform of g onto mesh, from the known moments : fitted or zero (noisy data) if they are not enough.
+  // The transform with this tail as known moments is the transform with known_moments. Matsubara : moments 0 to 3.
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt, array_const_view<dcomplex, 2> known_moments);
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imfreq> const &iw_mesh, gf_vec_real_cvt<imtime> gt, array_const_view<dcomplex, 2> known_moments);
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imtime> const &tau_mesh, gf_vec_cvt<imfreq> gw, array_const_view<dcomplex, 2> known_moments);
+
+  // The other transforms fit nothing : their tail is the known moments
+  template <typename V1, typename V2, typename T>
+  array<dcomplex, 2> _fourier_tail(gf_mesh<V1> const &, gf_const_view<V2, T>, array_const_view<dcomplex, 2> known_moments) {
+    return array<dcomplex, 2>(known_moments);
+  }
+
+  // Layout of one dimension of a strided transform : length and strides (in number of elements) of the in and out data
+  struct _fourier_dim_t {
+    long n, in_stride, out_stride;
+  };
+
+  // c2c transform with the fftw guru interface : transform over dims, repeated over howmany_dims.
+  // in and out can be equal (in place). sign : -1 (FFTW_FORWARD) or +1 (FFTW_BACKWARD)
+  void _fourier_strided(dcomplex const *in, dcomplex *out, std::vector<_fourier_dim_t> const &dims, std::vector<_fourier_dim_t> const &howmany_dims,
+                        int sign);
+
+  // Lattice transform of the N-th mesh of complex data, directly on the strided data of in and out, i.e. without flattening.
+  // The mesh index is the row-major linear index of the (d0, d1, d2) lattice, hence it splits into 3 transform dimensions.
+  template <int N, typename AIn, typename AOut, typename M> void _fourier_lattice_strided(AIn const &in, AOut out, M const &out_mesh) {
+    constexpr bool direct = std::is_same_v<typename M::var_t, cyclic_lattice>; // k -> r
+    auto const &s_in      = in.indexmap().strides();
+    auto const &s_out     = out.indexmap().strides();
+    auto dims             = out_mesh.get_dimensions();
+
+    std::vector<_fourier_dim_t> tr_dims(3), howmany_dims;
+    long is = s_in[N], os = s_out[N];
+    for (int d = 2; d >= 0; --d) {
+      tr_dims[d] = {dims[d], is, os};
+      is *= dims[d];
+      os *= dims[d];
+    }
+    for (int j = 0; j < AIn::rank; ++j)
+      if (j != N) howmany_dims.push_back({long(in.shape()[j]), long(s_in[j]), long(s_out[j])});
+
+    _fourier_strided(in.data_start(), out.data_start(), tr_dims, howmany_dims, (direct ? -1 : 1));
+    if constexpr (direct) out /= out_mesh.size();
+  }
+
   /*------------------------------------------------------------------------------------------------------
    *
    * The general Fourier function
@@ -97,6 +245,23 @@ namespace triqs::gfs {
    *
    *-----------------------------------------------------------------------------------------------------*/
 
+  // gout <- gout_flatten, the inverse operation of flatten_2d(gout.data(), N), exactly
+  // S : the scalar type of gout_flatten (not deduced, so that arrays and views convert)
+  template <int N, typename S = dcomplex, typename V, typename T>
+  void _unflatten_gf_2d(array_const_view<std::enable_if_t<true, S>, 2> gout_flatten, gf_view<V, T> gout) {
+    auto _ = ellipsis();
+    if constexpr (gf_view<V, T>::data_rank == 1)
+      gout.data() = gout_flatten(_, 0); // gout is scalar, gout_flatten vectorial
+    else {
+      auto g_rot = rotate_index_view(gout.data(), N);
+      for (long l : range(first_dim(gout_flatten))) {
+        auto g_rot_sl = g_rot(l, _); // if the array is long, it is faster to precompute the view ...
+        auto gout_col = gout_flatten(l, _);
+        assign_foreach(g_rot_sl, [&gout_col, c = 0ll](auto &&... i) mutable { return gout_col(c++); });
+      }
+    }
+  }
+
   // this function just regroups the green function data, and calls the vector_valued gf core implementation
   template <int N, typename V1, typename V2, typename T1, typename T2, typename... OptArgs>
   void _fourier(gf_const_view<V1, T1> gin, gf_view<V2, T2> gout, OptArgs const &... opt_args) {
@@ -104,21 +269,139 @@ namespace triqs::gfs {
     static_assert(std::is_same<typename T1::complex_t, T2>::value, "Incompatible target types for fourier transform");
 
     auto const &out_mesh = std::get<N>(gout.mesh());
+    using out_var_t      = typename std::decay_t<decltype(out_mesh)>::var_t;
 
-    auto gout_flatten = _fourier_impl(out_mesh, flatten_gf_2d<N>(gin), flatten_2d(make_const_view(opt_args), 0)...);
-    auto _            = ellipsis();
-    if constexpr (gin.data_rank == 1)
-      gout.data() = gout_flatten.data()(_, 0); // gout is scalar, gout_flatten vectorial
-    else {
-      // inverse operation as flatten_2d, exactly
-      auto g_rot = rotate_index_view(gout.data(), N);
-      auto a_0   = g_rot(0, _);
-      for (auto const &mp : out_mesh) {
-        auto g_rot_sl = g_rot(mp.linear_index(), _); // if the array is long, it is faster to precompute the view ...
-        auto gout_col = gout_flatten.data()(mp.linear_index(), _);
-        assign_foreach(g_rot_sl, [&gout_col, c = 0ll](auto &&... i) mutable { return gout_col(c++); });
+    if constexpr ((std::is_same_v<out_var_t, brillouin_zone> or std::is_same_v<out_var_t, cyclic_lattice>) and not T1::is_real) {
+      // lattice transforms have no pre- or post-processing : no need to flatten the data
+      _fourier_lattice_strided<N>(gin.data(), gout.data(), out_mesh);
+      return;
+    }
+
+    auto gin_flatten  = flatten_gf_2d<N>(gin); // real-valued for a real-valued gin
+    auto gout_flatten = _fourier_impl(out_mesh, make_const_view(gin_flatten), flatten_2d(make_const_view(opt_args), 0)...);
+    _unflatten_gf_2d<N>(gout_flatten.data(), gout);
+  }
+
+  // The gf holding the transform of the N-th mesh of gin onto mesh
+  template <int N, typename V1, typename V2, typename T> auto _make_fourier_out_gf(gf_const_view<V1, T> gin, gf_mesh<V2> const &mesh) {
+    if constexpr (get_n_variables<V1>::value == 1) // === single mesh
+      return gf<V2, typename T::complex_t>{mesh, gin.target_shape()};
+    else { // === cartesian_product mesh
+      auto mesh_tpl = triqs::tuple::replace<N>(gin.mesh().components(), mesh);
+      auto out_mesh = gf_mesh{mesh_tpl};
+      using var_t   = typename std::decay_t<decltype(out_mesh)>::var_t;
+      return gf<var_t, typename T::complex_t>{out_mesh, gin.target_shape()};
+    }
+  }
+
+  /*------------------------------------------------------------------------------------------------------
+   *
+   * Batched Fourier transform of several gf, e.g. the blocks of a block gf
+   *
+   *-----------------------------------------------------------------------------------------------------*/
+
+  // Transform gins[b] into gouts[b], for gf with identical N-th meshes (in and out) and the same number of known moments.
+  // The flattened data of all gf are put side by side as the columns of a single vector-valued gf,
+  // so that they are transformed with a single fftw execution.
+  // The tail of each gf is determined on its own columns (fit, noise check, error checks), exactly as in its separate transform,
+  // and passed as known moments to the batched transform : the result is the one of the separate transforms.
+  template <int N, typename GinCV, typename GoutV>
+  void _fourier_batched(std::vector<GinCV> const &gins, std::vector<GoutV> const &gouts, std::vector<array_const_view<dcomplex, 2>> const &km) {
+
+    auto const &in_mesh  = std::get<N>(gins[0].mesh());
+    auto const &out_mesh = std::get<N>(gouts[0].mesh());
+    using in_var_t       = typename std::decay_t<decltype(in_mesh)>::var_t;
+    using out_var_t      = typename std::decay_t<decltype(out_mesh)>::var_t;
+    auto _               = range();
+
+    std::vector<long> offset{0}; // the columns of gins[b] are [offset[b], offset[b+1])
+    for (auto const &g : gins) offset.push_back(offset.back() + g.data().size() / in_mesh.size());
+    long n_cols = offset.back();
+
+    auto gin_flatten = gf<in_var_t, _flatten_target_t<typename GinCV::target_t>>{in_mesh, {int(n_cols)}};
+    for (int b : range(gins.size())) flatten_2d(gins[b].data(), N, gin_flatten.data()(_, range(offset[b], offset[b + 1])));
+
+    array<dcomplex, 2> km_flatten;
+    if constexpr (not(std::is_same_v<out_var_t, brillouin_zone> or std::is_same_v<out_var_t, cyclic_lattice>)) {
+      for (int b : range(gins.size())) {
+        auto cols   = range(offset[b], offset[b + 1]);
+        auto gin_bl = typename decltype(gin_flatten)::const_view_type{in_mesh, gin_flatten.data()(_, cols)};
+        auto tail   = _fourier_tail(out_mesh, gin_bl, (km.empty() ? array_const_view<dcomplex, 2>{} : km[b]));
+        if (tail.is_empty()) continue; // no known moments, and no fit for this transform
+        if (km_flatten.is_empty()) km_flatten.resize(first_dim(tail), n_cols);
+        km_flatten(_, cols) = tail;
       }
     }
+
+    auto gout_flatten = [&]() {
+      if constexpr (std::is_same_v<out_var_t, brillouin_zone> or std::is_same_v<out_var_t, cyclic_lattice>)
+        return _fourier_impl(out_mesh, make_const_view(gin_flatten));
+      else
+        return _fourier_impl(out_mesh, make_const_view(gin_flatten), make_const_view(km_flatten));
+    }();
+
+    for (int b : range(gins.size())) _unflatten_gf_2d<N>(gout_flatten.data()(_, range(offset[b], offset[b + 1])), gouts[b]);
+  }
+
+  // Transform of each of the gins onto the out_meshes, with known moments km (empty, or one per gf).
+  // The gf are grouped by identical meshes and number of known moments, each group is transformed by _fourier_batched
+  template <int N, typename GinCV, typename M>
+  auto _make_gf_from_fourier_batched(std::vector<GinCV> const &gins, std::vector<M> const &out_meshes, std::vector<array<dcomplex, 2>> const &km) {
+
+    TRIQS_ASSERT2(km.empty() or km.size() == gins.size(), "Fourier: Require one array of known moments per gf");
+
+    using gout_t = decltype(_make_fourier_out_gf<N>(gins[0], out_meshes[0]));
+    std::vector<gout_t> gouts;
+    for (int b : range(gins.size())) gouts.push_back(_make_fourier_out_gf<N>(gins[b], out_meshes[b]));
+
+    using out_var_t = typename M::var_t;
+    if constexpr ((std::is_same_v<out_var_t, brillouin_zone> or std::is_same_v<out_var_t, cyclic_lattice>) and not GinCV::target_t::is_real) {
+      // the strided lattice transform of each gf is already a single fftw execution without copies
+      for (int b : range(gins.size())) _fourier<N>(gins[b], gouts[b]());
+      return gouts;
+    }
+
+    std::vector<bool> done(gins.size(), false);
+    for (int b : range(gins.size())) {
+      if (done[b]) continue;
+      std::vector<GinCV> gins_grp;
+      std::vector<typename gout_t::view_type> gouts_grp;
+      std::vector<array_const_view<dcomplex, 2>> km_grp;
+      for (int c : range(b, gins.size())) {
+        bool same = not done[c] and std::get<N>(gins[c].mesh()) == std::get<N>(gins[b].mesh()) and out_meshes[c] == out_meshes[b]
+           and (km.empty() or first_dim(km[c]) == first_dim(km[b]));
+        if (not same) continue;
+        done[c] = true;
+        gins_grp.push_back(gins[c]);
+        gouts_grp.push_back(gouts[c]());
+        if (not km.empty()) km_grp.push_back(km[c]);
+      }
+      _fourier_batched<N>(gins_grp, gouts_grp, km_grp);
+    }
+    return gouts;
+  }
+
+  // The blocks of a block_gf or block2_gf (row-major) as a list of const views
+  template <typename G> auto _fourier_block_list(G const &g) {
+    std::vector<typename G::g_t::const_view_type> r;
+    if constexpr (G::arity == 1)
+      for (auto const &x : g.data()) r.emplace_back(x);
+    else
+      for (auto const &v : g.data())
+        for (auto const &x : v) r.emplace_back(x);
+    return r;
+  }
+
+  // Rebuild a block gf with the block structure of g from the list of its blocks
+  template <typename G, typename Gout> auto _fourier_make_block(G const &g, std::vector<Gout> blocks) {
+    if constexpr (G::arity == 1)
+      return make_block_gf(g.block_names(), std::move(blocks));
+    else {
+      std::vector<std::vector<Gout>> vv(g.size1());
+      for (int i : range(g.size1()))
+        for (int j : range(g.size2())) vv[i].push_back(std::move(blocks[i * g.size2() + j]));
+      return block2_gf{g.block_names(), std::move(vv)};
+    }
   }
 
   /* *-----------------------------------------------------------------------------------------------------
@@ -137,20 +420,13 @@ namespace triqs::gfs {
     if constexpr (get_n_variables<V1>::value == 1) { // === single mesh
       static_assert(get_n_variables<V2>::value == 1, "Incompatible mesh ranks");
       static_assert(N == 0, "Fourier transforming gf with mesh of rank 1 but fourier index N > 1");
-      static_assert(std::is_same_v<V2, _mesh_fourier_image<V1>>, "There is no Fourier transform between these two meshes");
-      auto gout = gf<V2, typename T::complex_t>{mesh, gin.target_shape()};
-      _fourier<N>(gin, gout(), opt_args...);
-      return gout;
+      static_assert(_is_fourier_pair_v<V1, V2>, "There is no Fourier transform between these two meshes");
     } else { // === cartesian_product mesh
-      static_assert(std::is_same_v<V2, _mesh_fourier_image<std::tuple_element_t<N, typename V1::type>>>,
-                    "There is no Fourier transform between these two meshes");
-      auto mesh_tpl = triqs::tuple::replace<N>(gin.mesh().components(), mesh);
-      auto out_mesh = gf_mesh{mesh_tpl};
-      using var_t   = typename std::decay_t<decltype(out_mesh)>::var_t;
-      auto gout     = gf<var_t, typename T::complex_t>{out_mesh, gin.target_shape()};
-      _fourier<N>(gin, gout(), opt_args...);
-      return gout;
+      static_assert(_is_fourier_pair_v<std::tuple_element_t<N, typename V1::type>, V2>, "There is no Fourier transform between these two meshes");
     }
+    auto gout = _make_fourier_out_gf<N>(gin, mesh);
+    _fourier<N>(gin, gout(), opt_args...);
+    return gout;
   }
 
   /* *-----------------------------------------------------------------------------------------------------
@@ -175,6 +451,10 @@ namespace triqs::gfs {
     return make_gf_from_fourier(gin, make_adjoint_mesh(gin.mesh(), n_iw));
   }
 
+  template <int N = 0, typename T> gf<imtime, T> make_gf_from_fourier(gf_const_view<sparse_imfreq, T> gin, int n_tau = -1) {
+    return make_gf_from_fourier(gin, make_adjoint_mesh(gin.mesh(), n_tau));
+  }
+
   template <int N = 0, typename T> gf<retime, T> make_gf_from_fourier(gf_const_view<refreq, T> gin, bool shift_half_bin = false) {
     return make_gf_from_fourier(gin, make_adjoint_mesh(gin.mesh(), shift_half_bin));
   }
@@ -227,42 +507,60 @@ namespace triqs::gfs {
    *
    * *-----------------------------------------------------------------------------------------------------*/
 
-  template <int N = 0, typename G, typename M, int R>
-  auto make_gf_from_fourier(G const &gin, M const &m, std::vector<array<dcomplex, R>> const &known_moments) REQUIRES(is_block_gf_v<G>) {
+  // The blocks are transformed together, see _make_gf_from_fourier_batched :
+  // all blocks with identical meshes are transformed with a single fftw execution, the tail of each block is fitted separately.
 
-    using r_t = decltype(make_gf_from_fourier<N>(gin[0], m, known_moments[0]));
-    std::vector<r_t> g_vec;
+  // Is the first of the arguments a mesh ?
+  template <typename... A> inline constexpr bool _first_is_gf_mesh_v                               = false;
+  template <typename V, typename... A> inline constexpr bool _first_is_gf_mesh_v<gf_mesh<V>, A...> = true;
+
+  template <int N = 0, typename G, typename M, int R>
+  auto make_gf_from_fourier(G const &gin, M const &m, std::vector<array<dcomplex, R>> const &known_moments) REQUIRES(is_block_gf_v<G, 1>) {
 
     TRIQS_ASSERT2(gin.size() == known_moments.size(), "Fourier: Require equal number of blocks in block_gf and known_moments vector");
 
-    for (auto [gin_bl, km_bl] : itertools::zip(gin, known_moments)) g_vec.push_back(make_gf_from_fourier<N>(gin_bl, m, km_bl));
-    return make_block_gf(gin.block_names(), std::move(g_vec));
+    std::vector<array<dcomplex, 2>> km;
+    for (auto const &km_bl : known_moments) km.push_back(flatten_2d(make_const_view(km_bl), 0));
+    auto gins = _fourier_block_list(gin);
+    return _fourier_make_block(gin, _make_gf_from_fourier_batched<N>(gins, std::vector<M>(gins.size(), m), km));
   }
 
   template <int N = 0, typename G, typename M, int R>
   auto make_gf_from_fourier(G const &gin, M const &m, std::vector<std::vector<array<dcomplex, R>>> const &known_moments)
-     REQUIRES(is_block_gf_v<G>) {
-
-    using r_t = decltype(make_gf_from_fourier<N>(gin(0, 0), m, known_moments[0][0]));
-    std::vector<std::vector<r_t>> g_vecvec;
+     REQUIRES(is_block_gf_v<G, 2>) {
 
     TRIQS_ASSERT2(gin.size1() == known_moments.size(), "Fourier: Require matching block structure between gin and known_moments");
 
-    for (int i : range(gin.size1())) {
-      TRIQS_ASSERT2(gin.size2() == known_moments[i].size(), "Fourier: Require matching block structure between gin and known_moments");
-
-      std::vector<r_t> g_vec;
-      for (int j : range(gin.size2())) g_vec.push_back(make_gf_from_fourier<N>(gin(i, j), m, known_moments[i][j]));
-
-      g_vecvec.push_back(std::move(g_vec));
+    std::vector<array<dcomplex, 2>> km;
+    for (auto const &km_vec : known_moments) {
+      TRIQS_ASSERT2(gin.size2() == km_vec.size(), "Fourier: Require matching block structure between gin and known_moments");
+      for (auto const &km_bl : km_vec) km.push_back(flatten_2d(make_const_view(km_bl), 0));
     }
-    return block2_gf{gin.block_names(), std::move(g_vecvec)};
+    auto gins = _fourier_block_list(gin);
+    return _fourier_make_block(gin, _make_gf_from_fourier_batched<N>(gins, std::vector<M>(gins.size(), m), km));
   }
 
   template <int N = 0, int... Ns, typename G, typename... Args>
   auto make_gf_from_fourier(G const &gin, Args const &... args) REQUIRES(is_block_gf_v<G>) {
-    auto l = [&](typename G::g_t::const_view_type g_bl) { return make_gf_from_fourier<N, Ns...>(make_const_view(g_bl), args...); };
-    return map_block_gf(l, gin);
+    using var_t = typename G::g_t::variable_t;
+    auto gins   = _fourier_block_list(gin);
+
+    if constexpr (sizeof...(Ns) == 0 and sizeof...(Args) >= 1 and sizeof...(Args) <= 2 and _first_is_gf_mesh_v<Args...>) {
+      // (mesh) or (mesh, known moments common to all blocks)
+      auto const &m = std::get<0>(std::tie(args...));
+      using m_t     = std::decay_t<decltype(m)>;
+      std::vector<array<dcomplex, 2>> km;
+      if constexpr (sizeof...(Args) == 2) km.assign(gins.size(), flatten_2d(make_const_view(std::get<1>(std::tie(args...))), 0));
+      return _fourier_make_block(gin, _make_gf_from_fourier_batched<N>(gins, std::vector<m_t>(gins.size(), m), km));
+    } else if constexpr (sizeof...(Ns) == 0 and get_n_variables<var_t>::value == 1 and sizeof...(Args) <= 1) {
+      // adjoint mesh of each block, e.g. (n_iw) or ()
+      std::vector<decltype(make_adjoint_mesh(gins[0].mesh(), args...))> meshes;
+      for (auto const &g : gins) meshes.push_back(make_adjoint_mesh(g.mesh(), args...));
+      return _fourier_make_block(gin, _make_gf_from_fourier_batched<N>(gins, meshes, {}));
+    } else {
+      auto l = [&](typename G::g_t::const_view_type g_bl) { return make_gf_from_fourier<N, Ns...>(make_const_view(g_bl), args...); };
+      return map_block_gf(l, gin);
+    }
   }
 
   /* *-----------------------------------------------------------------------------------------------------
@@ -301,7 +599,7 @@ namespace triqs::gfs {
     static_assert(std::is_same_v<typename T1::real_t, typename T2::real_t>, "Error : in gx = fourier(gy), gx and gy must have the same target");
 
     if constexpr (get_n_variables<V1>::value == 1) // === single mesh
-      static_assert(std::is_same_v<V2, _mesh_fourier_image<V1>>, "There is no Fourier transform between these two meshes");
+      static_assert(_is_fourier_pair_v<V2, V1>, "There is no Fourier transform between these two meshes");
     else { // === cartesian_product mesh
       using mesh_res_t = decltype(triqs::tuple::replace<N>(rhs.g.mesh().components(), make_adjoint_mesh(std::get<N>(rhs.g.mesh()))));
       static_assert(std::is_same_v<typename gf_mesh<V1>::m_tuple_t, mesh_res_t>, "Meshes in assignment don't match");
@@ -19,51 +19,334 @@
 
 #include <triqs/gfs.hpp>
 #include "./fourier_common.hpp"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace triqs::gfs {
 
+  namespace {
+
+    // Planner flags used for new plans. Changed by set_fourier_plan_rigor.
+    std::atomic<unsigned> planner_flags = FFTW_ESTIMATE;
+
+    // Number of threads of the transforms. Changed by set_fourier_n_threads,
+    // and for the calling thread only by a fourier_n_threads_guard (0 : no guard active)
+    std::atomic<int> global_n_threads = 1;
+    thread_local int local_n_threads  = 0;
+
+    int check_n_threads(int n) {
+      if (n < 0) TRIQS_RUNTIME_ERROR << "Fourier: The number of threads must be non-negative, got " << n;
+      return (n == 0 ? std::max<int>(std::thread::hardware_concurrency(), 1) : n);
+    }
+
+    // Number of threads fftw uses for the plans of the calling thread
+    int fftw_n_threads() {
+#ifdef TRIQS_FFTW_THREADS
+      return _fourier_n_threads();
+#else
+      return 1;
+#endif
+    }
+
+    // Kind of transform of a plan
+    enum class plan_kind { c2c, r2c, guru_c2c };
+
+    // A plan is only valid for the exact geometry it was made for.
+    // Since we execute plans on new arrays (fftw_execute_dft), the alignment of the data
+    // and the in-place/out-of-place nature of the transform are part of the key too.
+    struct plan_key {
+      plan_kind kind;
+      std::vector<int> dims;
+      int howmany;
+      long istride, idist, ostride, odist;
+      int sign;
+      bool in_place;
+      int in_alignment, out_alignment;
+      unsigned flags;
+      int n_threads;
+      std::vector<std::array<long, 3>> guru_dims = {}, guru_howmany_dims = {}; // (n, is, os) for the guru interface
+
+      auto tie() const {
+        return std::tie(kind, dims, howmany, istride, idist, ostride, odist, sign, in_place, in_alignment, out_alignment, flags, n_threads, guru_dims,
+                        guru_howmany_dims);
+      }
+      bool operator<(plan_key const &k) const { return tie() < k.tie(); }
+    };
+
+    // The planner of fftw is not thread-safe, the execution of a plan is.
+    // All planner calls (and the wisdom I/O) are hence serialized with the mutex of the cache.
+    // The plans are shared with the transforms executing them, and destroyed (under the mutex, as fftw_destroy_plan
+    // is not thread-safe either) only when the last of them is done : clearing the cache never destroys a plan in use.
+    struct plan_cache {
+      std::mutex mtx;
+      std::map<plan_key, std::shared_ptr<fftw_plan_s>> plans;
+
+      ~plan_cache() { clear(); }
+
+      std::shared_ptr<fftw_plan_s> make_shared_plan(fftw_plan p) {
+        return {p, [m = &mtx](fftw_plan q) {
+                  std::lock_guard<std::mutex> lock(*m);
+                  fftw_destroy_plan(q);
+                }};
+      }
+
+      // NB : not under the lock, the plans no longer in use are destroyed by their deleter, which takes it
+      void clear() {
+        std::map<plan_key, std::shared_ptr<fftw_plan_s>> old;
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          std::swap(old, plans);
+        }
+      }
+    };
+
+    plan_cache &get_plan_cache() {
+      static plan_cache cache;
+      return cache;
+    }
+
+#ifdef TRIQS_FFTW_THREADS
+    // Initialize the fftw threads, once per process
+    void init_fftw_threads() {
+      static bool threads_ok = (fftw_init_threads() != 0);
+      if (!threads_ok) TRIQS_RUNTIME_ERROR << "Fourier: Could not initialize the fftw threads";
+    }
+#endif
+
+    // Number of elements spanned by howmany transforms of size n with the given stride and distance
+    long extent(long n, long howmany, long stride, long dist) { return (n - 1) * stride + (howmany - 1) * dist + 1; }
+
+    // Scratch buffer with a given alignment (in the sense of fftw_alignment_of), used for planning.
+    // FFTW_MEASURE and FFTW_PATIENT overwrite the arrays during planning, so we never plan on the user data.
+    struct scratch_buffer {
+      void *raw;
+      void *ptr;
+      scratch_buffer(long bytes, int alignment) {
+        raw = fftw_malloc(bytes + 64);
+        if (raw == nullptr) TRIQS_RUNTIME_ERROR << "Fourier: Could not allocate memory for the fftw planner";
+        ptr = static_cast<char *>(raw) + alignment;
+      }
+      ~scratch_buffer() { fftw_free(raw); }
+      scratch_buffer(scratch_buffer const &) = delete;
+      scratch_buffer &operator=(scratch_buffer const &) = delete;
+    };
+
+    // Get the plan for key from the cache, or create it with make_plan(in, out) on scratch arrays of the given sizes.
+    // The plan stays alive as long as the returned pointer, even if the cache is cleared in the meantime.
+    template <typename F> std::shared_ptr<fftw_plan_s> get_plan(plan_key key, long in_bytes, long out_bytes, F make_plan) {
+      auto &cache = get_plan_cache();
+      std::lock_guard<std::mutex> lock(cache.mtx);
+      if (auto it = cache.plans.find(key); it != cache.plans.end()) return it->second;
+
+      scratch_buffer in_scratch(in_bytes, key.in_alignment);
+      std::optional<scratch_buffer> out_scratch;
+      if (!key.in_place) out_scratch.emplace(out_bytes, key.out_alignment);
+
+#ifdef TRIQS_FFTW_THREADS
+      init_fftw_threads();
+      fftw_plan_with_nthreads(key.n_threads);
+#endif
+
+      auto p = make_plan(in_scratch.ptr, (key.in_place ? in_scratch.ptr : out_scratch->ptr));
+      if (p == NULL) TRIQS_RUNTIME_ERROR << "Fourier: fftw could not create a plan";
+      return cache.plans.emplace(std::move(key), cache.make_shared_plan(p)).first->second;
+    }
+
+    int alignment_of(void *p) { return fftw_alignment_of(static_cast<double *>(p)); }
+
+  } // namespace
+
+  // -------------------------------------------------------------------------------------------
+
+  void set_fourier_plan_rigor(fourier_plan_rigor r) {
+    switch (r) {
+      case fourier_plan_rigor::estimate: planner_flags = FFTW_ESTIMATE; break;
+      case fourier_plan_rigor::measure: planner_flags = FFTW_MEASURE; break;
+      case fourier_plan_rigor::patient: planner_flags = FFTW_PATIENT; break;
+    }
+  }
+
+  fourier_plan_rigor get_fourier_plan_rigor() {
+    switch (planner_flags.load()) {
+      case FFTW_MEASURE: return fourier_plan_rigor::measure;
+      case FFTW_PATIENT: return fourier_plan_rigor::patient;
+      default: return fourier_plan_rigor::estimate;
+    }
+  }
+
+  void clear_fourier_plan_cache() {
+    get_plan_cache().clear();
+    _clear_fourier_tail_tables();
+  }
+
+  long fourier_plan_cache_size() {
+    auto &cache = get_plan_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    return cache.plans.size();
+  }
+
+  bool import_fourier_wisdom(std::string const &filename) {
+    auto &cache = get_plan_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    return fftw_import_wisdom_from_filename(filename.c_str()) != 0;
+  }
+
+  void export_fourier_wisdom(std::string const &filename) {
+    auto &cache = get_plan_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    if (fftw_export_wisdom_to_filename(filename.c_str()) == 0) TRIQS_RUNTIME_ERROR << "Fourier: Could not export the fftw wisdom to " << filename;
+  }
+
+  void set_fourier_n_threads(int n) { global_n_threads = check_n_threads(n); }
+
+  int get_fourier_n_threads() { return _fourier_n_threads(); }
+
+  int _fourier_n_threads() { return (local_n_threads > 0 ? local_n_threads : global_n_threads.load()); }
+
+  fourier_n_threads_guard::fourier_n_threads_guard(int n) : _previous(local_n_threads) { local_n_threads = check_n_threads(n); }
+
+  fourier_n_threads_guard::~fourier_n_threads_guard() { local_n_threads = _previous; }
+
+  // -------------------------------------------------------------------------------------------
+
   void _fourier_base(array_const_view<dcomplex, 2> in, array_view<dcomplex, 2> out, int rank, int *dims, int fftw_count, int fftw_backward_forward) {
 
-    auto in_fft  = reinterpret_cast<fftw_complex *>(in.data_start());
+    auto in_fft  = reinterpret_cast<fftw_complex *>(const_cast<dcomplex *>(in.data_start()));
     auto out_fft = reinterpret_cast<fftw_complex *>(out.data_start());
 
-    auto p = fftw_plan_many_dft(rank,                        // rank
-                                dims,                        // the dimension
-                                fftw_count,                  // how many FFT : here 1
-                                in_fft,                      // in data
-                                NULL,                        // embed : unused. Doc unclear ?
-                                in.indexmap().strides()[0],  // stride of the in data
-                                1,                           // in : shift for multi fft.
-                                out_fft,                     // out data
-                                NULL,                        // embed : unused. Doc unclear ?
-                                out.indexmap().strides()[0], // stride of the out data
-                                1,                           // out : shift for multi fft.
-                                fftw_backward_forward, FFTW_ESTIMATE);
-
-    fftw_execute(p);
-    fftw_destroy_plan(p);
+    long n = 1;
+    for (int i = 0; i < rank; ++i) n *= dims[i];
+
+    auto key = plan_key{plan_kind::c2c,
+                        std::vector<int>(dims, dims + rank),
+                        fftw_count,
+                        in.indexmap().strides()[0],  // stride of the in data
+                        1,                           // in : shift for multi fft.
+                        out.indexmap().strides()[0], // stride of the out data
+                        1,                           // out : shift for multi fft.
+                        fftw_backward_forward,
+                        (in_fft == out_fft),
+                        alignment_of(in_fft),
+                        alignment_of(out_fft),
+                        planner_flags.load(),
+                        fftw_n_threads()};
+
+    long in_bytes  = extent(n, key.howmany, key.istride, key.idist) * sizeof(fftw_complex);
+    long out_bytes = extent(n, key.howmany, key.ostride, key.odist) * sizeof(fftw_complex);
+
+    auto p = get_plan(key, in_bytes, out_bytes, [&](void *in_scratch, void *out_scratch) {
+      return fftw_plan_many_dft(rank,                                     // rank
+                                dims,                                     // the dimension
+                                key.howmany,                              // how many FFT
+                                static_cast<fftw_complex *>(in_scratch),  // in data
+                                NULL,                                     // embed : unused. Doc unclear ?
+                                key.istride,                              // stride of the in data
+                                key.idist,                                // in : shift for multi fft.
+                                static_cast<fftw_complex *>(out_scratch), // out data
+                                NULL,                                     // embed : unused. Doc unclear ?
+                                key.ostride,                              // stride of the out data
+                                key.odist,                                // out : shift for multi fft.
+                                fftw_backward_forward, key.flags);
+    });
+
+    // Executing an existing plan on new arrays is thread-safe. p keeps the plan alive until the end of the execution
+    fftw_execute_dft(p.get(), in_fft, out_fft);
   }
 
-  //void _fourier_base(array_const_view<double, 2> in, array_view<dcomplex, 2> out, int rank, int *dims, int fftw_count) {
-
-    //auto in_fft  = reinterpret_cast<fftw_real *>(in.data_start());
-    //auto out_fft = reinterpret_cast<fftw_complex *>(out.data_start());
-
-    //auto p = fftw_plan_many_dft(rank,                        // rank
-                                //dims,                        // the dimension
-                                //fftw_count,                  // how many FFT : here 1
-                                //in_fft,                      // in data
-                                //NULL,                        // embed : unused. Doc unclear ?
-                                //in.indexmap().strides()[0],  // stride of the in data
-                                //1,                           // in : shift for multi fft.
-                                //out_fft,                     // out data
-                                //NULL,                        // embed : unused. Doc unclear ?
-                                //out.indexmap().strides()[0], // stride of the out data
-                                //1,                           // out : shift for multi fft.
-                                //FFTW_ESTIMATE);
-
-    //fftw_execute(p);
-    //fftw_destroy_plan(p);
-  //}
+  // -------------------------------------------------------------------------------------------
+
+  void _fourier_base(array_const_view<double, 2> in, array_view<dcomplex, 2> out, int rank, int *dims, int fftw_count) {
+
+    auto in_fft  = const_cast<double *>(in.data_start());
+    auto out_fft = reinterpret_cast<fftw_complex *>(out.data_start());
+
+    // Only the non-redundant half of the last dimension is computed
+    long n_in = 1, n_out = 1;
+    for (int i = 0; i < rank; ++i) {
+      n_in *= dims[i];
+      n_out *= (i == rank - 1 ? dims[i] / 2 + 1 : dims[i]);
+    }
+
+    auto key = plan_key{plan_kind::r2c,
+                        std::vector<int>(dims, dims + rank),
+                        fftw_count,
+                        in.indexmap().strides()[0],  // stride of the in data
+                        1,                           // in : shift for multi fft.
+                        out.indexmap().strides()[0], // stride of the out data
+                        1,                           // out : shift for multi fft.
+                        FFTW_FORWARD,
+                        false,
+                        alignment_of(in_fft),
+                        alignment_of(out_fft),
+                        planner_flags.load(),
+                        fftw_n_threads()};
+
+    long in_bytes  = extent(n_in, key.howmany, key.istride, key.idist) * sizeof(double);
+    long out_bytes = extent(n_out, key.howmany, key.ostride, key.odist) * sizeof(fftw_complex);
+
+    auto p = get_plan(key, in_bytes, out_bytes, [&](void *in_scratch, void *out_scratch) {
+      return fftw_plan_many_dft_r2c(rank,                                     // rank
+                                    dims,                                     // the dimension
+                                    key.howmany,                              // how many FFT
+                                    static_cast<double *>(in_scratch),        // in data
+                                    NULL,                                     // embed : unused. Doc unclear ?
+                                    key.istride,                              // stride of the in data
+                                    key.idist,                                // in : shift for multi fft.
+                                    static_cast<fftw_complex *>(out_scratch), // out data
+                                    NULL,                                     // embed : unused. Doc unclear ?
+                                    key.ostride,                              // stride of the out data
+                                    key.odist,                                // out : shift for multi fft.
+                                    key.flags);
+    });
+
+    fftw_execute_dft_r2c(p.get(), in_fft, out_fft);
+  }
+
+  // -------------------------------------------------------------------------------------------
+
+  void _fourier_strided(dcomplex const *in, dcomplex *out, std::vector<_fourier_dim_t> const &dims, std::vector<_fourier_dim_t> const &howmany_dims,
+                        int fftw_backward_forward) {
+
+    auto in_fft  = reinterpret_cast<fftw_complex *>(const_cast<dcomplex *>(in));
+    auto out_fft = reinterpret_cast<fftw_complex *>(out);
+
+    auto to_iodims = [](std::vector<_fourier_dim_t> const &v) {
+      std::vector<fftw_iodim64> r;
+      for (auto const &d : v) r.push_back({d.n, d.in_stride, d.out_stride});
+      return r;
+    };
+    auto iodims         = to_iodims(dims);
+    auto howmany_iodims = to_iodims(howmany_dims);
+
+    auto key = plan_key{plan_kind::guru_c2c, {}, 0, 0, 0, 0, 0, fftw_backward_forward, (in_fft == out_fft), alignment_of(in_fft),
+                        alignment_of(out_fft), planner_flags.load(), fftw_n_threads()};
+    for (auto const &d : dims) key.guru_dims.push_back({d.n, d.in_stride, d.out_stride});
+    for (auto const &d : howmany_dims) key.guru_howmany_dims.push_back({d.n, d.in_stride, d.out_stride});
+
+    // Number of elements spanned by the in and out data
+    long in_extent = 1, out_extent = 1;
+    for (auto const &d : iodims) {
+      in_extent += (d.n - 1) * std::abs(d.is);
+      out_extent += (d.n - 1) * std::abs(d.os);
+    }
+    for (auto const &d : howmany_iodims) {
+      in_extent += (d.n - 1) * std::abs(d.is);
+      out_extent += (d.n - 1) * std::abs(d.os);
+    }
+
+    auto p = get_plan(key, in_extent * sizeof(fftw_complex), out_extent * sizeof(fftw_complex), [&](void *in_scratch, void *out_scratch) {
+      return fftw_plan_guru64_dft(iodims.size(), iodims.data(), howmany_iodims.size(), howmany_iodims.data(), static_cast<fftw_complex *>(in_scratch),
+                                  static_cast<fftw_complex *>(out_scratch), fftw_backward_forward, key.flags);
+    });
+
+    fftw_execute_dft(p.get(), in_fft, out_fft);
+  }
 
 } // namespace triqs::gfs
@@ -21,6 +21,10 @@
 #include <triqs/arrays.hpp>
 // include only in cpp implementation
 #include <fftw3.h>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
 
 namespace triqs::gfs {
 
@@ -28,4 +32,44 @@ namespace triqs::gfs {
   // call to fftw
   void _fourier_base(array_const_view<dcomplex, 2> in, array_view<dcomplex, 2> out, int rank, int *dims, int fftw_count, int fftw_backward_forward);
 
+  // call to fftw for real input data (r2c, sign FFTW_FORWARD).
+  // out only holds the non-redundant part : the last of the dims is reduced to dims[rank-1] / 2 + 1
+  void _fourier_base(array_const_view<double, 2> in, array_view<dcomplex, 2> out, int rank, int *dims, int fftw_count);
+
+  // clear the tables of the tail model of the Matsubara transforms (fourier_matsubara.cpp), kept with the plans
+  void _clear_fourier_tail_tables();
+
+  // number of threads to be used by the transforms of the calling thread
+  int _fourier_n_threads();
+
+  // Minimal number of elements processed by a thread of _fourier_parallel_for.
+  // Starting a thread costs about as much as processing that many elements : smaller loops are not split.
+  constexpr long _fourier_min_work_per_thread = 1l << 14;
+
+  // Call f(first, last) on consecutive chunks of [0, n), one chunk per Fourier thread, with at least _fourier_min_work_per_thread
+  // elements per chunk. work_per_item : number of elements processed per iteration of the loop.
+  // NB : f must not create array views in its loop. Their reference counting is serialized by a global mutex.
+  template <typename F> void _fourier_parallel_for(long n, long work_per_item, F const &f) {
+    long n_chunks = std::min({long(_fourier_n_threads()), n, n * work_per_item / _fourier_min_work_per_thread});
+    if (n_chunks <= 1) {
+      f(0, n);
+      return;
+    }
+
+    std::vector<std::exception_ptr> errors(n_chunks);
+    auto run_chunk = [&](long c) {
+      try {
+        f(c * n / n_chunks, (c + 1) * n / n_chunks);
+      } catch (...) { errors[c] = std::current_exception(); }
+    };
+
+    std::vector<std::thread> workers;
+    for (long c = 1; c < n_chunks; ++c) workers.emplace_back(run_chunk, c);
+    run_chunk(0);
+    for (auto &w : workers) w.join();
+
+    for (auto &e : errors)
+      if (e) std::rethrow_exception(e);
+  }
+
 } // namespace triqs::gfs
@@ -26,6 +26,17 @@
 
 namespace triqs::gfs {
 
+  //check periodization_matrix is diagonal
+  template <typename M> void check_periodization_matrix(M const &m) {
+    auto &period_mat = m.periodization_matrix;
+    for (auto [i, j] : itertools::product_range(period_mat.shape()[0], period_mat.shape()[1]))
+      if (i != j and period_mat(i, j) != 0) {
+        std::cerr
+           << "WARNING: Fourier Transform of k-mesh with non-diagonal periodization matrix. Please make sure that the order of real and reciprocal space vectors is compatible for FFTW to work. (Cf. discussion doi:10.3929/ethz-a-010657714, p.26)\n";
+        break;
+      }
+  }
+
   // The implementation is almost the same in both cases...
   template <typename V1, typename V2> gf_vec_t<V1> __impl(int fftw_backward_forward, gf_mesh<V1> const &out_mesh, gf_vec_cvt<V2> g_in) {
 
@@ -35,14 +46,7 @@ namespace triqs::gfs {
     //ASSERT_EQUAL(g_in.data().indexmap().strides()[1], g_in.data().shape()[1], "Unexpected strides in fourier implementation");
     //ASSERT_EQUAL(g_in.data().indexmap().strides()[2], 1, "Unexpected strides in fourier implementation");
 
-    //check periodization_matrix is diagonal
-    auto &period_mat = g_in.mesh().periodization_matrix;
-    for (auto [i, j] : itertools::product_range(period_mat.shape()[0], period_mat.shape()[1]))
-      if (i != j and period_mat(i, j) != 0) {
-        std::cerr
-           << "WARNING: Fourier Transform of k-mesh with non-diagonal periodization matrix. Please make sure that the order of real and reciprocal space vectors is compatible for FFTW to work. (Cf. discussion doi:10.3929/ethz-a-010657714, p.26)\n";
-        break;
-      }
+    check_periodization_matrix(g_in.mesh());
 
     auto g_out    = gf_vec_t<V1>{out_mesh, g_in.target_shape()[0]};
     long n_others = second_dim(g_in.data());
@@ -53,6 +57,40 @@ namespace triqs::gfs {
     return std::move(g_out);
   }
 
+  // Real input data : r2c transform of the non-redundant half of the last (non-trivial) dimension.
+  // The other half is restored using the hermitian symmetry G(-k) = G(k)^*
+  template <typename V1, typename V2> gf_vec_t<V1> __impl(int fftw_backward_forward, gf_mesh<V1> const &out_mesh, gf_vec_real_cvt<V2> g_in) {
+
+    check_periodization_matrix(g_in.mesh());
+
+    auto g_out    = gf_vec_t<V1>{out_mesh, g_in.target_shape()[0]};
+    long n_others = second_dim(g_in.data());
+
+    auto dims       = g_in.mesh().get_dimensions();
+    int rank        = g_in.mesh().rank();
+    auto hdims      = dims; // dimensions of the r2c output
+    hdims[rank - 1] = dims[rank - 1] / 2 + 1;
+
+    array<dcomplex, 2> _gout(long(hdims[0]) * hdims[1] * hdims[2], n_others);
+    _fourier_base(g_in.data(), _gout, rank, dims.ptr(), n_others);
+
+    // r2c uses the sign FFTW_FORWARD, the FFTW_BACKWARD transform is its complex conjugate
+    bool forward = (fftw_backward_forward == FFTW_FORWARD);
+    auto &g_dat  = g_out.data();
+    _fourier_parallel_for(long(dims[0]) * dims[1] * dims[2], n_others, [&](long first, long last) {
+      for (long l = first; l < last; ++l) {
+        long i[3] = {l / (dims[1] * dims[2]), (l / dims[2]) % dims[1], l % dims[2]}, j[3] = {i[0], i[1], i[2]};
+        bool in_half = (i[rank - 1] < hdims[rank - 1]);
+        if (not in_half)
+          for (int d = 0; d < 3; ++d) j[d] = (dims[d] - i[d]) % dims[d];
+        long l_h = (j[0] * hdims[1] + j[1]) * hdims[2] + j[2];
+        for (long k = 0; k < n_others; ++k) g_dat(l, k) = (in_half == forward ? _gout(l_h, k) : std::conj(_gout(l_h, k)));
+      }
+    });
+
+    return std::move(g_out);
+  }
+
   // ------------------------ DIRECT TRANSFORM --------------------------------------------
 
   gf_vec_t<cyclic_lattice> _fourier_impl(gf_mesh<cyclic_lattice> const &r_mesh, gf_vec_cvt<brillouin_zone> gk) {
@@ -67,4 +105,16 @@ namespace triqs::gfs {
     return __impl(FFTW_BACKWARD, k_mesh, gr);
   }
 
+  // ------------------------ REAL INPUT DATA --------------------------------------------
+
+  gf_vec_t<cyclic_lattice> _fourier_impl(gf_mesh<cyclic_lattice> const &r_mesh, gf_vec_real_cvt<brillouin_zone> gk) {
+    auto gr = __impl(FFTW_FORWARD, r_mesh, gk);
+    gr.data() /= gk.mesh().size();
+    return std::move(gr);
+  }
+
+  gf_vec_t<brillouin_zone> _fourier_impl(gf_mesh<brillouin_zone> const &k_mesh, gf_vec_real_cvt<cyclic_lattice> gr) {
+    return __impl(FFTW_BACKWARD, k_mesh, gr);
+  }
+
 } // namespace triqs::gfs
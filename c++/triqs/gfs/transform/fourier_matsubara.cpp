@@ -19,24 +19,29 @@
 
 #include "../../gfs.hpp"
 #include "./fourier_common.hpp"
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 namespace triqs::gfs {
 
   namespace {
 
-    // NB : will return an expression template, but compute the number after a*
-    template <typename A> auto oneFermion(A &&a, double b, double tau, double beta) {
-      return -a * (b >= 0 ? exp(-b * tau) / (1 + exp(-beta * b)) : exp(b * (beta - tau)) / (1 + exp(beta * b)));
+    // Value at tau of the fermionic / bosonic function with a single pole at b and unit residue
+    double fermion_pole(double b, double tau, double beta) {
+      return -(b >= 0 ? exp(-b * tau) / (1 + exp(-beta * b)) : exp(b * (beta - tau)) / (1 + exp(beta * b)));
     }
 
-    template <typename A> auto oneBoson(A &&a, double b, double tau, double beta) {
-      return a * (b >= 0 ? exp(-b * tau) / (exp(-beta * b) - 1) : exp(b * (beta - tau)) / (1 - exp(b * beta)));
+    double boson_pole(double b, double tau, double beta) {
+      return (b >= 0 ? exp(-b * tau) / (exp(-beta * b) - 1) : exp(b * (beta - tau)) / (1 - exp(b * beta)));
     }
   } // namespace
 
   //-------------------------------------
 
-  array<dcomplex, 2> fit_tail(gf_const_view<imtime, tensor_valued<1>> gt) {
+  template <typename T> array<dcomplex, 2> fit_tail_imtime(gf_const_view<imtime, T> gt) {
     using matrix_t   = arrays::matrix<dcomplex>;
     int fit_order    = 8;
     auto _           = range();
@@ -92,46 +97,216 @@ namespace triqs::gfs {
     return tail;
   }
 
-  // ------------------------ DIRECT TRANSFORM --------------------------------------------
-
-  gf_vec_t<imfreq> _fourier_impl(gf_mesh<imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+  namespace {
 
-    arrays::array<dcomplex, 2> tail;
-
-    if (known_moments.is_empty()) {
-      // A simple check on whether or not we are dealing with noisy data
-      auto dat   = gt.data();
-      int n_tau  = gt.mesh().size();
-      auto der_1 = max_element(abs(dat(1, range()) - dat(0, range())) + abs(dat(n_tau - 2, range()) - dat(n_tau - 1, range()))) / gt.mesh().delta();
-      auto der_2 =
-         0.5 * max_element(abs(dat(2, range()) - dat(0, range())) + abs(dat(n_tau - 3, range()) - dat(n_tau - 1, range()))) / gt.mesh().delta();
-      if (der_1 < 0.95 * der_2 or der_1 > 1.05 * der_2) {
-        std::cerr << "WARNING: Direct Fourier cannot deduce the high-frequency moments of G(tau) due to noise or a coarse tau-grid. \
+    // The tail up to 3rd order for the direct transform, either fitted or from the known moments
+    template <typename T> array<dcomplex, 2> make_direct_tail(gf_const_view<imtime, T> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+      if (known_moments.is_empty()) {
+        // A simple check on whether or not we are dealing with noisy data
+        auto dat   = gt.data();
+        int n_tau  = gt.mesh().size();
+        auto der_1 = max_element(abs(dat(1, range()) - dat(0, range())) + abs(dat(n_tau - 2, range()) - dat(n_tau - 1, range()))) / gt.mesh().delta();
+        auto der_2 =
+           0.5 * max_element(abs(dat(2, range()) - dat(0, range())) + abs(dat(n_tau - 3, range()) - dat(n_tau - 1, range()))) / gt.mesh().delta();
+        if (der_1 < 0.95 * der_2 or der_1 > 1.05 * der_2) {
+          std::cerr << "WARNING: Direct Fourier cannot deduce the high-frequency moments of G(tau) due to noise or a coarse tau-grid. \
 	  Please specify the high-frequency moments for higher accuracy.\n";
-        return _fourier_impl(iw_mesh, gt, make_zero_tail(gt, 4));
-      } else {
-	return _fourier_impl(iw_mesh, gt, fit_tail(gt));
+          return make_zero_tail(gt, 4);
+        } else {
+          return fit_tail_imtime(gt);
+        }
       }
-    } else {
+
       double _abs_tail0 = max_element(abs(known_moments(0, range())));
       TRIQS_ASSERT2((_abs_tail0 < 1e-8),
                     "ERROR: Direct Fourier implementation requires vanishing 0th moment\n  error is :" + std::to_string(_abs_tail0));
 
-      int n_known_moments = std::min<size_t>(known_moments.shape()[0], 4);
-      tail = make_zero_tail(gt, 4);
+      int n_known_moments                      = std::min<size_t>(known_moments.shape()[0], 4);
+      auto tail                                = make_zero_tail(gt, 4);
       tail(range(0, n_known_moments), range()) = known_moments(range(0, n_known_moments), range());
+      return tail;
+    }
+
+    // The tail up to (at least) 3rd order for the inverse transform, either known or fitted from the known moments
+    array<dcomplex, 2> make_inverse_tail(gf_vec_cvt<imfreq> gw, arrays::array_const_view<dcomplex, 2> known_moments) {
+
+      // Assume vanishing 0th moment in tail fit
+      if (known_moments.is_empty()) return make_inverse_tail(gw, make_zero_tail(gw, 1));
+
+      double _abs_tail0 = max_element(abs(known_moments(0, range())));
+      TRIQS_ASSERT2((_abs_tail0 < 1e-8),
+                    "ERROR: Inverse Fourier implementation requires vanishing 0th moment\n  error is :" + std::to_string(_abs_tail0) + "\n");
+
+      if (known_moments.shape()[0] >= 4) return array<dcomplex, 2>(known_moments); // known_moments is fine
+
+      auto [t, err] = fit_tail(gw, known_moments);
+      TRIQS_ASSERT2((err < 1e-2),
+                    "ERROR: High frequency moments have an error greater than 1e-2.\n  Error = " + std::to_string(err)
+                       + "\n Please make sure you treat the constant offset analytically!\n");
+      if (err > 1e-4)
+        std::cerr << "WARNING: High frequency moments have an error greater than 1e-4.\n Error = " << err
+                  << "\n Please make sure you treat the constant offset analytically!\n";
+      TRIQS_ASSERT2((first_dim(t) > 3), "ERROR: Inverse Fourier implementation requires at least a proper 3rd high-frequency moment\n");
+      return t;
     }
 
-    double beta = gt.mesh().domain().beta;
-    auto L      = gt.mesh().size() - 1;
-    if (L < 2 * (iw_mesh.last_index() + 1))
-      TRIQS_RUNTIME_ERROR << "Fourier: The time mesh mush be at least twice as long as the number of positive frequencies :\n gt.mesh().size() =  "
-                          << gt.mesh().size() << " gw.mesh().last_index()" << iw_mesh.last_index();
+    // Check the compatibility of the time and frequency meshes of the direct transform
+    void check_direct_meshes(gf_mesh<imfreq> const &iw_mesh, gf_mesh<imtime> const &tau_mesh) {
+      auto L = tau_mesh.size() - 1;
+      if (L < 2 * (iw_mesh.last_index() + 1))
+        TRIQS_RUNTIME_ERROR << "Fourier: The time mesh mush be at least twice as long as the number of positive frequencies :\n gt.mesh().size() =  "
+                            << tau_mesh.size() << " gw.mesh().last_index()" << iw_mesh.last_index();
+
+      if (L < 6 * (iw_mesh.last_index() + 1))
+        std::cerr << "[Direct Fourier] WARNING: The imaginary time mesh is less than six times as long as the number of positive frequencies.\n"
+                  << "This can lead to substantial numerical inaccuracies at the boundary of the frequency mesh.\n";
+    }
 
-    if (L < 6 * (iw_mesh.last_index() + 1))
-      std::cerr << "[Direct Fourier] WARNING: The imaginary time mesh is less than six times as long as the number of positive frequencies.\n"
-                << "This can lead to substantial numerical inaccuracies at the boundary of the frequency mesh.\n";
+    // The tail up to 3rd order is represented by three poles b_i with residues a(i, _).
+    // The b_i only depend on the statistic, so the pole functions are tabulated once per mesh, see below.
+    std::array<double, 3> tail_pole_positions(bool is_fermion) {
+      if (is_fermion) return {0, 1, -1};
+      return {-0.5, -1, 1};
+    }
+
+    array<dcomplex, 2> make_tail_residues(arrays::array_const_view<dcomplex, 2> tail, bool is_fermion) {
+      auto _  = range();
+      auto m1 = tail(1, _);
+      auto m2 = tail(2, _);
+      auto m3 = tail(3, _);
+      auto a  = array<dcomplex, 2>(3, second_dim(tail));
+      if (is_fermion) {
+        a(0, _) = m1 - m3;
+        a(1, _) = (m2 + m3) / 2;
+        a(2, _) = (m3 - m2) / 2;
+      } else {
+        a(0, _) = 4 * (m1 - m3) / 3;
+        a(1, _) = m3 - (m1 + m2) / 2;
+        a(2, _) = m1 / 6 + m2 / 2 + m3 / 3;
+      }
+      return a;
+    }
+
+    // The tail model on the imaginary time mesh
+    struct tau_tail_table {
+      array<dcomplex, 1> phase; // exp(i pi tau_k / beta)
+      array<double, 2> c;       // c(k, i) : the pole function of b_i at tau_k
+    };
+
+    // The tail model on the Matsubara mesh
+    struct iw_tail_table {
+      array<dcomplex, 2> d; // d(l, i) = 1 / (i omega_l - b_i)
+    };
+
+    // The tables are computed once per mesh and kept, like the fftw plans, until clear_fourier_plan_cache
+    template <typename Key, typename T> struct table_cache {
+      std::mutex mtx;
+      std::map<Key, std::shared_ptr<const T>> tables;
+
+      template <typename F> std::shared_ptr<const T> get(Key const &key, F make) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto &r = tables[key];
+        if (!r) r = std::make_shared<const T>(make());
+        return r;
+      }
+
+      void clear() {
+        std::lock_guard<std::mutex> lock(mtx);
+        tables.clear();
+      }
+    };
+
+    auto &get_tau_tables() {
+      static table_cache<std::tuple<double, long, bool>, tau_tail_table> cache;
+      return cache;
+    }
+
+    auto &get_iw_tables() {
+      static table_cache<std::tuple<double, long, long, bool>, iw_tail_table> cache;
+      return cache;
+    }
+
+    // NB : the statistic is the one of the Matsubara mesh, like the residues of the tail (make_tail_residues)
+    std::shared_ptr<const tau_tail_table> get_tail_table(gf_mesh<imtime> const &tau_mesh, bool is_fermion) {
+      double beta = tau_mesh.domain().beta;
+      long n_tau  = tau_mesh.size();
+      return get_tau_tables().get({beta, n_tau, is_fermion}, [&]() {
+        auto b    = tail_pole_positions(is_fermion);
+        auto pole = (is_fermion ? fermion_pole : boson_pole);
+        auto r    = tau_tail_table{array<dcomplex, 1>(n_tau), array<double, 2>(n_tau, 3)};
+        for (long k = 0; k < n_tau; ++k) {
+          double t   = tau_mesh.index_to_point(k);
+          r.phase(k) = exp(M_PI * 1i * t / beta);
+          for (int i = 0; i < 3; ++i) r.c(k, i) = pole(b[i], t, beta);
+        }
+        return r;
+      });
+    }
+
+    std::shared_ptr<const iw_tail_table> get_tail_table(gf_mesh<imfreq> const &iw_mesh) {
+      bool is_fermion = (iw_mesh.domain().statistic == Fermion);
+      long first = iw_mesh.first_index(), n_iw = iw_mesh.size();
+      return get_iw_tables().get({iw_mesh.domain().beta, first, n_iw, is_fermion}, [&]() {
+        auto b = tail_pole_positions(is_fermion);
+        auto r = iw_tail_table{array<dcomplex, 2>(n_iw, 3)};
+        for (long l = 0; l < n_iw; ++l) {
+          dcomplex w = iw_mesh.index_to_point(int(l + first));
+          for (int i = 0; i < 3; ++i) r.d(l, i) = 1.0 / (w - b[i]);
+        }
+        return r;
+      });
+    }
+
+    // Raw access to the elements of a 2d array. The loops over the mesh below work on the whole
+    // (mesh x n_others) block with it : no view and no temporary is created per mesh point.
+    template <typename T> struct raw_2d {
+      T *p;
+      long s0, s1;
+      T &operator()(long k, long j) const { return p[k * s0 + j * s1]; }
+    };
+
+    template <typename A> auto make_raw(A &a) {
+      auto p = a.data_start();
+      return raw_2d<std::remove_pointer_t<decltype(p)>>{p, a.indexmap().strides()[0], a.indexmap().strides()[1]};
+    }
+
+    // The tail model sum_i w[i] a(i, j), for the tabulated coefficients w of a mesh point
+    template <typename W, typename A> FORCEINLINE auto tail_at(W const *w, raw_2d<A> const &a, long j) {
+      return w[0] * a(0, j) + w[1] * a(1, j) + w[2] * a(2, j);
+    }
+
+  } // namespace
+
+  void _clear_fourier_tail_tables() {
+    get_tau_tables().clear();
+    get_iw_tables().clear();
+  }
+
+  // ------------------------ TAILS --------------------------------------------
+
+  // Only the moments 0 to 3 enter the transforms
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imfreq> const &, gf_vec_cvt<imtime> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+    return make_direct_tail(gt, known_moments);
+  }
+
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imfreq> const &, gf_vec_real_cvt<imtime> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+    return make_direct_tail(gt, known_moments);
+  }
 
+  array<dcomplex, 2> _fourier_tail(gf_mesh<imtime> const &, gf_vec_cvt<imfreq> gw, arrays::array_const_view<dcomplex, 2> known_moments) {
+    TRIQS_ASSERT2(!gw.mesh().positive_only(), "Fourier is only implemented for g(i omega_n) with full mesh (positive and negative frequencies)");
+    return array<dcomplex, 2>(make_inverse_tail(gw, known_moments)(range(0, 4), range()));
+  }
+
+  // ------------------------ DIRECT TRANSFORM --------------------------------------------
+
+  gf_vec_t<imfreq> _fourier_impl(gf_mesh<imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+
+    auto tail = make_direct_tail(gt, known_moments);
+    check_direct_meshes(iw_mesh, gt.mesh());
+
+    double beta   = gt.mesh().domain().beta;
+    auto L        = gt.mesh().size() - 1;
     long n_others = second_dim(gt.data());
 
     array<dcomplex, 2> _gout(L, n_others); // FIXME Why do we need this dimension to be one less than gt.mesh().size() ?
@@ -139,48 +314,142 @@ namespace triqs::gfs {
 
     bool is_fermion = (iw_mesh.domain().statistic == Fermion);
     double fact     = beta / L;
-    dcomplex iomega = M_PI * 1i / beta;
 
-    double b1, b2, b3;
-    array<dcomplex, 1> a1, a2, a3;
-    auto _  = range();
-    auto m1 = tail(1, _);
-    auto m2 = tail(2, _);
-    auto m3 = tail(3, _);
+    auto _       = range();
+    auto m1      = tail(1, _);
+    auto a       = make_tail_residues(tail, is_fermion);
+    auto tau_tab = get_tail_table(gt.mesh(), is_fermion);
+    auto iw_tab  = get_tail_table(iw_mesh);
+
+    auto gt_dat = gt.data();
+    auto g = make_raw(gt_dat), in = make_raw(_gin), ra = make_raw(a), c = make_raw(tau_tab->c);
+    auto phase = tau_tab->phase.data_start();
+    _fourier_parallel_for(L + 1, n_others, [&](long first, long last) {
+      for (long k = first; k < last; ++k) {
+        dcomplex f = fact * (is_fermion ? phase[k] : 1.0);
+        auto ck    = &c(k, 0);
+        for (long j = 0; j < n_others; ++j) in(k, j) = f * (g(k, j) - tail_at(ck, ra, j));
+      }
+    });
 
-    if (is_fermion) {
-      b1 = 0;
-      b2 = 1;
-      b3 = -1;
-      a1 = m1 - m3;
-      a2 = (m2 + m3) / 2;
-      a3 = (m3 - m2) / 2;
+    int dims[] = {int(L)};
+    _fourier_base(_gin, _gout, 1, dims, n_others, FFTW_BACKWARD);
 
-      for (auto const &t : gt.mesh())
-        _gin(t.index(), _) =
-           fact * exp(iomega * t) * (gt[t] - (oneFermion(a1, b1, t, beta) + oneFermion(a2, b2, t, beta) + oneFermion(a3, b3, t, beta)));
+    auto gw = gf_vec_t<imfreq>{iw_mesh, {int(n_others)}};
 
-    } else {
-      b1 = -0.5;
-      b2 = -1;
-      b3 = 1;
-      a1 = 4 * (m1 - m3) / 3;
-      a2 = m3 - (m1 + m2) / 2;
-      a3 = m1 / 6 + m2 / 2 + m3 / 3;
-
-      for (auto const &t : gt.mesh())
-        _gin(t.index(), _) = fact * (gt[t] - (oneBoson(a1, b1, t, beta) + oneBoson(a2, b2, t, beta) + oneBoson(a3, b3, t, beta)));
+    // Correction term to account for proper Trapezoidal integration
+    array<dcomplex, 1> corr = -0.5 * fact * (gt[0] + m1 + (is_fermion ? 1 : -1) * gt[L]);
+
+    auto &gw_dat = gw.data();
+    auto out = make_raw(_gout), w = make_raw(gw_dat), d = make_raw(iw_tab->d);
+    auto corr_p = corr.data_start();
+    _fourier_parallel_for(iw_mesh.size(), n_others, [&](long first, long last) {
+      for (long l = first; l < last; ++l) {
+        long p  = (l + iw_mesh.first_index() + L) % L;
+        auto dl = &d(l, 0);
+        for (long j = 0; j < n_others; ++j) w(l, j) = out(p, j) + corr_p[j] + tail_at(dl, ra, j);
+      }
+    });
+
+    return std::move(gw);
+  }
+
+  // ------------------------ DIRECT TRANSFORM, REAL DATA --------------------------------------------
+
+  // For real G(tau) (and a real tail) the result has the hermitian symmetry G(-i omega_n) = G(i omega_n)^*.
+  // Bosons : r2c transform of the L real values, only L/2 + 1 frequencies are computed.
+  // Fermions : with M = L / 2 and omega = exp(i pi / L), G(i omega_n) = sum_k h_k omega^{(2n+1)k} splits into
+  //   G_{2m} = sum_{k<M} omega^k (h_k + i h_{k+M}) exp(2 i pi m k / M)  and  G_{L-1-2m} = G_{2m}^*,
+  //   i.e. a single in-place complex transform of length L/2 on the packed data.
+  gf_vec_t<imfreq> _fourier_impl(gf_mesh<imfreq> const &iw_mesh, gf_vec_real_cvt<imtime> gt, arrays::array_const_view<dcomplex, 2> known_moments) {
+
+    auto tail       = make_direct_tail(gt, known_moments);
+    auto L          = gt.mesh().size() - 1;
+    bool is_fermion = (iw_mesh.domain().statistic == Fermion);
+
+    // Complex tail or odd number of intervals for fermions : transform the complex copy
+    if (max_element(abs(imag(tail))) > 0 or (is_fermion and L % 2 == 1)) {
+      auto gt_cplx = gf_vec_t<imtime>{gt.mesh(), array<dcomplex, 2>(gt.data()), {}};
+      return _fourier_impl(iw_mesh, make_const_view(gt_cplx), tail);
     }
 
-    int dims[] = {int(L)};
-    _fourier_base(_gin, _gout, 1, dims, n_others, FFTW_BACKWARD);
+    check_direct_meshes(iw_mesh, gt.mesh());
+
+    double beta   = gt.mesh().domain().beta;
+    long n_others = second_dim(gt.data());
+    double fact   = beta / L;
+
+    auto _             = range();
+    auto m1            = tail(1, _);
+    array<double, 2> a = real(make_tail_residues(tail, is_fermion));
+    auto tau_tab       = get_tail_table(gt.mesh(), is_fermion);
+    auto iw_tab        = get_tail_table(iw_mesh);
 
     auto gw = gf_vec_t<imfreq>{iw_mesh, {int(n_others)}};
 
     // Correction term to account for proper Trapezoidal integration
-    // FIXME Avoid copy, by doing proper in-place operation
-    auto corr = -0.5 * fact * (gt[0] + m1 + (is_fermion ? 1 : -1) * gt[L]);
-    for (auto const &w : iw_mesh) gw[w] = _gout((w.index() + L) % L, _) + corr + a1 / (w - b1) + a2 / (w - b2) + a3 / (w - b3);
+    array<dcomplex, 1> corr = -0.5 * fact * (gt[0] + m1 + (is_fermion ? 1 : -1) * gt[L]);
+
+    auto gt_dat  = gt.data();
+    auto &gw_dat = gw.data();
+    auto g = make_raw(gt_dat), w = make_raw(gw_dat), ra = make_raw(a), c = make_raw(tau_tab->c), d = make_raw(iw_tab->d);
+    auto phase  = tau_tab->phase.data_start();
+    auto corr_p = corr.data_start();
+
+    // G(tau_k) - G_tail(tau_k) for the k-th point of the mesh
+    auto g_no_tail = [&](long k, long j) { return g(k, j) - tail_at(&c(k, 0), ra, j); };
+
+    // gw[l] = G(i omega) from the transformed value x (or its conjugate) at the l-th frequency
+    auto set_gw = [&](long l, long j, dcomplex x) { w(l, j) = x + corr_p[j] + tail_at(&d(l, 0), ra, j); };
+
+    if (is_fermion) {
+      long M = L / 2;
+      array<dcomplex, 2> _g(M, n_others); // transformed in place
+      auto h = make_raw(_g);
+
+      _fourier_parallel_for(M, n_others, [&](long first, long last) {
+        for (long k = first; k < last; ++k) {
+          dcomplex f = fact * phase[k];
+          for (long j = 0; j < n_others; ++j) h(k, j) = f * dcomplex{g_no_tail(k, j), g_no_tail(k + M, j)};
+        }
+      });
+
+      int dims[] = {int(M)};
+      _fourier_base(_g, _g, 1, dims, n_others, FFTW_BACKWARD);
+
+      _fourier_parallel_for(iw_mesh.size(), n_others, [&](long first, long last) {
+        for (long l = first; l < last; ++l) {
+          long p = (l + iw_mesh.first_index() + L) % L;
+          if (p % 2 == 0)
+            for (long j = 0; j < n_others; ++j) set_gw(l, j, h(p / 2, j));
+          else
+            for (long j = 0; j < n_others; ++j) set_gw(l, j, std::conj(h((L - 1 - p) / 2, j)));
+        }
+      });
+    } else {
+      array<double, 2> _gin(L, n_others);
+      array<dcomplex, 2> _gout(L / 2 + 1, n_others);
+      auto in = make_raw(_gin), out = make_raw(_gout);
+
+      _fourier_parallel_for(L, n_others, [&](long first, long last) {
+        for (long k = first; k < last; ++k)
+          for (long j = 0; j < n_others; ++j) in(k, j) = fact * g_no_tail(k, j);
+      });
+
+      int dims[] = {int(L)};
+      _fourier_base(_gin, _gout, 1, dims, n_others);
+
+      // r2c uses the sign FFTW_FORWARD, i.e. yields the complex conjugate of the FFTW_BACKWARD transform
+      _fourier_parallel_for(iw_mesh.size(), n_others, [&](long first, long last) {
+        for (long l = first; l < last; ++l) {
+          long p = (l + iw_mesh.first_index() + L) % L;
+          if (p <= L / 2)
+            for (long j = 0; j < n_others; ++j) set_gw(l, j, std::conj(out(p, j)));
+          else
+            for (long j = 0; j < n_others; ++j) set_gw(l, j, out(L - p, j));
+        }
+      });
+    }
 
     return std::move(gw);
   }
@@ -191,27 +460,7 @@ namespace triqs::gfs {
 
     TRIQS_ASSERT2(!gw.mesh().positive_only(), "Fourier is only implemented for g(i omega_n) with full mesh (positive and negative frequencies)");
 
-    arrays::array_const_view<dcomplex, 2> tail;
-
-    // Assume vanishing 0th moment in tail fit
-    if (known_moments.is_empty()) return _fourier_impl(tau_mesh, gw, make_zero_tail(gw, 1));
-
-    double _abs_tail0 = max_element(abs(known_moments(0, range())));
-    TRIQS_ASSERT2((_abs_tail0 < 1e-8),
-                  "ERROR: Inverse Fourier implementation requires vanishing 0th moment\n  error is :" + std::to_string(_abs_tail0) + "\n");
-
-    if (known_moments.shape()[0] < 4) {
-      auto [t, err] = fit_tail(gw, known_moments);
-      TRIQS_ASSERT2((err < 1e-2),
-                    "ERROR: High frequency moments have an error greater than 1e-2.\n  Error = " + std::to_string(err)
-                       + "\n Please make sure you treat the constant offset analytically!\n");
-      if (err > 1e-4)
-        std::cerr << "WARNING: High frequency moments have an error greater than 1e-4.\n Error = " << err
-                  << "\n Please make sure you treat the constant offset analytically!\n";
-      TRIQS_ASSERT2((first_dim(t) > 3), "ERROR: Inverse Fourier implementation requires at least a proper 3rd high-frequency moment\n");
-      return _fourier_impl(tau_mesh, gw, t);
-    } else
-      tail.rebind(known_moments); // known_moments is fine
+    auto tail = make_inverse_tail(gw, known_moments);
 
     double beta = tau_mesh.domain().beta;
     long L      = tau_mesh.size() - 1;
@@ -226,43 +475,39 @@ namespace triqs::gfs {
 
     bool is_fermion = (gw.domain().statistic == Fermion);
     double fact     = 1.0 / beta;
-    dcomplex iomega = M_PI * 1i / beta;
-
-    double b1, b2, b3;
-    array<dcomplex, 1> a1, a2, a3;
-    auto _  = range();
-    auto m1 = tail(1, _);
-    auto m2 = tail(2, _);
-    auto m3 = tail(3, _);
 
-    if (is_fermion) {
-      b1 = 0;
-      b2 = 1;
-      b3 = -1;
-      a1 = m1 - m3;
-      a2 = (m2 + m3) / 2;
-      a3 = (m3 - m2) / 2;
-    } else {
-      b1 = -0.5;
-      b2 = -1;
-      b3 = 1;
-      a1 = 4 * (m1 - m3) / 3;
-      a2 = m3 - (m1 + m2) / 2;
-      a3 = m1 / 6 + m2 / 2 + m3 / 3;
-    }
-
-    for (auto const &w : gw.mesh()) _gin((w.index() + L) % L, _) = fact * (gw[w] - (a1 / (w - b1) + a2 / (w - b2) + a3 / (w - b3)));
+    auto _              = range();
+    auto m1             = tail(1, _);
+    auto a              = make_tail_residues(tail, is_fermion);
+    auto const &iw_mesh = gw.mesh();
+    auto tau_tab        = get_tail_table(tau_mesh, is_fermion);
+    auto iw_tab         = get_tail_table(iw_mesh);
+
+    auto gw_dat = gw.data();
+    auto w = make_raw(gw_dat), in = make_raw(_gin), ra = make_raw(a), d = make_raw(iw_tab->d);
+    _fourier_parallel_for(iw_mesh.size(), n_others, [&](long first, long last) {
+      for (long l = first; l < last; ++l) {
+        long p  = (l + iw_mesh.first_index() + L) % L;
+        auto dl = &d(l, 0);
+        for (long j = 0; j < n_others; ++j) in(p, j) = fact * (w(l, j) - tail_at(dl, ra, j));
+      }
+    });
 
     int dims[] = {int(L)};
     _fourier_base(_gin, _gout, 1, dims, n_others, FFTW_FORWARD);
 
     auto gt = gf_vec_t<imtime>{tau_mesh, {int(n_others)}};
 
-    if (is_fermion)
-      for (auto const &t : tau_mesh)
-        gt[t] = _gout(t.index(), _) * exp(-iomega * t) + oneFermion(a1, b1, t, beta) + oneFermion(a2, b2, t, beta) + oneFermion(a3, b3, t, beta);
-    else
-      for (auto const &t : tau_mesh) gt[t] = _gout(t.index(), _) + oneBoson(a1, b1, t, beta) + oneBoson(a2, b2, t, beta) + oneBoson(a3, b3, t, beta);
+    auto &gt_dat = gt.data();
+    auto out = make_raw(_gout), g = make_raw(gt_dat), c = make_raw(tau_tab->c);
+    auto phase = tau_tab->phase.data_start();
+    _fourier_parallel_for(L + 1, n_others, [&](long first, long last) {
+      for (long k = first; k < last; ++k) {
+        dcomplex f = (is_fermion ? std::conj(phase[k]) : 1.0);
+        auto ck    = &c(k, 0);
+        for (long j = 0; j < n_others; ++j) g(k, j) = out(k, j) * f + tail_at(ck, ra, j);
+      }
+    });
 
     double pm = (is_fermion ? -1 : 1);
     gt[L]     = pm * (gt[0] + m1);
@@ -66,14 +66,27 @@ namespace triqs::gfs {
 
     array<dcomplex, 1> a1 = (m1 + I * m2 / a) / 2., a2 = (m1 - I * m2 / a) / 2.;
 
-    for (auto const &t : gt.mesh()) _gin(t.index(), _) = (gt[t] - (a1 * th_expo(t, a) + a2 * th_expo_neg(t, a))) * std::exp(I * t * wmin);
+    auto gt_dat = gt.data();
+    _fourier_parallel_for(L, n_others, [&](long first, long last) {
+      for (long k = first; k < last; ++k) {
+        double t   = gt.mesh().index_to_point(k);
+        dcomplex f = std::exp(I * t * wmin), e1 = th_expo(t, a), e2 = th_expo_neg(t, a);
+        for (long j = 0; j < n_others; ++j) _gin(k, j) = (gt_dat(k, j) - (a1(j) * e1 + a2(j) * e2)) * f;
+      }
+    });
 
     int dims[] = {int(L)};
     _fourier_base(_gin, _gout, 1, dims, n_others, FFTW_BACKWARD);
 
-    auto gw = gf_vec_t<refreq>{w_mesh, {int(n_others)}};
-    for (auto const &w : w_mesh)
-      gw[w] = gt.mesh().delta() * std::exp(I * (w - wmin) * tmin) * _gout(w.index(), _) + a1 * th_expo_inv(w, a) + a2 * th_expo_neg_inv(w, a);
+    auto gw      = gf_vec_t<refreq>{w_mesh, {int(n_others)}};
+    auto &gw_dat = gw.data();
+    _fourier_parallel_for(L, n_others, [&](long first, long last) {
+      for (long l = first; l < last; ++l) {
+        double w   = w_mesh.index_to_point(l);
+        dcomplex f = gt.mesh().delta() * std::exp(I * (w - wmin) * tmin), e1 = th_expo_inv(w, a), e2 = th_expo_neg_inv(w, a);
+        for (long j = 0; j < n_others; ++j) gw_dat(l, j) = f * _gout(l, j) + a1(j) * e1 + a2(j) * e2;
+      }
+    });
 
     return std::move(gw);
   }
@@ -118,14 +131,28 @@ namespace triqs::gfs {
 
     array<dcomplex, 1> a1 = (m1 + I * m2 / a) / 2., a2 = (m1 - I * m2 / a) / 2.;
 
-    for (auto const &w : gw.mesh()) _gin(w.index(), _) = (gw[w] - a1 * th_expo_inv(w, a) - a2 * th_expo_neg_inv(w, a)) * std::exp(-I * w * tmin);
+    auto gw_dat = gw.data();
+    _fourier_parallel_for(L, n_others, [&](long first, long last) {
+      for (long l = first; l < last; ++l) {
+        double w   = gw.mesh().index_to_point(l);
+        dcomplex f = std::exp(-I * w * tmin), e1 = th_expo_inv(w, a), e2 = th_expo_neg_inv(w, a);
+        for (long j = 0; j < n_others; ++j) _gin(l, j) = (gw_dat(l, j) - a1(j) * e1 - a2(j) * e2) * f;
+      }
+    });
 
     int dims[] = {int(L)};
     _fourier_base(_gin, _gout, 1, dims, n_others, FFTW_FORWARD);
 
     auto gt           = gf_vec_t<retime>{t_mesh, {int(n_others)}};
+    auto &gt_dat      = gt.data();
     const double corr = 1.0 / (t_mesh.delta() * L);
-    for (auto const &t : t_mesh) gt[t] = corr * std::exp(I * wmin * (tmin - t)) * _gout(t.index(), _) + a1 * th_expo(t, a) + a2 * th_expo_neg(t, a);
+    _fourier_parallel_for(L, n_others, [&](long first, long last) {
+      for (long k = first; k < last; ++k) {
+        double t   = t_mesh.index_to_point(k);
+        dcomplex f = corr * std::exp(I * wmin * (tmin - t)), e1 = th_expo(t, a), e2 = th_expo_neg(t, a);
+        for (long j = 0; j < n_others; ++j) gt_dat(k, j) = f * _gout(k, j) + a1(j) * e1 + a2(j) * e2;
+      }
+    });
 
     return std::move(gt);
   }
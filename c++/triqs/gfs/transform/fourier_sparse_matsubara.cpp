@@ -0,0 +1,89 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include "../../gfs.hpp"
+#include <triqs/arrays/blas_lapack/gelss.hpp>
+
+// Transforms between gf_mesh<imtime> and gf_mesh<sparse_imfreq>, through the coefficients c_k of the discrete Lehmann representation.
+// No fftw here : the cost is O(n_tau * r * n_others), r being the (small) size of the sparse mesh.
+
+namespace triqs::gfs {
+
+  namespace {
+
+    void check_sparse_meshes(gf_mesh<sparse_imfreq> const &iw_mesh, gf_mesh<imtime> const &tau_mesh, array_const_view<dcomplex, 2> known_moments) {
+      if (std::abs(iw_mesh.domain().beta - tau_mesh.domain().beta) > 1.e-15 or iw_mesh.domain().statistic != tau_mesh.domain().statistic)
+        TRIQS_RUNTIME_ERROR << "Fourier: The sparse Matsubara mesh and the imaginary time mesh have different beta or statistic";
+      TRIQS_ASSERT2(known_moments.is_empty(), "Fourier: The transforms with a sparse Matsubara mesh do not use known moments");
+    }
+
+    // The matrix K(tau_i / beta, omega_k) of the discrete Lehmann representation on the tau mesh
+    matrix<dcomplex> k_tau_matrix(gf_mesh<imtime> const &tau_mesh, dlr_basis const &basis) {
+      double beta       = tau_mesh.domain().beta;
+      auto const &omega = basis.omega();
+      auto K            = matrix<dcomplex>(tau_mesh.size(), basis.rank());
+      for (long i = 0; i < tau_mesh.size(); ++i) {
+        double tau = std::min(tau_mesh.index_to_point(i) / beta, 1.0);
+        for (long k = 0; k < basis.rank(); ++k) K(i, k) = dlr_basis::k_tau(tau, omega[k]);
+      }
+      return K;
+    }
+
+    // Solve A x = b in the least square sense for each column of b, returning x.
+    // NB : Through the SVD, i.e. backward stable, as required for the ill-conditioned matrices of the basis.
+    matrix<dcomplex> least_square_solve(matrix_const_view<dcomplex> A, matrix_const_view<dcomplex> b) {
+      auto A_FL = matrix<dcomplex>(A, FORTRAN_LAYOUT);
+      auto x    = matrix<dcomplex>(b, FORTRAN_LAYOUT);
+      arrays::vector<double> S;
+      int rank;
+      int info = arrays::lapack::gelss(A_FL, x, S, -1, rank);
+      if (info != 0) TRIQS_RUNTIME_ERROR << "Fourier: gelss failed with info = " << info;
+      return x(range(0, second_dim(A)), range());
+    }
+
+  } // namespace
+
+  //-------------------------------------
+
+  gf_vec_t<sparse_imfreq> _fourier_impl(gf_mesh<sparse_imfreq> const &iw_mesh, gf_vec_cvt<imtime> gt, array_const_view<dcomplex, 2> known_moments) {
+
+    check_sparse_meshes(iw_mesh, gt.mesh(), known_moments);
+    auto const &basis = iw_mesh.basis();
+    if (gt.mesh().size() < basis.rank())
+      TRIQS_RUNTIME_ERROR << "Fourier: The imaginary time mesh has less points (" << gt.mesh().size() << ") than the sparse Matsubara mesh ("
+                          << basis.rank() << ")";
+
+    // Fit of the c_k on the tau mesh, then G(i omega_{n_l}) = beta sum_k K_{n_l}(omega_k) c_k
+    auto c  = least_square_solve(k_tau_matrix(gt.mesh(), basis), make_matrix_view(gt.data()));
+    auto gw = gf_vec_t<sparse_imfreq>{iw_mesh, {int(second_dim(gt.data()))}};
+    blas::gemm(dcomplex(gt.mesh().domain().beta), basis.k_iw_nodes(), c, 0.0, make_matrix_view(gw.data()));
+    return gw;
+  }
+
+  //-------------------------------------
+
+  gf_vec_t<imtime> _fourier_impl(gf_mesh<imtime> const &tau_mesh, gf_vec_cvt<sparse_imfreq> gw, array_const_view<dcomplex, 2> known_moments) {
+
+    check_sparse_meshes(gw.mesh(), tau_mesh, known_moments);
+    auto const &basis = gw.mesh().basis();
+
+    // c_k from the values on the sparse mesh, then G(tau_i) = sum_k K(tau_i / beta, omega_k) c_k
+    auto c  = least_square_solve(basis.k_iw_nodes(), make_matrix_view(gw.data()));
+    auto gt = gf_vec_t<imtime>{tau_mesh, {int(second_dim(gw.data()))}};
+    blas::gemm(dcomplex(1.0 / tau_mesh.domain().beta), k_tau_matrix(tau_mesh, basis), c, 0.0, make_matrix_view(gt.data()));
+    return gt;
+  }
+
+} // namespace triqs::gfs
@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include "../../gfs.hpp"
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace triqs::gfs {
+
+  namespace {
+
+    // The cached matrices, by geometry. Never evicted : there are few distinct geometries in a calculation.
+    template <typename Key, typename M> struct matrix_cache {
+      std::mutex mtx;
+      std::map<Key, std::shared_ptr<const M>> m;
+
+      template <typename F> std::shared_ptr<const M> get(Key const &key, F make) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto &r = m[key];
+        if (!r) r = std::make_shared<const M>(make());
+        return r;
+      }
+    };
+
+  } // namespace
+
+  //-------------------------------------
+
+  std::shared_ptr<const matrix<dcomplex>> legendre_T_matrix(gf_mesh<imfreq> const &iw_mesh, long n_l) {
+    static matrix_cache<std::tuple<long, long, long>, matrix<dcomplex>> cache;
+
+    // T only depends on the indices n of the frequencies, not on the statistic
+    long first = iw_mesh.first_index(), n_iw = iw_mesh.size();
+    return cache.get({first, n_iw, n_l}, [&]() {
+      auto T = matrix<dcomplex>(n_iw, n_l);
+      for (long n = 0; n < n_iw; ++n)
+        for (long l = 0; l < n_l; ++l) T(n, l) = utility::legendre_T(first + n, l);
+      return T;
+    });
+  }
+
+  //-------------------------------------
+
+  std::shared_ptr<const matrix<double>> legendre_P_matrix(gf_mesh<imtime> const &tau_mesh, long n_l) {
+    static matrix_cache<std::tuple<long, long>, matrix<double>> cache;
+
+    // The points 2 tau_i / beta - 1 only depend on the number of points of the mesh
+    long n_tau = tau_mesh.size();
+    return cache.get({n_tau, n_l}, [&]() {
+      auto P = matrix<double>(n_tau, n_l);
+      utility::legendre_generator L;
+      for (long i = 0; i < n_tau; ++i) {
+        L.reset(2 * tau_mesh.index_to_point(i) / tau_mesh.domain().beta - 1);
+        for (long l = 0; l < n_l; ++l) P(i, l) = std::sqrt(2 * l + 1) * L.next();
+      }
+      return P;
+    });
+  }
+
+} // namespace triqs::gfs
@@ -23,6 +23,7 @@
 #include "../../gfs.hpp"
 
 #include <cmath>
+#include <memory>
 
 namespace triqs::gfs {
 
@@ -32,19 +33,40 @@ namespace triqs::gfs {
 
   // ----------------------------
 
+  /// The matrix T_{nl} (utility::legendre_T) for the frequencies n of iw_mesh and n_l Legendre coefficients. Computed once and cached.
+  std::shared_ptr<const matrix<dcomplex>> legendre_T_matrix(gf_mesh<imfreq> const &iw_mesh, long n_l);
+
+  /// The matrix sqrt(2l+1) P_l(2 tau_i / beta - 1) of the Legendre basis on the points of tau_mesh. Computed once and cached.
+  std::shared_ptr<const matrix<double>> legendre_P_matrix(gf_mesh<imtime> const &tau_mesh, long n_l);
+
+  // out = alpha * A * in, for a real A and real or complex in. A complex in is done as two real gemm.
+  template <typename S> void _legendre_gemm(double alpha, matrix_const_view<double> A, array_const_view<S, 2> in, array_view<S, 2> out) {
+    if constexpr (std::is_same_v<S, double>)
+      blas::gemm(alpha, A, make_matrix_view(in), 0.0, make_matrix_view(out));
+    else {
+      auto in_re = array<double, 2>(real(in)), in_im = array<double, 2>(imag(in));
+      auto out_re = array<double, 2>(out.shape()), out_im = array<double, 2>(out.shape());
+      blas::gemm(alpha, A, make_matrix_view(in_re), 0.0, make_matrix_view(out_re));
+      blas::gemm(alpha, A, make_matrix_view(in_im), 0.0, make_matrix_view(out_im));
+      for (long i : range(first_dim(out)))
+        for (long j : range(second_dim(out))) out(i, j) = S{out_re(i, j), out_im(i, j)};
+    }
+  }
+
+  // ----------------------------
+
   template <typename G1, typename G2> std::enable_if_t<is_gf_v<G1, imfreq>> legendre_matsubara_direct(G1 &&gw, G2 const &gl) {
 
     static_assert(is_gf_v<G2, legendre>, "Second argument to legendre_matsubara_direct needs to be a Legendre Green function");
     static_assert(std::is_same_v<typename std::decay_t<G1>::target_t, typename std::decay_t<G2>::target_t>,
                   "Arguments to legendre_matsubara_direct require same target_t");
 
-    gw() = 0.0;
-    itertools::range R;
-
-    // Use the transformation matrix
-    for (auto om : gw.mesh()) {
-      for (auto l : gl.mesh()) { gw[om] += triqs::utility::legendre_T(om.index(), l.index()) * gl[l]; }
-    }
+    // gw = T gl, with the data flattened over the target
+    auto T       = legendre_T_matrix(gw.mesh(), gl.mesh().size());
+    auto gl_flat = flatten_2d(make_const_view(gl.data()), 0);
+    auto gw_flat = array<dcomplex, 2>(gw.mesh().size(), second_dim(gl_flat));
+    blas::gemm(1.0, *T, make_matrix_view(gl_flat), 0.0, make_matrix_view(gw_flat));
+    _unflatten_gf_2d<0>(gw_flat(), gw());
   }
 
   // ----------------------------
@@ -55,13 +77,13 @@ namespace triqs::gfs {
     static_assert(std::is_same_v<typename std::decay_t<G1>::target_t, typename std::decay_t<G2>::target_t>,
                   "Arguments to legendre_matsubara_direct require same target_t");
 
-    gt() = 0.0;
-    utility::legendre_generator L;
-
-    for (auto t : gt.mesh()) {
-      L.reset(2 * t / gt.domain().beta - 1);
-      for (auto l : gl.mesh()) { gt[t] += std::sqrt(2 * l.index() + 1) / gt.domain().beta * gl[l] * L.next(); }
-    }
+    // gt = P gl / beta, with the data flattened over the target
+    auto P       = legendre_P_matrix(gt.mesh(), gl.mesh().size());
+    auto gl_flat = flatten_2d(make_const_view(gl.data()), 0);
+    using S      = typename decltype(gl_flat)::value_type;
+    auto gt_flat = array<S, 2>(gt.mesh().size(), second_dim(gl_flat));
+    _legendre_gemm<S>(1 / gt.domain().beta, *P, gl_flat(), gt_flat());
+    _unflatten_gf_2d<0, S>(gt_flat(), gt());
   }
 
   // ----------------------------
@@ -93,21 +115,16 @@ namespace triqs::gfs {
     static_assert(std::is_same_v<typename std::decay_t<G1>::target_t, typename std::decay_t<G2>::target_t>,
                   "Arguments to legendre_matsubara_inverse require same target_t");
 
-    gl() = 0.0;
-    utility::legendre_generator L;
-    auto N = gt.mesh().size() - 1;
-    double coef;
-
-    // Do the integral over imaginary time
-    for (auto t : gt.mesh()) {
-      if (t.index() == 0 || t.index() == N)
-        coef = 0.5;
-      else
-        coef = 1.0;
-      L.reset(2 * t / gt.domain().beta - 1);
-      for (auto l : gl.mesh()) { gl[l] += coef * std::sqrt(2 * l.index() + 1) * L.next() * gt[t]; }
-    }
-    gl.data() *= gt.mesh().delta();
+    // Do the integral over imaginary time (trapezoidal rule) : gl = delta * P^T (w gt)
+    auto P       = legendre_P_matrix(gt.mesh(), gl.mesh().size());
+    auto gt_flat = flatten_2d(make_const_view(gt.data()), 0);
+    using S      = typename decltype(gt_flat)::value_type;
+    auto N       = gt.mesh().size() - 1;
+    gt_flat(0, range()) *= 0.5;
+    gt_flat(N, range()) *= 0.5;
+    auto gl_flat = array<S, 2>(gl.mesh().size(), second_dim(gt_flat));
+    _legendre_gemm<S>(gt.mesh().delta(), P->transpose(), gt_flat(), gl_flat());
+    _unflatten_gf_2d<0, S>(gl_flat(), gl());
   }
 
   // ----------------------------
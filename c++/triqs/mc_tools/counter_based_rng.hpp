@@ -0,0 +1,230 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace triqs {
+  namespace mc_tools {
+    namespace RandomGenerators {
+
+      // Counter-based generators : the n-th block of random words is a bijection of (n, stream_id), keyed by the seed.
+      // Cf J.K. Salmon, M.A. Moraes, R.O. Dror, D.E. Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC11 (Random123).
+      // The bijections are written on L independent lanes (blocks), in plain loops which the compiler vectorizes.
+
+      // Philox4x32 with 10 rounds. Counter : (block, block >> 32, stream, stream >> 32). Key : (seed, 0)
+      struct philox4x32_10 {
+        using word_t                  = uint32_t;
+        static constexpr int n_words  = 4;
+        static constexpr int n_keys   = 2;
+        static constexpr int n_rounds = 10;
+
+        template <int L> static void apply(word_t (&x)[n_words][L], std::array<word_t, n_keys> const &key) {
+          for (int l = 0; l < L; ++l) { // the rounds are unrolled, the loop on the lanes is vectorized
+            word_t x0 = x[0][l], x1 = x[1][l], x2 = x[2][l], x3 = x[3][l], k0 = key[0], k1 = key[1];
+            for (int r = 0; r < n_rounds; ++r) {
+              uint64_t p0 = uint64_t(0xD2511F53) * x0;
+              uint64_t p1 = uint64_t(0xCD9E8D57) * x2;
+              x0          = word_t(p1 >> 32) ^ x1 ^ k0;
+              x2          = word_t(p0 >> 32) ^ x3 ^ k1;
+              x1          = word_t(p1);
+              x3          = word_t(p0);
+              k0 += 0x9E3779B9;
+              k1 += 0xBB67AE85;
+            }
+            x[0][l] = x0;
+            x[1][l] = x1;
+            x[2][l] = x2;
+            x[3][l] = x3;
+          }
+        }
+
+        static void set_counter(word_t (&c)[n_words], uint64_t block, uint64_t stream_id) {
+          c[0] = word_t(block);
+          c[1] = word_t(block >> 32);
+          c[2] = word_t(stream_id);
+          c[3] = word_t(stream_id >> 32);
+        }
+
+        static std::array<word_t, n_keys> make_key(uint32_t seed) { return {seed, 0}; }
+      };
+
+      // Threefry4x64 with 20 rounds. Counter : (block, stream, 0, 0). Key : (seed, 0, 0, 0)
+      struct threefry4x64_20 {
+        using word_t                  = uint64_t;
+        static constexpr int n_words  = 4;
+        static constexpr int n_keys   = 4;
+        static constexpr int n_rounds = 20;
+
+        static constexpr word_t rotl(word_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+        template <int L> static void apply(word_t (&x)[n_words][L], std::array<word_t, n_keys> const &key) {
+          constexpr int R[8][2] = {{14, 16}, {52, 57}, {23, 40}, {5, 37}, {25, 33}, {46, 12}, {58, 22}, {32, 32}};
+          word_t ks[5] = {key[0], key[1], key[2], key[3], 0x1BD11BDAA9FC1A22 ^ key[0] ^ key[1] ^ key[2] ^ key[3]};
+          for (int i = 0; i < 4; ++i)
+            for (int l = 0; l < L; ++l) x[i][l] += ks[i];
+          for (int r = 0; r < n_rounds; ++r) { // the loops on the lanes are vectorized
+            // the pairs are (0,1), (2,3) for the even rounds, (0,3), (2,1) for the odd rounds
+            int a = (r % 2 == 0 ? 1 : 3), b = (r % 2 == 0 ? 3 : 1);
+            for (int l = 0; l < L; ++l) {
+              x[0][l] += x[a][l];
+              x[a][l] = rotl(x[a][l], R[r % 8][0]) ^ x[0][l];
+              x[2][l] += x[b][l];
+              x[b][l] = rotl(x[b][l], R[r % 8][1]) ^ x[2][l];
+            }
+            if (r % 4 == 3) { // key injection
+              int s = r / 4 + 1;
+              for (int i = 0; i < 4; ++i)
+                for (int l = 0; l < L; ++l) x[i][l] += ks[(s + i) % 5];
+              for (int l = 0; l < L; ++l) x[3][l] += s;
+            }
+          }
+        }
+
+        static void set_counter(word_t (&c)[n_words], uint64_t block, uint64_t stream_id) {
+          c[0] = block;
+          c[1] = stream_id;
+          c[2] = c[3] = 0;
+        }
+
+        static std::array<word_t, n_keys> make_key(uint32_t seed) { return {seed, 0, 0, 0}; }
+      };
+
+      /**
+       * A counter-based random engine, for a bijection as philox4x32_10 or threefry4x64_20.
+       *
+       * The generators with the same seed and different stream_id are independent.
+       * The state is (seed, stream_id, position in the stream) : the jump ahead (discard) is O(1), and the state
+       * is written and read by << and >> in a few bytes.
+       *
+       * Models UniformRandomBitGenerator. uniform() returns a double in [0,1[ from 64 random bits,
+       * and fill_uniform gives the same sequence by blocks of L x n_words words, in vectorized loops.
+       */
+      template <typename Bijection> class counter_based_engine {
+        public:
+        using result_type = typename Bijection::word_t;
+
+        private:
+        static constexpr int n_words           = Bijection::n_words;
+        static constexpr int words_per_double  = 64 / std::numeric_limits<result_type>::digits;
+        static constexpr int doubles_per_block = n_words / words_per_double;
+        static constexpr int L                 = 8; // number of blocks computed together in fill_uniform
+
+        uint32_t seed;
+        uint64_t stream_id;
+        uint64_t next = 0; // position in the stream of the next word
+        std::array<result_type, Bijection::n_keys> key;
+        result_type block_words[n_words]; // the block current_block
+        uint64_t current_block = ~uint64_t(0);
+
+        void compute_block(uint64_t b, result_type (&out)[n_words]) const {
+          result_type x[n_words][1], c[n_words];
+          Bijection::set_counter(c, b, stream_id);
+          for (int i = 0; i < n_words; ++i) x[i][0] = c[i];
+          Bijection::template apply<1>(x, key);
+          for (int i = 0; i < n_words; ++i) out[i] = x[i][0];
+        }
+
+        // the 53 high bits of u, or of (hi << 32) | lo, in [0,1[. Both are exact, hence equal.
+        static double to_double(uint64_t u) { return double(u >> 11) * 0x1.0p-53; }
+        static double to_double(uint32_t hi, uint32_t lo) { return double(hi) * 0x1.0p-32 + double(lo >> 11) * 0x1.0p-53; }
+
+        public:
+        counter_based_engine(uint32_t seed_, uint64_t stream_id_ = 0) : seed(seed_), stream_id(stream_id_), key(Bijection::make_key(seed_)) {}
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /// The next random word
+        result_type operator()() {
+          uint64_t b = next / n_words;
+          if (b != current_block) {
+            compute_block(b, block_words);
+            current_block = b;
+          }
+          return block_words[next++ % n_words];
+        }
+
+        /// Skip n words, in O(1)
+        void discard(uint64_t n) { next += n; }
+
+        /// A double in [0,1[, from the next 64 random bits
+        double uniform() {
+          if constexpr (words_per_double == 2) {
+            uint32_t hi = (*this)();
+            return to_double(hi, (*this)());
+          } else
+            return to_double((*this)());
+        }
+
+        /// Fill [first, last) with the next uniform() numbers
+        void fill_uniform(double *first, double *last) {
+          // up to the start of a block, if the position allows to reach it
+          if (next % words_per_double == 0)
+            while (first != last and next % n_words != 0) *first++ = uniform();
+          if (next % n_words == 0) {
+            // local copies : the stores into first can not alias them
+            auto k          = key;
+            uint64_t st     = stream_id, b = next / n_words;
+            constexpr int n = L * doubles_per_block;
+            for (; last - first >= n; first += n, b += L) {
+              result_type x[n_words][L], c[n_words];
+              for (int l = 0; l < L; ++l) {
+                Bijection::set_counter(c, b + l, st);
+                for (int i = 0; i < n_words; ++i) x[i][l] = c[i];
+              }
+              Bijection::template apply<L>(x, k);
+              for (int l = 0; l < L; ++l)
+                for (int d = 0; d < doubles_per_block; ++d) {
+                  if constexpr (words_per_double == 2)
+                    first[l * doubles_per_block + d] = to_double(x[2 * d][l], x[2 * d + 1][l]);
+                  else
+                    first[l * doubles_per_block + d] = to_double(x[d][l]);
+                }
+            }
+            next = b * n_words;
+          }
+          while (first != last) *first++ = uniform();
+        }
+
+        friend bool operator==(counter_based_engine const &x, counter_based_engine const &y) {
+          return x.seed == y.seed and x.stream_id == y.stream_id and x.next == y.next;
+        }
+        friend bool operator!=(counter_based_engine const &x, counter_based_engine const &y) { return !(x == y); }
+
+        friend std::ostream &operator<<(std::ostream &out, counter_based_engine const &e) {
+          return out << e.seed << ' ' << e.stream_id << ' ' << e.next;
+        }
+        friend std::istream &operator>>(std::istream &in, counter_based_engine &e) {
+          uint32_t s;
+          uint64_t st, n;
+          if (in >> s >> st >> n) {
+            e = counter_based_engine(s, st);
+            e.next = n;
+          }
+          return in;
+        }
+      };
+
+      using philox4x32   = counter_based_engine<philox4x32_10>;
+      using threefry4x64 = counter_based_engine<threefry4x64_20>;
+
+    } // namespace RandomGenerators
+  }   // namespace mc_tools
+} // namespace triqs
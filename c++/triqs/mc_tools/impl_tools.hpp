@@ -43,6 +43,10 @@ namespace triqs {
     template <typename T>
     struct has_collect_result<T, decltype(std::declval<T>().collect_results(std::declval<mpi::communicator>()))> : std::true_type {};
 
+    // a measure which can add the accumulated data of another measure of the same type (another walker)
+    template <typename T, typename = void> struct has_merge : std::false_type {};
+    template <typename T> struct has_merge<T, decltype(std::declval<T>().merge(std::declval<T const &>()))> : std::true_type {};
+
     // ----------------- h5 detection -----------------------
     using h5_rw_lambda_t = std::function<void(h5::group, std::string const &)>;
 
@@ -21,6 +21,8 @@
 #pragma once
 #include <triqs/utility/first_include.hpp>
 #include <cmath>
+#include <cstdio>
+#include <optional>
 #include <triqs/utility/timer.hpp>
 #include <triqs/utility/timestamp.hpp>
 #include <triqs/utility/report_stream.hpp>
@@ -30,10 +32,14 @@
 #include "./mc_measure_aux_set.hpp"
 #include "./mc_measure_set.hpp"
 #include "./mc_move_set.hpp"
+#include "./mc_progress.hpp"
 #include "./random_generator.hpp"
 
 namespace triqs::mc_tools {
 
+  template <typename MCSignType> class mc_threaded;
+  template <typename MCSignType> class mc_replica_exchange;
+
   /**
   * \brief Generic Monte Carlo class.
   *
@@ -55,9 +61,10 @@ namespace triqs::mc_tools {
     * @param random_name     Name of the random generator (cf doc).
     * @param random_seed     Seed for the random generator
     * @param verbosity       Verbosity level. 0 : None, ... TBA
+    * @param random_stream   Stream of the random generator, e.g. the rank of the node [optional]
     */
-    mc_generic(std::string random_name, int random_seed, int verbosity)
-       : RandomGenerator(random_name, random_seed), AllMoves(RandomGenerator), AllMeasures(), AllMeasuresAux(), report(&std::cout, verbosity) {}
+    mc_generic(std::string random_name, int random_seed, int verbosity, uint64_t random_stream = 0)
+       : RandomGenerator(random_name, random_seed, random_stream), AllMoves(RandomGenerator), AllMeasures(), AllMeasuresAux(), report(&std::cout, verbosity) {}
 
     /**
    * Register a move
@@ -110,6 +117,120 @@ namespace triqs::mc_tools {
    */
     void set_after_cycle_duty(std::function<void()> f) { after_cycle_duty = f; }
 
+    /**
+     * Open a non-blocking channel to gather statistics over the nodes during the accumulation, cf progress_channel
+     *
+     * All nodes of the communicator must call it, and accumulate.
+     *
+     * @param c                   The communicator
+     * @param period_in_seconds   Minimal time between two reductions
+     */
+    void set_progress_channel(mpi::communicator c, double period_in_seconds) { progress = std::make_unique<progress_channel>(c, period_in_seconds); }
+
+    /**
+     * Add a quantity to the statistics of the progress channel
+     *
+     * @param name   Name of the quantity
+     * @param f      () -> double. The current estimate of the quantity on this node, called on each reduction
+     */
+    void add_progress_summary(std::string name, std::function<double()> f) { check_progress().add_summary(std::move(name), std::move(f)); }
+
+    /**
+     * Stop the accumulation on all nodes, when the statistics gathered by the progress channel
+     * meet the criterion. It is evaluated on node 0, after each reduction.
+     */
+    void stop_when(std::function<bool(progress_info const &)> criterion) { check_progress().set_stop_criterion(std::move(criterion)); }
+
+    /**
+     * Stop the accumulation on all nodes, when the errors over the nodes of all the progress summaries
+     * (or of the average sign if there is no summary) are below precision. Needs at least 2 nodes.
+     */
+    void stop_when(double precision) {
+      stop_when([precision](progress_info const &info) {
+        if (info.summaries.empty()) return info.average_sign_error < precision;
+        for (auto const &[name, x] : info.summaries)
+          if (!(x.second < precision)) return false;
+        return true;
+      });
+    }
+
+    /// The statistics over the nodes of the last reduction of the progress channel
+    progress_info const &get_progress() const {
+      if (!progress) TRIQS_RUNTIME_ERROR << "mc_generic : no progress channel. Call set_progress_channel first";
+      return progress->get_info();
+    }
+
+    /**
+     * Write a checkpoint of the run, from which it can be continued by resume
+     *
+     * The checkpoint is written at the end of a cycle, every period_in_seconds, and when the run is stopped
+     * by stop_callback or by a signal (e.g. SIGTERM). It contains the moves and the measures (those which have
+     * h5_write/h5_read), the move statistics, the sign, the state of the random generator, the timers
+     * and the position in the run. The file is written under a temporary name, then renamed.
+     * With several nodes, each node needs its own file.
+     *
+     * NB : the signals are then checked at the end of each cycle only.
+     *
+     * @param filename              Name of the hdf5 file
+     * @param period_in_seconds     Time between two checkpoints
+     * @param write_configuration   Writes the Monte Carlo configuration in the group [optional]
+     * @param read_configuration    Reads the Monte Carlo configuration from the group, in resume [optional]
+     */
+    void set_checkpoint(std::string filename, double period_in_seconds, std::function<void(h5::group)> write_configuration = {},
+                        std::function<void(h5::group)> read_configuration = {}) {
+      checkpoint = checkpoint_t{std::move(filename), period_in_seconds, std::move(write_configuration), std::move(read_configuration), {}};
+    }
+
+    /**
+     * Continue a run from the checkpoint written by a previous run, cf set_checkpoint
+     *
+     * The moves and the measures must be registered as in the previous run, and the random generator must have the same name.
+     * The run continues exactly as the previous run would have : the end of the warmup if the checkpoint was
+     * written during the warmup, then the accumulation.
+     * Call set_checkpoint before, to read the configuration and to go on writing checkpoints.
+     *
+     * @param filename                Name of the hdf5 file of the checkpoint
+     * @param n_warmup_cycles         Number of QMC cycles in the warmup, as in the previous run
+     * @param n_accumulation_cycles   Number of QMC cycles in the accumulation, as in the previous run
+     * @param length_cycle            Number of QMC move attempts in one cycle
+     * @param stop_callback           A callback function () -> bool, cf accumulate
+     *
+     * @return cf warmup_and_accumulate
+     */
+    int resume(std::string const &filename, uint64_t n_warmup_cycles, uint64_t n_accumulation_cycles, uint64_t length_cycle,
+               std::function<bool()> stop_callback) {
+      std::string phase, rng_state;
+      uint64_t run_cycles_done = 0;
+      double run_time = 0, warmup_time = 0;
+      {
+        h5::file file(filename, 'r');
+        h5::group top(file);
+        h5_read(top, "mc", *this);
+        auto gr = top.open_group("checkpoint");
+        h5_read(gr, "phase", phase);
+        h5_read(gr, "run_cycles_done", run_cycles_done);
+        h5_read(gr, "run_time", run_time);
+        h5_read(gr, "warmup_time", warmup_time);
+        h5_read(gr, "rng_state", rng_state);
+        h5_read(gr, "config_id", config_id);
+        h5_read(gr, "sum_sign", sum_sign);
+        AllMoves.h5_read_statistics(gr.open_group("move_statistics"));
+        if (checkpoint and checkpoint->read_configuration) checkpoint->read_configuration(top.open_group("configuration"));
+      }
+      RandomGenerator.set_state(rng_state);
+      if (phase == "warmup") {
+        report << "\nWarming up (resumed at cycle " << run_cycles_done << ") ..." << std::endl;
+        int status = run(n_warmup_cycles, length_cycle, stop_callback, false, run_cycles_done, run_time);
+        if (status == 0) status = accumulate(n_accumulation_cycles, length_cycle, stop_callback);
+        return status;
+      }
+      if (phase != "accumulation") TRIQS_RUNTIME_ERROR << "mc_generic : " << filename << " is not a checkpoint";
+      timer_warmup = {};
+      timer_warmup.add(warmup_time);
+      report << "\nAccumulating (resumed at cycle " << run_cycles_done << ") ..." << std::endl;
+      return run(n_accumulation_cycles, length_cycle, stop_callback, true, run_cycles_done, run_time);
+    }
+
     int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
       report << "\nWarming up ..." << std::endl;
       return run(n_warmup_cycles, length_cycle, stop_callback, false);
@@ -152,6 +273,7 @@ namespace triqs::mc_tools {
      *    0  if the computation has run until the end
      *    1  if it has been stopped by stop_callback
      *    2  if it has been stopped by receiving a signal
+     *    3  if it has been stopped by the criterion of the progress channel (cf stop_when)
      *    =  =============================================
      *
      */
@@ -182,6 +304,7 @@ namespace triqs::mc_tools {
      *    0  if the computation has run until the end
      *    1  if it has been stopped by stop_callback
      *    2  if it has been stopped by receiving a signal
+     *    3  if it has been stopped by the criterion of the progress channel (cf stop_when)
      *    =  =============================================
      *
      */
@@ -194,20 +317,47 @@ namespace triqs::mc_tools {
     private:
     // implementation
 
-    int run(uint64_t n_cycles, uint64_t length_cycle, std::function<bool()> stop_callback, bool do_measure = true) {
+    progress_channel &check_progress() {
+      if (!progress) TRIQS_RUNTIME_ERROR << "mc_generic : no progress channel. Call set_progress_channel first";
+      return *progress;
+    }
+
+    // NC_start, previous_time : the cycles done and the time spent before the checkpoint, when resuming a run
+    int run(uint64_t n_cycles, uint64_t length_cycle, std::function<bool()> stop_callback, bool do_measure = true, uint64_t NC_start = 0,
+            double previous_time = 0) {
       utility::timer timer;
+      timer.add(previous_time);
       timer.start();
-      if (n_cycles == 0) return 0;
-      triqs::signal_handler::start();
+      bool use_progress = (do_measure and progress);
+      if (NC_start >= n_cycles) {
+        // nothing to do here (e.g. resumed after the end of the run on this node), but the reductions of the progress channel
+        // are collective : take part in them until all the other nodes are done
+        if (use_progress) {
+          progress->start_run();
+          bool resumed = (NC_start > 0);
+          progress->finish_run((resumed ? nmeasures : 0), (resumed ? std::real(sum_sign) : 0));
+        }
+        return 0;
+      }
+      if (manage_signal_handler) triqs::signal_handler::start();
       done_percent = 0;
-      nmeasures    = 0;
-      bool stop_it = false, finished = false;
-      int NC                = 0;
+      if (NC_start == 0) {
+        nmeasures = 0;
+        sum_sign  = 0;
+      }
+      bool stop_it = false, finished = false, precision_reached = false;
+      if (use_progress) progress->start_run();
+      if (checkpoint) {
+        checkpoint->since_last = {};
+        checkpoint->since_last.start();
+      }
+      uint64_t NC           = NC_start;
       double next_info_time = 0.1;
       for (; !stop_it; ++NC) { // do NOT reinit NC to 0
         // Metropolis loop. Switch here for HeatBath, etc...
         for (uint64_t k = 1; (k <= length_cycle); k++) {
-          if (triqs::signal_handler::received()) goto _final;
+          // with a checkpoint, stop at the end of the cycle only
+          if (!checkpoint and triqs::signal_handler::received()) goto _final;
           double r = AllMoves.attempt();
           if (RandomGenerator() < std::min(1.0, r)) {
             if (debug) std::cerr << " Move accepted " << std::endl;
@@ -222,11 +372,14 @@ namespace triqs::mc_tools {
         if (after_cycle_duty) { after_cycle_duty(); }
         if (do_measure) {
           nmeasures++;
+          sum_sign += sign;
           for (auto &x : AllMeasuresAux) x();
           AllMeasures.accumulate(sign);
+          if (use_progress) precision_reached = progress->poll(nmeasures, std::real(sum_sign));
         }
       // recompute fraction done
       _final:
+        ++current_cycle_number;
         done_percent = uint64_t(floor(((NC + 1) * 100.0) / n_cycles));
         if (timer > next_info_time) {
           report << utility::timestamp() << " " << std::setfill(' ') << std::setw(3) << done_percent << "%"
@@ -234,12 +387,15 @@ namespace triqs::mc_tools {
                  << std::flush;
           next_info_time = 1.25 * timer + 2.0; // Increase time interval non-linearly
         }
-        finished = NC + 1 >= n_cycles;
-        stop_it  = (stop_callback() || triqs::signal_handler::received() || finished);
+        finished     = NC + 1 >= n_cycles;
+        bool stopped = (stop_callback() || triqs::signal_handler::received());
+        stop_it      = (stopped || finished || precision_reached);
+        if (checkpoint and !finished and !precision_reached and (stopped or checkpoint->since_last > checkpoint->period))
+          write_checkpoint(NC + 1, timer, do_measure);
       }
-      int status = (finished ? 0 : (triqs::signal_handler::received() ? 2 : 1));
-      triqs::signal_handler::stop();
-      current_cycle_number += NC;
+      if (use_progress) progress->finish_run(nmeasures, std::real(sum_sign));
+      int status = (finished ? 0 : (triqs::signal_handler::received() ? 2 : (precision_reached ? 3 : 1)));
+      if (manage_signal_handler) triqs::signal_handler::stop();
       timer.stop();
       if (do_measure) {
         timer_accumulation = timer;
@@ -250,12 +406,49 @@ namespace triqs::mc_tools {
       // final reporting
       if (status == 1) report << "mc_generic stops because of stop_callback";
       if (status == 2) report << "mc_generic stops because of a signal";
+      if (status == 3) report << "mc_generic stops because the stop criterion of the progress channel is met";
       report << "\n" << std::endl;
 
       return status;
     }
 
+    void write_checkpoint(uint64_t run_cycles_done, double run_time, bool accumulation) {
+      std::string tmp = checkpoint->filename + ".tmp";
+      {
+        h5::file file(tmp, 'w');
+        h5::group top(file);
+        h5_write(top, "mc", *this);
+        auto gr = top.create_group("checkpoint");
+        h5_write(gr, "phase", std::string(accumulation ? "accumulation" : "warmup"));
+        h5_write(gr, "run_cycles_done", run_cycles_done);
+        h5_write(gr, "run_time", run_time);
+        h5_write(gr, "warmup_time", double(timer_warmup));
+        h5_write(gr, "rng_state", RandomGenerator.get_state());
+        h5_write(gr, "config_id", config_id);
+        h5_write(gr, "sum_sign", sum_sign);
+        AllMoves.h5_write_statistics(gr.create_group("move_statistics"));
+        if (checkpoint->write_configuration) checkpoint->write_configuration(top.create_group("configuration"));
+      }
+      if (std::rename(tmp.c_str(), checkpoint->filename.c_str()) != 0)
+        TRIQS_RUNTIME_ERROR << "mc_generic : can not rename " << tmp << " into " << checkpoint->filename;
+      report(3) << "Checkpoint written in " << checkpoint->filename << " at cycle " << run_cycles_done << std::endl;
+      checkpoint->since_last = {};
+      checkpoint->since_last.start();
+    }
+
     public:
+    /**
+     * Add the measures and the move statistics of another walker on the same node
+     *
+     * The walker w must have the same moves and measures, and the measures must have a merge method.
+     * Used by mc_threaded to reduce its walkers before collect_results.
+     */
+    void merge(mc_generic const &w) {
+      AllMeasures.merge(w.AllMeasures);
+      AllMoves.merge_statistics(w.AllMoves);
+      nmeasures += w.nmeasures;
+    }
+
     /// Reduce the results of the measures, and reports some statistics
     void collect_results(mpi::communicator const &c) {
       report(3) << "[Rank " << c.rank() << "] Collect results: Waiting for all mpi-threads to finish accumulating...\n";
@@ -358,8 +551,20 @@ namespace triqs::mc_tools {
     uint64_t nmeasures, current_cycle_number = 0;
     utility::timer timer_accumulation, timer_warmup;
     std::function<void()> after_cycle_duty;
-    MCSignType sign       = 1;
-    uint64_t done_percent = 0;
-    uint64_t config_id    = 0;
+    MCSignType sign            = 1;
+    MCSignType sum_sign        = 0;
+    uint64_t done_percent      = 0;
+    uint64_t config_id         = 0;
+    std::unique_ptr<progress_channel> progress;
+    struct checkpoint_t {
+      std::string filename;
+      double period;
+      std::function<void(h5::group)> write_configuration, read_configuration;
+      utility::timer since_last;
+    };
+    std::optional<checkpoint_t> checkpoint;
+    bool manage_signal_handler = true; // false for the walkers of mc_threaded or mc_replica_exchange, which start and stop it
+    friend class mc_threaded<MCSignType>;
+    friend class mc_replica_exchange<MCSignType>;
   };
 } // namespace triqs::mc_tools
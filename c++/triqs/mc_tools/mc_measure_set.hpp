@@ -25,6 +25,7 @@
 #include <functional>
 #include <map>
 #include <cassert>
+#include <typeinfo>
 #include "./impl_tools.hpp"
 
 namespace triqs {
@@ -36,6 +37,8 @@ namespace triqs {
       std::shared_ptr<void> impl_;
       std::function<void(MCSignType const &)> accumulate_;
       std::function<void(mpi::communicator const &)> collect_results_;
+      std::function<void(measure const &)> merge_;
+      std::type_info const *type_;
       std::function<void(h5::group, std::string const &)> h5_r, h5_w;
 
       uint64_t count_;
@@ -53,6 +56,8 @@ namespace triqs {
         accumulate_      = [p](MCSignType const &x) { p->accumulate(x); };
         count_           = 0;
         collect_results_ = [p](mpi::communicator const &c) { p->collect_results(c); };
+        type_            = &typeid(m_t);
+        if constexpr (has_merge<m_t>::value) merge_ = [p](measure const &x) { p->merge(*static_cast<m_t const *>(x.impl_.get())); };
         h5_r             = make_h5_read(p);
         h5_w             = make_h5_write(p);
       }
@@ -76,6 +81,14 @@ namespace triqs {
         if(enable_timer) Timer.stop();
       }
 
+      /// Add the data accumulated by x, the same measure in another walker. Requires a merge method in the measure.
+      void merge(measure const &x, std::string const &name) {
+        if (!merge_) TRIQS_RUNTIME_ERROR << "measure '" << name << "' has no merge method : it can not be reduced over several walkers";
+        if (*type_ != *x.type_) TRIQS_RUNTIME_ERROR << "measure '" << name << "' : can not merge measures of different types";
+        merge_(x);
+        count_ += x.count_;
+      }
+
       uint64_t count() const { return count_; }
       double duration() const { return double(Timer); }
 
@@ -153,6 +166,12 @@ namespace triqs {
         return s.str();
       }
 
+      /// Add the data accumulated by the measures of another walker, with the same measure names
+      void merge(measure_set const &ms) {
+        if (names() != ms.names()) TRIQS_RUNTIME_ERROR << "measure_set : merge : the two sets have different measures";
+        for (auto &nmp : m_map) nmp.second.merge(ms.m_map.at(nmp.first), nmp.first);
+      }
+
       // gather result for all measure, on communicator c
       void collect_results(mpi::communicator const &c) {
         for (auto &nmp : m_map) nmp.second.collect_results(c);
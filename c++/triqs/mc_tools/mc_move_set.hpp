@@ -97,6 +97,29 @@ namespace triqs {
       uint64_t n_proposed_config() const { return NProposed; }
       uint64_t n_accepted_config() const { return Naccepted; }
 
+      /// Add the counts of proposed and accepted configurations of the same move of another walker
+      void merge_statistics(move const &m) {
+        auto ms = as_move_set(), ms_other = m.as_move_set();
+        if (bool(ms) != bool(ms_other)) TRIQS_RUNTIME_ERROR << "move : merge_statistics : only one of the two moves is a move_set";
+        NProposed += m.NProposed;
+        Naccepted += m.Naccepted;
+        if (ms) ms->merge_statistics(*ms_other);
+      }
+
+      /// Write/read the counts of proposed and accepted configurations (for a checkpoint)
+      void h5_write_statistics(h5::group g) const {
+        h5_write(g, "n_proposed", NProposed);
+        h5_write(g, "n_accepted", Naccepted);
+        auto ms = as_move_set();
+        if (ms) ms->h5_write_statistics(g.create_group("moves"));
+      }
+      void h5_read_statistics(h5::group g) {
+        h5_read(g, "n_proposed", NProposed);
+        h5_read(g, "n_accepted", Naccepted);
+        auto ms = as_move_set();
+        if (ms) ms->h5_read_statistics(g.open_group("moves"));
+      }
+
       void collect_statistics(mpi::communicator const &c) {
         uint64_t nacc_tot  = mpi::all_reduce(Naccepted, c);
         uint64_t nprop_tot = mpi::all_reduce(NProposed, c);
@@ -236,6 +259,24 @@ namespace triqs {
         current->reject();
       }
 
+      /// Add the move statistics of another walker with the same moves, registered in the same order
+      void merge_statistics(move_set const &ms) {
+        if (ms.move_vec.size() != move_vec.size()) TRIQS_RUNTIME_ERROR << "move_set : merge_statistics : the two move sets have different moves";
+        for (size_t u = 0; u < move_vec.size(); ++u) {
+          if (ms.names_[u] != names_[u])
+            TRIQS_RUNTIME_ERROR << "move_set : merge_statistics : move '" << ms.names_[u] << "' instead of '" << names_[u] << "'";
+          move_vec[u].merge_statistics(ms.move_vec[u]);
+        }
+      }
+
+      /// Write/read the counts of proposed and accepted configurations of all moves (for a checkpoint)
+      void h5_write_statistics(h5::group g) const {
+        for (size_t u = 0; u < move_vec.size(); ++u) move_vec[u].h5_write_statistics(g.create_group(names_[u]));
+      }
+      void h5_read_statistics(h5::group g) {
+        for (size_t u = 0; u < move_vec.size(); ++u) move_vec[u].h5_read_statistics(g.open_group(names_[u]));
+      }
+
       ///
       void collect_statistics(mpi::communicator c) {
         for (auto &m : move_vec) m.collect_statistics(c);
@@ -0,0 +1,192 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include <triqs/utility/first_include.hpp>
+#include <triqs/utility/exceptions.hpp>
+#include <mpi/mpi.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace triqs::mc_tools {
+
+  /// Statistics over the nodes, gathered during the accumulation by the progress_channel
+  struct progress_info {
+
+    /// Number of completed reductions
+    long n_rounds = 0;
+
+    /// Total number of measures on all nodes
+    uint64_t n_measures = 0;
+
+    /// Number of nodes which have done at least one measure
+    int n_nodes = 0;
+
+    /// Average over the nodes of the (real part of the) average sign of each node, and its error
+    double average_sign = 0, average_sign_error = std::numeric_limits<double>::infinity();
+
+    /// name -> (average, error) over the nodes, of the values returned by the summary functions
+    std::map<std::string, std::pair<double, double>> summaries;
+  };
+
+  /**
+   * A non-blocking reduction of statistics over the nodes, during the accumulation of mc_generic.
+   *
+   * Every `period` seconds, each node starts an MPI_Iallreduce of its number of measures, its average sign
+   * and the values of the summary functions, on a duplicate of the communicator, and tests it after each cycle.
+   * The Markov chain never waits for the other nodes, except at the end of the run.
+   * The nodes are independent Markov chains, hence the error of a quantity is estimated from its dispersion over the nodes.
+   *
+   * A stop criterion, evaluated on node 0 after each reduction, can stop all the nodes (at the next reduction).
+   */
+  class progress_channel {
+
+    MPI_Comm comm;
+    int rank = 0, size = 1;
+    std::chrono::duration<double> period;
+    std::chrono::steady_clock::time_point last_start;
+    std::vector<std::pair<std::string, std::function<double()>>> summary_functions;
+    std::function<bool(progress_info const &)> criterion;
+    std::vector<double> send_buf, recv_buf;
+    MPI_Request request = MPI_REQUEST_NULL;
+    bool stop_requested = false, stop = false, all_done = false;
+    progress_info info;
+
+    // Layout of the buffer : done, stop, n_measures, has_measures, sign, sign^2, then value, value^2 for each summary
+    static constexpr int n_head = 6;
+
+    public:
+    /**
+     * @param c                   The communicator of the Monte Carlo nodes
+     * @param period_in_seconds   Minimal time between two reductions
+     */
+    progress_channel(mpi::communicator c, double period_in_seconds) : period(period_in_seconds) {
+      MPI_Comm_dup(c.get(), &comm);
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &size);
+    }
+
+    progress_channel(progress_channel const &) = delete;
+    progress_channel &operator=(progress_channel const &) = delete;
+
+    ~progress_channel() {
+      // finish_run has completed all the requests, unless an exception was thrown during the run
+      if (request != MPI_REQUEST_NULL) MPI_Request_free(&request);
+      MPI_Comm_free(&comm);
+    }
+
+    /// Add a summary : f returns the current estimate of a quantity on this node
+    void add_summary(std::string name, std::function<double()> f) {
+      if (request != MPI_REQUEST_NULL) TRIQS_RUNTIME_ERROR << "progress_channel : can not add a summary during a run";
+      summary_functions.emplace_back(std::move(name), std::move(f));
+    }
+
+    /// Set the stop criterion, evaluated on node 0 on the result of each reduction
+    void set_stop_criterion(std::function<bool(progress_info const &)> f) { criterion = std::move(f); }
+
+    /// The result of the last completed reduction
+    progress_info const &get_info() const { return info; }
+
+    /// To be called at the start of the accumulation
+    void start_run() {
+      stop = stop_requested = all_done = false;
+      info                             = progress_info{};
+      last_start                       = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * To be called after each measure. Never blocks.
+     *
+     * @return true iif node 0 has requested to stop
+     */
+    bool poll(uint64_t n_measures, double sum_sign) {
+      if (request != MPI_REQUEST_NULL) {
+        int flag = 0;
+        MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
+        if (!flag) return stop;
+        unpack();
+      }
+      if (!stop and std::chrono::steady_clock::now() - last_start >= period) start_round(false, n_measures, sum_sign);
+      return stop;
+    }
+
+    /**
+     * To be called at the end of the accumulation, on all nodes.
+     *
+     * Waits for the other nodes : the reductions go on, until all nodes have finished.
+     */
+    void finish_run(uint64_t n_measures, double sum_sign) {
+      while (true) {
+        if (request != MPI_REQUEST_NULL) {
+          MPI_Wait(&request, MPI_STATUS_IGNORE);
+          unpack();
+          if (all_done) break;
+        }
+        start_round(true, n_measures, sum_sign);
+      }
+    }
+
+    private:
+    void start_round(bool done, uint64_t n_measures, double sum_sign) {
+      size_t n = n_head + 2 * summary_functions.size();
+      send_buf.assign(n, 0);
+      recv_buf.assign(n, 0);
+      bool has    = (n_measures > 0);
+      double s    = (has ? sum_sign / n_measures : 0);
+      send_buf[0] = done;
+      send_buf[1] = (rank == 0 and stop_requested);
+      send_buf[2] = n_measures;
+      send_buf[3] = has;
+      send_buf[4] = s;
+      send_buf[5] = s * s;
+      for (size_t u = 0; u < summary_functions.size(); ++u) {
+        double v                     = (has ? summary_functions[u].second() : 0);
+        send_buf[n_head + 2 * u]     = v;
+        send_buf[n_head + 2 * u + 1] = v * v;
+      }
+      MPI_Iallreduce(send_buf.data(), recv_buf.data(), n, MPI_DOUBLE, MPI_SUM, comm, &request);
+      last_start = std::chrono::steady_clock::now();
+    }
+
+    // mean and error of the mean, from the sum and the sum of the squares over n nodes
+    static std::pair<double, double> mean_error(double sum, double sum2, int n) {
+      if (n == 0) return {0, std::numeric_limits<double>::infinity()};
+      double m = sum / n;
+      if (n == 1) return {m, std::numeric_limits<double>::infinity()};
+      double var = std::max(0.0, (sum2 - n * m * m) / (n - 1));
+      return {m, std::sqrt(var / n)};
+    }
+
+    void unpack() {
+      all_done        = (recv_buf[0] == size);
+      stop            = stop or (recv_buf[1] > 0);
+      info.n_rounds++;
+      info.n_measures = uint64_t(recv_buf[2]);
+      info.n_nodes    = int(recv_buf[3]);
+      std::tie(info.average_sign, info.average_sign_error) = mean_error(recv_buf[4], recv_buf[5], info.n_nodes);
+      for (size_t u = 0; u < summary_functions.size(); ++u)
+        info.summaries[summary_functions[u].first] = mean_error(recv_buf[n_head + 2 * u], recv_buf[n_head + 2 * u + 1], info.n_nodes);
+      if (rank == 0 and criterion and !stop_requested) stop_requested = criterion(info);
+    }
+  };
+
+} // namespace triqs::mc_tools
@@ -0,0 +1,284 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include <triqs/utility/first_include.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "./mc_generic.hpp"
+
+namespace triqs::mc_tools {
+
+  /**
+  * \brief Parallel tempering (replica exchange) over K replicas of a Monte Carlo calculation.
+  *
+  * Each replica is a mc_generic, for one value of the parameter (temperature, coupling ...),
+  * with its own random generator, moves and measures, registered on replica(k).
+  * The replicas run in parallel threads. Every n_cycles_between_swaps cycles, all replicas wait for each other,
+  * and the swap of the configurations of the neighbouring replicas (k, k+1) is proposed,
+  * for the even k and the odd k alternately. It is accepted with the Metropolis probability min(1, |r|), with
+  *
+  *   r = swap_ratio(k, k+1) = W_k(C_{k+1}) W_{k+1}(C_k) / (W_k(C_k) W_{k+1}(C_{k+1}))
+  *
+  * where C_k is the configuration of replica k and W_k its weight, and then swap(k, k+1) exchanges the configurations.
+  * The signs of the two replicas are exchanged with the configurations : the sign of a weight must depend on the configuration only.
+  *
+  * The swaps are done during the warmup and the accumulation.
+  * The measures of each replica are collected independently.
+  */
+  template <typename MCSignType> class mc_replica_exchange {
+
+    std::vector<std::unique_ptr<mc_generic<MCSignType>>> replicas;
+    random_generator RNG;
+    std::function<MCSignType(int, int)> swap_ratio;
+    std::function<void(int, int)> swap;
+    uint64_t n_cycles_between_swaps = 1, n_swap_rounds = 0;
+    std::vector<uint64_t> n_swap_proposed, n_swap_accepted;
+    std::vector<double> swap_acceptance_rates;
+
+    // Synchronisation of the replicas before the swaps
+    std::mutex mtx;
+    std::condition_variable cv;
+    int n_active = 0, n_waiting = 0;
+    uint64_t generation = 0;
+    std::atomic<bool> stop = false;
+
+    public:
+    /**
+    * Constructor
+    *
+    * @param n_replicas      Number of replicas K, each run in its own thread.
+    * @param random_name     Name of the random generator (cf doc).
+    * @param random_seed     Seed for the random generator of replica 0. The other replicas and the swaps use the next streams of the generator.
+    * @param verbosity       Verbosity level of replica 0. The other replicas are silent.
+    */
+    mc_replica_exchange(int n_replicas, std::string random_name, int random_seed, int verbosity)
+       : RNG(random_name, random_seed, n_replicas) {
+      if (n_replicas < 1) TRIQS_RUNTIME_ERROR << "mc_replica_exchange : the number of replicas must be positive, got " << n_replicas;
+      for (int k = 0; k < n_replicas; ++k) {
+        replicas.push_back(std::make_unique<mc_generic<MCSignType>>(random_name, random_seed, (k == 0 ? verbosity : 0), k));
+        replicas.back()->manage_signal_handler = false;
+      }
+      n_swap_proposed.resize(n_replicas - 1, 0);
+      n_swap_accepted.resize(n_replicas - 1, 0);
+      swap_acceptance_rates.resize(n_replicas - 1, -1);
+    }
+
+    /// Number of replicas
+    int n_replicas() const { return replicas.size(); }
+
+    /// The k-th replica, to register its moves and measures
+    mc_generic<MCSignType> &replica(int k) { return *replicas.at(k); }
+
+    /**
+     * Set the swap of the configurations
+     *
+     * @param swap_ratio_             (k, l) -> r, the ratio of the weights after and before the exchange of the configurations of replicas k and l
+     * @param swap_                   (k, l) -> void, exchanges the configurations of replicas k and l
+     * @param n_cycles_between_swaps_ Number of cycles between two rounds of swaps
+     */
+    void set_swap(std::function<MCSignType(int, int)> swap_ratio_, std::function<void(int, int)> swap_, uint64_t n_cycles_between_swaps_ = 1) {
+      if (n_cycles_between_swaps_ == 0) TRIQS_RUNTIME_ERROR << "mc_replica_exchange : n_cycles_between_swaps must be positive";
+      swap_ratio             = std::move(swap_ratio_);
+      swap                   = std::move(swap_);
+      n_cycles_between_swaps = n_cycles_between_swaps_;
+    }
+
+    /// Warmup all replicas, with swaps. Cf mc_generic
+    int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop_cb) { return w.warmup(n_warmup_cycles, length_cycle, stop_cb); }, stop_callback);
+    }
+
+    /// Accumulate/Measure on all replicas, with swaps. Cf mc_generic
+    int accumulate(uint64_t n_accumulation_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop_cb) { return w.accumulate(n_accumulation_cycles, length_cycle, stop_cb); }, stop_callback);
+    }
+
+    /**
+     * Warmup and accumulate all replicas, in parallel, with swaps.
+     *
+     * stop_callback is called by the replicas in turn. When it returns true, or a signal is received, all the replicas stop.
+     *
+     * @return the largest status of the replicas (cf mc_generic)
+     */
+    int warmup_and_accumulate(uint64_t n_warmup_cycles, uint64_t n_accumulation_cycles, uint64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop_cb) { return w.warmup_and_accumulate(n_warmup_cycles, n_accumulation_cycles, length_cycle, stop_cb); },
+                     stop_callback);
+    }
+
+    /// Reduce the results of the measures of each replica, and the swap statistics
+    void collect_results(mpi::communicator const &c) {
+      for (auto &r : replicas) r->collect_results(c);
+      for (size_t k = 0; k < n_swap_proposed.size(); ++k) {
+        uint64_t nacc_tot        = mpi::all_reduce(n_swap_accepted[k], c);
+        uint64_t nprop_tot       = mpi::all_reduce(n_swap_proposed[k], c);
+        swap_acceptance_rates[k] = nacc_tot / static_cast<double>(nprop_tot);
+      }
+      replicas[0]->report(3) << "[Rank " << c.rank() << "] Acceptance rate for the swaps:\n" << get_swap_statistics();
+    }
+
+    /// The acceptance rates of all moves of replica k. Cf mc_generic
+    std::map<std::string, double> get_acceptance_rates(int k) const { return replicas.at(k)->get_acceptance_rates(); }
+
+    /**
+     * The acceptance rates of the swaps, after collect_results (-1 before)
+     *
+     * @return map : "swap k <-> k+1" -> acceptance rate of the swap of replicas k and k+1
+     */
+    std::map<std::string, double> get_swap_acceptance_rates() const {
+      std::map<std::string, double> r;
+      for (size_t k = 0; k < swap_acceptance_rates.size(); ++k) r.insert({swap_name(k), swap_acceptance_rates[k]});
+      return r;
+    }
+
+    /// Pretty printing of the acceptance rates of the swaps
+    std::string get_swap_statistics() const {
+      std::ostringstream s;
+      for (size_t k = 0; k < swap_acceptance_rates.size(); ++k) s << "Swap " << k << " <-> " << k + 1 << ": " << swap_acceptance_rates[k] << "\n";
+      return s.str();
+    }
+
+    /// Number of rounds of swaps done
+    uint64_t get_n_swap_rounds() const { return n_swap_rounds; }
+
+    /// HDF5 interface
+    friend void h5_write(h5::group g, std::string const &name, mc_replica_exchange const &mc) {
+      auto gr = g.create_group(name);
+      for (size_t k = 0; k < mc.replicas.size(); ++k) h5_write(gr, "replica_" + std::to_string(k), *mc.replicas[k]);
+      h5_write(gr, "n_swap_rounds", long(mc.n_swap_rounds));
+      h5_write(gr, "n_swap_proposed", std::vector<long>(mc.n_swap_proposed.begin(), mc.n_swap_proposed.end()));
+      h5_write(gr, "n_swap_accepted", std::vector<long>(mc.n_swap_accepted.begin(), mc.n_swap_accepted.end()));
+    }
+
+    /// HDF5 interface
+    friend void h5_read(h5::group g, std::string const &name, mc_replica_exchange &mc) {
+      auto gr = g.open_group(name);
+      for (size_t k = 0; k < mc.replicas.size(); ++k) h5_read(gr, "replica_" + std::to_string(k), *mc.replicas[k]);
+      long n_rounds = 0;
+      std::vector<long> n_prop, n_acc;
+      h5_read(gr, "n_swap_rounds", n_rounds);
+      h5_read(gr, "n_swap_proposed", n_prop);
+      h5_read(gr, "n_swap_accepted", n_acc);
+      if (n_prop.size() != mc.n_swap_proposed.size() or n_acc.size() != mc.n_swap_accepted.size())
+        TRIQS_RUNTIME_ERROR << "mc_replica_exchange : h5_read : the number of replicas differs";
+      mc.n_swap_rounds = n_rounds;
+      std::copy(n_prop.begin(), n_prop.end(), mc.n_swap_proposed.begin());
+      std::copy(n_acc.begin(), n_acc.end(), mc.n_swap_accepted.begin());
+    }
+
+    private:
+    static std::string swap_name(size_t k) { return "swap " + std::to_string(k) + " <-> " + std::to_string(k + 1); }
+
+    // One round of swaps, on the pairs (k, k+1) with k of the parity of the round. All replicas are waiting.
+    void do_swaps() {
+      for (size_t k = n_swap_rounds % 2; k + 1 < replicas.size(); k += 2) {
+        ++n_swap_proposed[k];
+        MCSignType r = swap_ratio(k, k + 1);
+        if (!std::isfinite(std::abs(r))) TRIQS_RUNTIME_ERROR << "mc_replica_exchange : the swap ratio (" << r << ") is not finite for " << swap_name(k);
+        if (RNG() < std::min(1.0, double(std::abs(r)))) {
+          ++n_swap_accepted[k];
+          swap(k, k + 1);
+          std::swap(replicas[k]->sign, replicas[k + 1]->sign);
+        }
+      }
+      ++n_swap_rounds;
+    }
+
+    // Called by each replica every n_cycles_between_swaps cycles. The last one to arrive does the swaps.
+    void arrive() {
+      std::unique_lock<std::mutex> lock(mtx);
+      uint64_t gen = generation;
+      if (++n_waiting == n_active) {
+        if (!stop and n_active == int(replicas.size())) {
+          try {
+            do_swaps();
+          } catch (...) {
+            stop = true;
+            release();
+            throw;
+          }
+        }
+        release();
+      } else
+        cv.wait(lock, [&]() { return generation != gen; });
+    }
+
+    // A replica has stopped : it does not wait any more, and no swap is done
+    void leave() {
+      std::lock_guard<std::mutex> lock(mtx);
+      --n_active;
+      if (n_waiting > 0 and n_waiting == n_active) release();
+    }
+
+    void release() { // with mtx locked
+      n_waiting = 0;
+      ++generation;
+      cv.notify_all();
+    }
+
+    template <typename F> int run_all(F f, std::function<bool()> stop_callback) {
+      if (!swap_ratio or !swap) TRIQS_RUNTIME_ERROR << "mc_replica_exchange : the swap functions have not been set";
+      stop      = false;
+      n_active  = replicas.size();
+      n_waiting = 0;
+      std::mutex cb_mtx;
+      // stop_callback is called by one replica at a time, and stops all of them.
+      std::function<bool()> shared_stop = [&]() -> bool {
+        if (stop) return true;
+        std::lock_guard<std::mutex> lock(cb_mtx);
+        if (!stop and stop_callback()) stop = true;
+        return stop;
+      };
+
+      std::vector<int> status(replicas.size(), 0);
+      std::vector<std::exception_ptr> errors(replicas.size());
+      std::vector<std::thread> threads;
+      triqs::signal_handler::start();
+      for (size_t k = 0; k < replicas.size(); ++k)
+        threads.emplace_back([&, k]() {
+          auto &w         = *replicas[k];
+          auto user_duty  = w.after_cycle_duty;
+          uint64_t n_done = 0;
+          w.after_cycle_duty = [&, user_duty]() {
+            if (user_duty) user_duty();
+            if (++n_done % n_cycles_between_swaps == 0) arrive();
+          };
+          try {
+            status[k] = f(w, shared_stop);
+          } catch (...) {
+            errors[k] = std::current_exception();
+            stop      = true;
+          }
+          w.after_cycle_duty = user_duty;
+          leave();
+        });
+      for (auto &t : threads) t.join();
+      triqs::signal_handler::stop();
+
+      for (auto &e : errors)
+        if (e) std::rethrow_exception(e);
+      return *std::max_element(status.begin(), status.end());
+    }
+  };
+} // namespace triqs::mc_tools
@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include <triqs/utility/first_include.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./mc_generic.hpp"
+
+namespace triqs::mc_tools {
+
+  /**
+  * \brief Several independent Monte Carlo walkers, run in parallel threads of one process.
+  *
+  * Each walker is a mc_generic, with its own random generator, moves and measures.
+  * The moves and measures of each walker are registered as usual, on walker(k), and typically
+  * refer to a configuration per walker, and to read-only model data shared by all walkers.
+  *
+  * The measures must have a method ``void merge(M const &)``, which adds the data accumulated by the
+  * same measure in another walker. collect_results merges all walkers into walker 0, and then calls
+  * the collect_results of walker 0 on the communicator : only the measures of walker 0 hold the final results.
+  *
+  * Walker 0 uses random_seed, hence a mc_threaded with one walker reproduces mc_generic.
+  * Only walker 0 reports.
+  */
+  template <typename MCSignType> class mc_threaded {
+
+    std::vector<std::unique_ptr<mc_generic<MCSignType>>> walkers;
+    bool merged = false;
+
+    public:
+    /**
+    * Constructor
+    *
+    * @param n_walkers       Number of walkers, each run in its own thread. 0 : std::thread::hardware_concurrency()
+    * @param random_name     Name of the random generator (cf doc).
+    * @param random_seed     Seed for the random generator of walker 0. The other walkers use the streams 1, 2, ... of the generator.
+    * @param verbosity       Verbosity level of walker 0. The other walkers are silent.
+    */
+    mc_threaded(int n_walkers, std::string random_name, int random_seed, int verbosity) {
+      if (n_walkers < 0) TRIQS_RUNTIME_ERROR << "mc_threaded : the number of walkers must be non-negative, got " << n_walkers;
+      if (n_walkers == 0) n_walkers = std::max<int>(std::thread::hardware_concurrency(), 1);
+      for (int k = 0; k < n_walkers; ++k) {
+        walkers.push_back(std::make_unique<mc_generic<MCSignType>>(random_name, random_seed, (k == 0 ? verbosity : 0), k));
+        walkers.back()->manage_signal_handler = false;
+      }
+    }
+
+    /// Number of walkers
+    int n_walkers() const { return walkers.size(); }
+
+    /// The k-th walker, to register its moves and measures
+    mc_generic<MCSignType> &walker(int k) { return *walkers.at(k); }
+
+    /// Warmup all walkers. Cf mc_generic
+    int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop) { return w.warmup(n_warmup_cycles, length_cycle, stop); }, stop_callback);
+    }
+
+    /// Accumulate/Measure on all walkers. Each walker does n_accumulation_cycles cycles. Cf mc_generic
+    int accumulate(uint64_t n_accumulation_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop) { return w.accumulate(n_accumulation_cycles, length_cycle, stop); }, stop_callback);
+    }
+
+    /**
+     * Warmup and accumulate all walkers, in parallel. Each walker does n_warmup_cycles and n_accumulation_cycles cycles.
+     *
+     * stop_callback is called by the walkers in turn. When it returns true, or a signal is received, all the walkers stop.
+     *
+     * @return the largest status of the walkers (cf mc_generic)
+     */
+    int warmup_and_accumulate(uint64_t n_warmup_cycles, uint64_t n_accumulation_cycles, uint64_t length_cycle, std::function<bool()> stop_callback) {
+      return run_all([=](auto &w, auto stop) { return w.warmup_and_accumulate(n_warmup_cycles, n_accumulation_cycles, length_cycle, stop); },
+                     stop_callback);
+    }
+
+    /// Merge the measures and move statistics of all walkers into walker 0, then reduce them on the communicator. To be called once.
+    void collect_results(mpi::communicator const &c) {
+      if (merged) TRIQS_RUNTIME_ERROR << "mc_threaded : collect_results can only be called once";
+      for (size_t k = 1; k < walkers.size(); ++k) walkers[0]->merge(*walkers[k]);
+      merged = true;
+      walkers[0]->collect_results(c);
+    }
+
+    /// The acceptance rates of all moves, over all walkers and nodes, after collect_results
+    std::map<std::string, double> get_acceptance_rates() const { return walkers[0]->get_acceptance_rates(); }
+
+    /// The time spent on warmup in seconds
+    double get_warmup_time() const { return walkers[0]->get_warmup_time(); }
+
+    /// The time spent on accumulation in seconds
+    double get_accumulation_time() const { return walkers[0]->get_accumulation_time(); }
+
+    private:
+    template <typename F> int run_all(F f, std::function<bool()> stop_callback) {
+      if (merged) TRIQS_RUNTIME_ERROR << "mc_threaded : the walkers can not run after collect_results";
+      std::atomic<bool> stop = false;
+      std::mutex mtx;
+      // stop_callback is called by one walker at a time, and stops all of them.
+      std::function<bool()> shared_stop = [&]() -> bool {
+        if (stop) return true;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!stop and stop_callback()) stop = true;
+        return stop;
+      };
+
+      std::vector<int> status(walkers.size(), 0);
+      std::vector<std::exception_ptr> errors(walkers.size());
+      std::vector<std::thread> threads;
+      triqs::signal_handler::start();
+      for (size_t k = 0; k < walkers.size(); ++k)
+        threads.emplace_back([&, k]() {
+          try {
+            status[k] = f(*walkers[k], shared_stop);
+          } catch (...) {
+            errors[k] = std::current_exception();
+            stop      = true;
+          }
+        });
+      for (auto &t : threads) t.join();
+      triqs::signal_handler::stop();
+
+      for (auto &e : errors)
+        if (e) std::rethrow_exception(e);
+      return *std::max_element(status.begin(), status.end());
+    }
+  };
+} // namespace triqs::mc_tools
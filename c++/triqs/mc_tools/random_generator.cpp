@@ -19,6 +19,7 @@
 
 #include "random_generator.hpp"
 #include "./MersenneRNG.hpp"
+#include "./counter_based_rng.hpp"
 #include "./../utility/macros.hpp"
 //#include <boost/random/uniform_int.hpp>
 #include <boost/random/uniform_real.hpp>
@@ -26,6 +27,7 @@
 #include <boost/random/lagged_fibonacci.hpp>
 #include <boost/random/ranlux.hpp>
 #include <boost/random/variate_generator.hpp>
+#include <boost/random/detail/signed_unsigned_tools.hpp>
 #include <sstream>
 #include <boost/preprocessor/seq.hpp>
 #include <boost/preprocessor/control/if.hpp>
@@ -35,23 +37,73 @@
   (mt19937)(mt11213b)(lagged_fibonacci607)(lagged_fibonacci1279)(lagged_fibonacci2281)(lagged_fibonacci3217)(lagged_fibonacci4423)(                  \
      lagged_fibonacci9689)(lagged_fibonacci19937)(lagged_fibonacci23209)(lagged_fibonacci44497)(ranlux3)
 
+// List of the counter-based generators, cf counter_based_rng.hpp
+#define CB_RNG_LIST (philox4x32)(threefry4x64)
+
 namespace triqs {
   namespace mc_tools {
 
-    random_generator::random_generator(std::string const &RandomGeneratorName, uint32_t seed_) {
+    namespace {
+      // A boost engine with the uniform distribution on [0,1[, as the variate_generator, but whose state can be saved
+      template <typename Engine> struct uniform_generator {
+        Engine engine;
+        boost::uniform_real<> dis;
+        double operator()() { return dis(engine); }
+
+        // The same numbers as dis(engine) (which never rejects a number for [0,1[), with the division in a separate, vectorized, loop
+        void fill(double *first, size_t n) {
+          using base_t = typename Engine::result_type;
+          double divisor;
+          if constexpr (std::is_integral_v<base_t>) {
+            boost::random::detail::subtract<base_t> sub;
+            for (size_t i = 0; i < n; ++i) first[i] = static_cast<double>(sub(engine(), (engine.min)()));
+            divisor = static_cast<double>(sub((engine.max)(), (engine.min)())) + 1;
+          } else {
+            for (size_t i = 0; i < n; ++i) first[i] = static_cast<double>(engine() - (engine.min)());
+            divisor = static_cast<double>((engine.max)() - (engine.min)());
+          }
+          for (size_t i = 0; i < n; ++i) first[i] /= divisor;
+        }
+
+        friend std::ostream &operator<<(std::ostream &out, uniform_generator const &g) { return out << g.engine; }
+        friend std::istream &operator>>(std::istream &in, uniform_generator &g) { return in >> g.engine; }
+      };
+
+      // A counter-based engine, with its own uniform distribution
+      template <typename Engine> struct counter_based_generator {
+        Engine engine;
+        double operator()() { return engine.uniform(); }
+        void fill(double *first, size_t n) { engine.fill_uniform(first, first + n); }
+        friend std::ostream &operator<<(std::ostream &out, counter_based_generator const &g) { return out << g.engine; }
+        friend std::istream &operator>>(std::istream &in, counter_based_generator &g) { return in >> g.engine; }
+      };
+    } // namespace
+
+    random_generator::random_generator(std::string const &RandomGeneratorName, uint32_t seed_, uint64_t stream_id, size_t buffer_size) {
       _name = RandomGeneratorName;
+      if (buffer_size == 0) TRIQS_RUNTIME_ERROR << "random_generator : the size of the buffer must be positive";
+
+      // the counter-based generators have independent streams
+#define DCBRNG(r, data, XX)                                                                                                                          \
+  if (RandomGeneratorName == AS_STRING(XX)) {                                                                                                        \
+    gen = utility::buffered_function<double>(counter_based_generator<RandomGenerators::XX>{RandomGenerators::XX(seed_, stream_id)}, buffer_size);    \
+    return;                                                                                                                                          \
+  }
+
+      BOOST_PP_SEQ_FOR_EACH(DCBRNG, ~, CB_RNG_LIST)
+
+      // for the others, the stream is given by a derived seed
+      seed_ = derived_seed(seed_, stream_id);
 
       if (RandomGeneratorName == "") {
-        gen = utility::buffered_function<double>(mc_tools::RandomGenerators::RandMT(seed_));
+        gen = utility::buffered_function<double>(mc_tools::RandomGenerators::RandMT(seed_), buffer_size);
         return;
       }
 
-      boost::uniform_real<> dis;
-
 // now boost random number generators
 #define DRNG(r, data, XX)                                                                                                                            \
   if (RandomGeneratorName == AS_STRING(XX)) {                                                                                                        \
-    gen = utility::buffered_function<double>(boost::variate_generator<boost::XX, boost::uniform_real<>>(boost::XX(seed_), dis));                     \
+    gen = utility::buffered_function<double>(uniform_generator<boost::XX>{boost::XX(seed_), {}}, buffer_size);                                       \
     return;                                                                                                                                          \
   }
 
@@ -64,13 +116,14 @@ namespace triqs {
 
     std::string random_generator_names(std::string const &sep) {
 #define PR(r, sep, p, XX) BOOST_PP_IF(p, +sep +, ) std::string(AS_STRING(XX))
-      return BOOST_PP_SEQ_FOR_EACH_I(PR, sep, RNG_LIST);
+      return BOOST_PP_SEQ_FOR_EACH_I(PR, sep, RNG_LIST) + sep + BOOST_PP_SEQ_FOR_EACH_I(PR, sep, CB_RNG_LIST);
     }
 
     std::vector<std::string> random_generator_names_list() {
       std::vector<std::string> res;
 #define PR2(r, sep, p, XX) res.push_back(AS_STRING(XX));
       BOOST_PP_SEQ_FOR_EACH_I(PR2, sep, RNG_LIST);
+      BOOST_PP_SEQ_FOR_EACH_I(PR2, sep, CB_RNG_LIST);
       return res;
     }
   } // namespace mc_tools
@@ -34,10 +34,13 @@ namespace triqs {
     std::vector<std::string> random_generator_names_list();
 
     /**
-  * Random generator, adapting the boost random generator.
+  * Random generator, adapting the boost random generator, or a counter-based generator (philox4x32, threefry4x64).
   *
   * The name of the generator is given at construction, and its type is erased in this class.
-  * For performance, the call to the generator is bufferized, with chunks of 1000 numbers.
+  * The generators of several threads or nodes are given by a stream_id : the counter-based generators
+  * have truly independent streams, for the others the stream_id is mixed into the seed (cf derived_seed).
+  * For performance, the call to the generator is bufferized, with chunks of 1000 numbers by default,
+  * refilled at once by vectorized loops.
   */
     class random_generator {
       utility::buffered_function<double> gen;
@@ -45,10 +48,13 @@ namespace triqs {
 
       public:
       /** Constructor
-   *  @param RandomGeneratorName : Name of a boost generator e.g. mt19937, or "" (another Mersenne Twister).
+   *  @param RandomGeneratorName : Name of a boost generator e.g. mt19937, of a counter-based generator e.g. philox4x32,
+   *                               or "" (another Mersenne Twister).
    *  @param seed : The seed of the random generator
+   *  @param stream_id : The stream, e.g. the rank of the node or the thread [optional]
+   *  @param buffer_size : The number of random numbers generated at once [optional]
    */
-      random_generator(std::string const &RandomGeneratorName, uint32_t seed_);
+      random_generator(std::string const &RandomGeneratorName, uint32_t seed_, uint64_t stream_id = 0, size_t buffer_size = 1000);
 
       random_generator() : random_generator("mt19937", 198) {}
 
@@ -68,6 +74,21 @@ namespace triqs {
         return (i == 1 ? 0 : T(floor(i * (gen()))));
       }
 
+      /**
+       * The state of the generator : the state of the engine and the numbers already drawn in the buffer.
+       * Restored with set_state on a generator with the same name, the generator continues with exactly the same sequence.
+       * Not available for the generator "".
+       */
+      std::string get_state() const { return _name + '\n' + gen.get_state(); }
+
+      /// Restore a state given by get_state
+      void set_state(std::string const &state) {
+        auto pos = state.find('\n');
+        if (pos == std::string::npos or state.substr(0, pos) != _name)
+          TRIQS_RUNTIME_ERROR << "random_generator : the state is not the state of a generator " << _name;
+        gen.set_state(state.substr(pos + 1));
+      }
+
       /// Returns a double in [0,1[ with flat distribution
       double preview() { return gen.preview(); }
 
@@ -82,5 +103,17 @@ namespace triqs {
         return a + (b - a) * (gen());
       }
     };
+
+    /**
+     * Seed of the k-th of several generators of one process (threads, replicas ...), from the seed of the process.
+     * k = 0 gives seed itself. The others are mixed with splitmix64, hence decorrelated from the usual seeds seed + rank * const of the mpi nodes.
+     */
+    inline uint32_t derived_seed(uint32_t seed, uint64_t k) {
+      if (k == 0) return seed;
+      uint64_t z = uint64_t(seed) + 0x9e3779b97f4a7c15ULL * uint64_t(k);
+      z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return uint32_t((z ^ (z >> 31)) & 0x7fffffff);
+    }
   } // namespace mc_tools
 } // namespace triqs
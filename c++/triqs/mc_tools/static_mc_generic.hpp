@@ -0,0 +1,435 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include <triqs/utility/first_include.hpp>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <triqs/utility/timer.hpp>
+#include <triqs/utility/timestamp.hpp>
+#include <triqs/utility/report_stream.hpp>
+#include <triqs/utility/signal_handler.hpp>
+#include <triqs/utility/macros.hpp>
+#include <mpi/mpi.hpp>
+#include "./mc_measure_aux_set.hpp"
+#include "./mc_measure_set.hpp"
+#include "./random_generator.hpp"
+#include "./impl_tools.hpp"
+
+namespace triqs::mc_tools {
+
+  /**
+  * \brief Monte Carlo class with a set of moves fixed at compile time.
+  *
+  * Same interface and same Markov chain as mc_generic (for the same seed, the same moves are
+  * proposed and accepted), but the moves are kept by value in a std::tuple and the move chosen
+  * at each step is called through a switch on its index, without type erasure.
+  * Hence the attempt/accept/reject of light moves can be inlined in the Metropolis loop.
+  * The signals are checked after each cycle, not after each step.
+  *
+  * The measures are called once per cycle and are type erased, as in mc_generic.
+  *
+  * @tparam MCSignType  Type of the sign (double or std::complex<double>)
+  * @tparam Moves       Types of the moves. Must model the Move concept.
+  */
+  template <typename MCSignType, typename... Moves> class static_mc_generic {
+
+    static_assert(sizeof...(Moves) > 0, "static_mc_generic needs at least one move");
+    static_assert((has_attempt<MCSignType, Moves>::value and ...), "A move has no attempt method (or is has an incorrect signature) !");
+    static_assert((has_accept<MCSignType, Moves>::value and ...), "A move has no accept method (or is has an incorrect signature) !");
+    static_assert((has_reject<Moves>::value and ...), "A move has no reject method (or is has an incorrect signature) !");
+
+    static constexpr size_t n_moves = sizeof...(Moves);
+
+    public:
+    /**
+    * Constructor
+    *
+    * @param random_name     Name of the random generator (cf doc).
+    * @param random_seed     Seed for the random generator
+    * @param verbosity       Verbosity level. 0 : None, ... TBA
+    */
+    static_mc_generic(std::string random_name, int random_seed, int verbosity)
+       : RandomGenerator(random_name, random_seed), report(&std::cout, verbosity) {}
+
+    /**
+   * Set the moves
+   *
+   * They usually refer to the random generator, hence are set after the construction.
+   *
+   * @param m                         The moves, moved or copied into the object.
+   * @param names                     Names of the moves
+   * @param proposition_probabilities Probability that each move will be proposed. Precondition : >=0, with a positive sum.
+   *                                  NB it but does not need to be normalized.
+   */
+    void set_moves(std::tuple<Moves...> m, std::array<std::string, n_moves> names, std::array<double, n_moves> proposition_probabilities) {
+      AllMoves.emplace(std::move(m));
+      names_ = std::move(names);
+      double acc = 0;
+      for (auto p : proposition_probabilities) {
+        if (p < 0) TRIQS_RUNTIME_ERROR << "static_mc_generic : the proposition probability of a move is negative";
+        acc += p;
+      }
+      if (!(acc > 0)) TRIQS_RUNTIME_ERROR << "static_mc_generic : the sum of the proposition probabilities is not positive";
+      // Same accumulated probabilities as move_set, so that the same move is selected for the same random number
+      double s = 0;
+      for (size_t u = 0; u < n_moves; ++u) Proba_Moves_Acc_Sum[u] = (s += proposition_probabilities[u] / acc);
+      Proba_Moves_Acc_Sum[n_moves - 1] += 0.001;
+      NProposed.fill(0);
+      Naccepted.fill(0);
+      acceptance_rates.fill(-1);
+    }
+
+    /// Set the moves, all proposed with the same probability
+    void set_moves(std::tuple<Moves...> m, std::array<std::string, n_moves> names) {
+      std::array<double, n_moves> p;
+      p.fill(1.0);
+      set_moves(std::move(m), std::move(names), p);
+    }
+
+    /// Access to the k-th move
+    template <size_t k> auto &get_move() { return std::get<k>(*AllMoves); }
+
+    /**
+   * Register a measure
+   *
+   * If the measure m is an rvalue, it is moved into the static_mc_generic, otherwise is copied into it.
+   *
+   * @param M                        The measure. Must model Measure concept
+   * @param name                     Name of the measure
+   *
+   */
+    template <typename MeasureType>
+    typename measure_set<MCSignType>::measure_ptr_t add_measure(MeasureType &&m, std::string name, bool enable_timer = true) {
+      static_assert(!std::is_pointer<MeasureType>::value, "add_measure in static_mc_generic takes ONLY values !");
+      return AllMeasures.insert(std::forward<MeasureType>(m), name, enable_timer);
+    }
+
+    /**
+   * Register a common part for several measure [EXPERIMENTAL: API WILL CHANGE]
+   */
+    template <typename MeasureAuxType> void add_measure_aux(std::shared_ptr<MeasureAuxType> p) { AllMeasuresAux.emplace_back(p); }
+
+    /**
+   * Deregister a measure
+   *
+   * @param m      The measure. Must be the return value of add_measure
+   *
+   */
+    void rm_measure(typename measure_set<MCSignType>::measure_ptr_t const &m) { AllMeasures.remove(m); }
+
+    /**
+   * Sets a function called after each cycle
+   * @param f The function be called.
+   */
+    void set_after_cycle_duty(std::function<void()> f) { after_cycle_duty = f; }
+
+    /// Warmup the Monte-Carlo configuration. Cf mc_generic
+    int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      report << "\nWarming up ..." << std::endl;
+      return run(n_warmup_cycles, length_cycle, stop_callback, false);
+    }
+
+    /// Warmup the Monte-Carlo configuration, with the sign of the initial configuration. Cf mc_generic
+    int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback, MCSignType sign_init) {
+      sign = sign_init;
+      return warmup(n_warmup_cycles, length_cycle, stop_callback);
+    }
+
+    /// Accumulate/Measure. Cf mc_generic
+    int accumulate(uint64_t n_accumulation_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
+      report << "\nAccumulating ..." << std::endl;
+      return run(n_accumulation_cycles, length_cycle, stop_callback, true);
+    }
+
+    /// Warmup and accumulate. Cf mc_generic
+    int warmup_and_accumulate(uint64_t n_warmup_cycles, uint64_t n_accumulation_cycles, uint64_t length_cycle, std::function<bool()> stop_callback) {
+      int status = warmup(n_warmup_cycles, length_cycle, stop_callback);
+      if (status == 0) status = accumulate(n_accumulation_cycles, length_cycle, stop_callback);
+      return status;
+    }
+
+    /// Warmup and accumulate, with the sign of the initial configuration. Cf mc_generic
+    int warmup_and_accumulate(uint64_t n_warmup_cycles, uint64_t n_accumulation_cycles, uint64_t length_cycle, std::function<bool()> stop_callback,
+                              MCSignType sign_init) {
+      sign = sign_init;
+      return warmup_and_accumulate(n_warmup_cycles, n_accumulation_cycles, length_cycle, stop_callback);
+    }
+
+    private:
+    // implementation
+
+    // Call f on the k-th move. The fold expands to a chain of tests on the constant indices,
+    // which the compiler turns into a switch, and f is inlined in each branch.
+    template <typename F, size_t... Is> FORCEINLINE void dispatch(size_t k, F &&f, std::index_sequence<Is...>) {
+      auto &t = *AllMoves;
+      ((k == Is ? (f(std::get<Is>(t)), true) : false) or ...);
+    }
+    template <typename F> FORCEINLINE void dispatch(size_t k, F &&f) { dispatch(k, std::forward<F>(f), std::make_index_sequence<n_moves>{}); }
+
+    bool treat_infinite_ratio(std::complex<double>, double &, MCSignType &) { return true; }
+
+    bool treat_infinite_ratio(double rate_ratio, double &abs_rate_ratio, MCSignType &try_sign_ratio) {
+      bool is_inf = std::isinf(rate_ratio);
+      if (is_inf) {
+        abs_rate_ratio = 100; // >1 for metropolis
+        try_sign_ratio = (std::signbit(rate_ratio) ? -1 : 1);
+      }
+      return !is_inf;
+    }
+
+    // One Metropolis step, as move_set::attempt followed by the accept/reject in mc_generic::run
+    FORCEINLINE void step() {
+      double proba = RandomGenerator();
+      size_t k     = 0;
+      while (k < n_moves - 1 and proba >= Proba_Moves_Acc_Sum[k]) ++k;
+      ++NProposed[k];
+      MCSignType rate_ratio = 0;
+      dispatch(k, [&rate_ratio](auto &m) { rate_ratio = m.attempt(); });
+      double abs_rate_ratio;
+      MCSignType try_sign_ratio;
+      if (treat_infinite_ratio(rate_ratio, abs_rate_ratio, try_sign_ratio)) {
+        if (!std::isfinite(std::abs(rate_ratio)))
+          TRIQS_RUNTIME_ERROR << "Monte Carlo Error : the rate (" << rate_ratio << ") is not finite in move " << names_[k];
+        abs_rate_ratio = std::abs(rate_ratio);
+        try_sign_ratio = (abs_rate_ratio > 1.e-14 ? rate_ratio / abs_rate_ratio : 1); // keep the sign
+      }
+      if (RandomGenerator() < std::min(1.0, abs_rate_ratio)) {
+        ++Naccepted[k];
+        dispatch(k, [this, try_sign_ratio](auto &m) { sign *= try_sign_ratio * MCSignType(m.accept()); });
+      } else
+        dispatch(k, [](auto &m) { m.reject(); });
+    }
+
+    int run(uint64_t n_cycles, uint64_t length_cycle, std::function<bool()> stop_callback, bool do_measure = true) {
+      if (!AllMoves) TRIQS_RUNTIME_ERROR << "static_mc_generic : the moves have not been set";
+      utility::timer timer;
+      timer.start();
+      if (n_cycles == 0) return 0;
+      triqs::signal_handler::start();
+      done_percent = 0;
+      nmeasures    = 0;
+      bool stop_it = false, finished = false;
+      int NC                = 0;
+      double next_info_time = 0.1;
+      for (; !stop_it; ++NC) { // do NOT reinit NC to 0
+        for (uint64_t k = 0; k < length_cycle; k++) step();
+        config_id += length_cycle;
+        if (after_cycle_duty) { after_cycle_duty(); }
+        // The signal is checked once per cycle : the cycle is completed and measured
+        if (do_measure and !triqs::signal_handler::received()) {
+          nmeasures++;
+          for (auto &x : AllMeasuresAux) x();
+          AllMeasures.accumulate(sign);
+        }
+        done_percent = uint64_t(floor(((NC + 1) * 100.0) / n_cycles));
+        if (timer > next_info_time) {
+          report << utility::timestamp() << " " << std::setfill(' ') << std::setw(3) << done_percent << "%"
+                 << " ETA " << estimate_time_left(n_cycles, NC, timer) << " cycle " << NC << " of " << n_cycles << "\n"
+                 << std::flush;
+          next_info_time = 1.25 * timer + 2.0; // Increase time interval non-linearly
+        }
+        finished = NC + 1 >= n_cycles;
+        stop_it  = (stop_callback() || triqs::signal_handler::received() || finished);
+      }
+      int status = (finished ? 0 : (triqs::signal_handler::received() ? 2 : 1));
+      triqs::signal_handler::stop();
+      current_cycle_number += NC;
+      timer.stop();
+      if (do_measure) {
+        timer_accumulation = timer;
+      } else {
+        timer_warmup = timer;
+      }
+
+      // final reporting
+      if (status == 1) report << "static_mc_generic stops because of stop_callback";
+      if (status == 2) report << "static_mc_generic stops because of a signal";
+      report << "\n" << std::endl;
+
+      return status;
+    }
+
+    void collect_statistics(mpi::communicator const &c) {
+      for (size_t u = 0; u < n_moves; ++u) {
+        uint64_t nacc_tot   = mpi::all_reduce(Naccepted[u], c);
+        uint64_t nprop_tot  = mpi::all_reduce(NProposed[u], c);
+        acceptance_rates[u] = nacc_tot / static_cast<double>(nprop_tot);
+      }
+      std::apply(
+         [&c](auto &... m) {
+           for (auto const &f : {make_collect_statistics(&m)...})
+             if (f) f(c);
+         },
+         *AllMoves);
+    }
+
+    public:
+    /// Reduce the results of the measures, and reports some statistics
+    void collect_results(mpi::communicator const &c) {
+      report(3) << "[Rank " << c.rank() << "] Collect results: Waiting for all mpi-threads to finish accumulating...\n";
+      AllMeasures.collect_results(c);
+      collect_statistics(c);
+      uint64_t nmeasures_tot = mpi::reduce(nmeasures, c);
+
+      report(3) << "[Rank " << c.rank() << "] Timings for all measures:\n" << AllMeasures.get_timings();
+      report(3) << "[Rank " << c.rank() << "] Acceptance rate for all moves:\n" << get_statistics();
+      report(3) << "[Rank " << c.rank() << "] Warmup lasted: " << get_warmup_time() << " seconds [" << get_warmup_time_HHMMSS() << "]\n";
+      report(3) << "[Rank " << c.rank() << "] Simulation lasted: " << get_accumulation_time() << " seconds [" << get_accumulation_time_HHMMSS()
+                << "]\n";
+      report(3) << "[Rank " << c.rank() << "] Number of measures: " << nmeasures << std::endl;
+      if (c.rank() == 0) report(2) << "Total number of measures: " << nmeasures_tot << std::endl;
+    }
+
+    /**
+   * The acceptance rates of all move, after collect_results (-1 before)
+   *
+   * @return map : name_of_the_move -> acceptance rate of this move
+   */
+    std::map<std::string, double> get_acceptance_rates() const {
+      std::map<std::string, double> r;
+      for (size_t u = 0; u < n_moves; ++u) r.insert({names_[u], acceptance_rates[u]});
+      return r;
+    }
+
+    /// Pretty printing of the acceptance rates of the moves
+    std::string get_statistics() const {
+      std::ostringstream s;
+      for (size_t u = 0; u < n_moves; ++u) s << "Move " << names_[u] << ": " << acceptance_rates[u] << "\n";
+      return s.str();
+    }
+
+    /// Number of times each move has been proposed on this node
+    std::array<uint64_t, n_moves> const &get_n_proposed() const { return NProposed; }
+
+    /// Number of times each move has been accepted on this node
+    std::array<uint64_t, n_moves> const &get_n_accepted() const { return Naccepted; }
+
+    /**
+   *  The current percents done
+   */
+    uint64_t get_percent() const { return done_percent; }
+
+    /**
+   * An access to the random number generator
+   */
+    random_generator &get_rng() { return RandomGenerator; }
+
+    /**
+   * The current cycle number
+   */
+    int get_current_cycle_number() const { return current_cycle_number; }
+
+    /**
+   * The current number of the visited configuration. Updated after each cycle.
+   */
+    int get_config_id() const { return config_id; }
+
+    /**
+   * The current sign
+   */
+    MCSignType get_sign() const { return sign; }
+
+    /**
+   * The total time of the last run in seconds
+   */
+    double get_total_time() const { return get_warmup_time() + get_accumulation_time(); }
+
+    /**
+   * The time spent on warmup in seconds
+   */
+    double get_warmup_time() const { return double(timer_warmup); }
+
+    /**
+   * The time spent on warmup in hours, minutes, and seconds
+   */
+    auto get_warmup_time_HHMMSS() const { return hours_minutes_seconds_from_seconds(timer_warmup); }
+
+    /**
+   * The time spent on accumulation in seconds
+   */
+    double get_accumulation_time() const { return double(timer_accumulation); }
+
+    /**
+   * The time spent on warmup in hours, minutes, and seconds
+   */
+    auto get_accumulation_time_HHMMSS() const { return hours_minutes_seconds_from_seconds(timer_accumulation); }
+
+    /// HDF5 interface
+    friend void h5_write(h5::group g, std::string const &name, static_mc_generic const &mc) {
+      auto gr = g.create_group(name);
+      if (mc.AllMoves) {
+        auto gm = gr.create_group("moves");
+        size_t u = 0;
+        std::apply(
+           [&](auto const &... m) {
+             for (auto const &f : {make_h5_write(&m)...}) {
+               if (f) f(gm, mc.names_[u]);
+               ++u;
+             }
+           },
+           *mc.AllMoves);
+      }
+      h5_write(gr, "measures", mc.AllMeasures);
+      h5_write(gr, "number_cycle_done", mc.current_cycle_number);
+      h5_write(gr, "number_measure_done", mc.nmeasures);
+      h5_write(gr, "sign", mc.sign);
+    }
+
+    /// HDF5 interface
+    friend void h5_read(h5::group g, std::string const &name, static_mc_generic &mc) {
+      auto gr = g.open_group(name);
+      if (mc.AllMoves) {
+        auto gm = gr.open_group("moves");
+        size_t u = 0;
+        std::apply(
+           [&](auto &... m) {
+             for (auto const &f : {make_h5_read(&m)...}) {
+               if (f) f(gm, mc.names_[u]);
+               ++u;
+             }
+           },
+           *mc.AllMoves);
+      }
+      h5_read(gr, "measures", mc.AllMeasures);
+      h5_read(gr, "number_cycle_done", mc.current_cycle_number);
+      h5_read(gr, "number_measure_done", mc.nmeasures);
+      h5_read(gr, "sign", mc.sign);
+    }
+
+    private:
+    random_generator RandomGenerator;
+    std::optional<std::tuple<Moves...>> AllMoves;
+    std::array<std::string, n_moves> names_;
+    std::array<double, n_moves> Proba_Moves_Acc_Sum;
+    std::array<uint64_t, n_moves> NProposed, Naccepted;
+    std::array<double, n_moves> acceptance_rates;
+    measure_set<MCSignType> AllMeasures;
+    std::vector<measure_aux> AllMeasuresAux;
+    utility::report_stream report;
+    uint64_t nmeasures = 0, current_cycle_number = 0;
+    utility::timer timer_accumulation, timer_warmup;
+    std::function<void()> after_cycle_duty;
+    MCSignType sign       = 1;
+    uint64_t done_percent = 0;
+    uint64_t config_id    = 0;
+  };
+} // namespace triqs::mc_tools
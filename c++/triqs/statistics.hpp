@@ -19,4 +19,5 @@
 #pragma once
 #include "./clef.hpp"
 #include "./statistics/statistics.hpp"
+#include "./statistics/log_binning.hpp"
 #include "./statistics/histograms.hpp"
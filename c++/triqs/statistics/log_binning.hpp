@@ -0,0 +1,266 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#pragma once
+#include "./statistics.hpp"
+#include <h5/h5.hpp>
+#include <mpi/mpi.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace triqs {
+  namespace statistics {
+
+    /**
+     * An observable which does not store the time series : logarithmic binning, in O(log N) memory.
+     *
+     * The level l is the series of the means of the consecutive blocks of 2^l measures. For each level, we keep
+     * the number of blocks, their mean and the sum of the squared deviations to the mean (Welford's update),
+     * and the last block if it is not yet paired with the next one.
+     * The error on the mean and the integrated autocorrelation time are therefore available at any time, for all block sizes.
+     *
+     * In addition, the measures are averaged in at most max_n_bins bins : when all the bins are filled,
+     * they are merged by pairs and the size of the bins is doubled. The complete bins model the TimeSeries concept,
+     * so that the jackknife, average_and_error and the expressions of observables work as for observable<T>,
+     * on a bounded number of bins.
+     *
+     * @tparam T  The type of the measures : a scalar, or an array (the operations are elementwise).
+     */
+    template <typename T> class log_binning {
+
+      // level l : the blocks of 2^l measures
+      std::vector<long> _count;      // number of blocks
+      std::vector<T> _mean, _m2;     // mean of the blocks, sum of (x - mean)^2
+      std::vector<T> _pending;       // the last block, if _has_pending[l]
+      std::vector<int> _has_pending; //
+
+      // the bounded bins
+      int _max_n_bins;
+      long _bin_size = 1;
+      std::vector<T> _bins;   // the complete bins (their mean)
+      T _current_sum;         // sum of the measures of the incomplete bin
+      long _current_count = 0; // number of measures in the incomplete bin
+
+      // add the block x to the level l, and the merged blocks to the next levels
+      void add_block(T x, int l) {
+        for (;; ++l) {
+          if (l == n_levels()) {
+            _count.push_back(0);
+            _mean.push_back(T(0 * x));
+            _m2.push_back(T(0 * x));
+            _pending.push_back(x);
+            _has_pending.push_back(0);
+          }
+          T delta = x - _mean[l];
+          ++_count[l];
+          _mean[l] += delta / double(_count[l]);
+          _m2[l] += delta * (x - _mean[l]);
+          if (!_has_pending[l]) {
+            _pending[l]     = x;
+            _has_pending[l] = 1;
+            return;
+          }
+          x               = T((_pending[l] + x) / 2);
+          _has_pending[l] = 0;
+        }
+      }
+
+      // merge the consecutive bins by groups of factor (the last incomplete group is dropped)
+      static std::vector<T> rebin(std::vector<T> const &bins, long factor) {
+        std::vector<T> r;
+        for (long i = 0; i + factor <= long(bins.size()); i += factor) {
+          T s = bins[i];
+          for (long j = 1; j < factor; ++j) s += bins[i + j];
+          r.push_back(T(s / double(factor)));
+        }
+        return r;
+      }
+
+      public:
+      using value_type = T;
+
+      /// Constructor
+      /**
+       * @param max_n_bins Maximal number of bins kept for the jackknife. Must be even.
+       */
+      log_binning(int max_n_bins = 128) : _max_n_bins(max_n_bins) {
+        if ((max_n_bins < 2) or (max_n_bins % 2 != 0)) TRIQS_RUNTIME_ERROR << "log_binning : max_n_bins (" << max_n_bins << ") must be even and > 0";
+      }
+
+      /// Add a measure
+      log_binning &operator<<(T const &x) {
+        add_block(x, 0);
+        if (_current_count == 0)
+          _current_sum = x;
+        else
+          _current_sum += x;
+        if (++_current_count == _bin_size) {
+          _bins.push_back(T(_current_sum / double(_bin_size)));
+          _current_count = 0;
+          if (int(_bins.size()) == _max_n_bins) {
+            _bins = rebin(_bins, 2);
+            _bin_size *= 2;
+          }
+        }
+        return *this;
+      }
+
+      /// Number of measures
+      long n_measures() const { return _count.empty() ? 0 : _count[0]; }
+
+      /// Number of levels : the level l has the blocks of size 2^l
+      int n_levels() const { return _count.size(); }
+
+      /// Number of blocks of the level l
+      long n_blocks(int l) const { return _count[l]; }
+
+      /// Mean of all the measures
+      T mean() const { return _mean.empty() ? T{} : _mean[0]; }
+
+      /// Empirical variance of the blocks of the level l
+      T variance(int l) const {
+        if (_count[l] < 2) TRIQS_RUNTIME_ERROR << "log_binning : the variance of the level " << l << " needs at least 2 blocks";
+        return T(_m2[l] / double(_count[l] - 1));
+      }
+
+      /// Error on the mean, estimated from the blocks of the level l
+      T error(int l) const {
+        using std::sqrt;
+        return T(sqrt(variance(l) / double(_count[l])));
+      }
+
+      /// Integrated autocorrelation time, estimated from the blocks of the level l : tau = (2^l var_l / var_0 - 1) / 2
+      T autocorrelation_time(int l) const { return T(0.5 * (variance(l) * double(1l << l) / variance(0) - 1)); }
+
+      /// Integrated autocorrelation time, estimated from the last level with at least 32 blocks
+      T autocorrelation_time() const {
+        int l = n_levels() - 1;
+        while ((l > 0) and (_count[l] < 32)) --l;
+        if (l <= 0) TRIQS_RUNTIME_ERROR << "log_binning : not enough measures (" << n_measures() << ") to estimate the autocorrelation time";
+        return autocorrelation_time(l);
+      }
+
+      /// Maximal number of bins
+      int max_n_bins() const { return _max_n_bins; }
+
+      /// Number of measures in a bin
+      long bin_size() const { return _bin_size; }
+
+      /// The complete bins
+      std::vector<T> const &bins() const { return _bins; }
+
+      // TimeSeries concept : the complete bins
+      int size() const { return _bins.size(); }
+      T operator[](int i) const { return _bins[i]; }
+
+      /// MPI-reduce
+      /**
+       * Merge the log_binning of several independent series, e.g. one per node : the levels are merged,
+       * and the bins of the same index are averaged (after rebinning to the largest bin size), i.e. a bin of the result
+       * has bin_size() * c.size() measures. The result is meant for the analysis, no measure should be added to it.
+       *
+       * The only supported reduction operation is MPI_SUM.
+       *
+       * @param a log_binning subject to reduction
+       * @param c MPI communicator object
+       * @param root MPI root rank for MPI reduction
+       * @param all Send reduction result to all ranks in `c`?
+       * @param op Reduction operation, must be MPI_SUM
+       * @return Reduction result; valid only on MPI rank 0 if `all = false`
+       */
+      friend log_binning mpi_reduce(log_binning const &a, mpi::communicator c = {}, int root = 0, bool all = false, MPI_Op op = MPI_SUM) {
+        TRIQS_ASSERT(op == MPI_SUM);
+        auto reduce = [&](T const &x, bool to_all) -> T { return mpi::reduce(x, c, root, to_all, op); };
+        log_binning r(a._max_n_bins);
+
+        // the levels present on all nodes. The global mean is needed for the sum of the squared deviations
+        int n_levels = mpi::all_reduce(a.n_levels(), c, MPI_MIN);
+        for (int l = 0; l < n_levels; ++l) {
+          long n = mpi::all_reduce(a._count[l], c);
+          T mean = T(reduce(T(a._mean[l] * double(a._count[l])), true) / double(n));
+          T d    = a._mean[l] - mean;
+          r._count.push_back(n);
+          r._mean.push_back(mean);
+          r._m2.push_back(reduce(T(a._m2[l] + d * d * double(a._count[l])), all));
+          r._pending.push_back(mean);
+          r._has_pending.push_back(0);
+        }
+
+        // the bins
+        long bin_size = mpi::all_reduce(a._bin_size, c, MPI_MAX);
+        auto bins     = rebin(a._bins, bin_size / a._bin_size);
+        int n_bins    = mpi::all_reduce(int(bins.size()), c, MPI_MIN);
+        for (int i = 0; i < n_bins; ++i) r._bins.push_back(T(reduce(bins[i], all) / double(c.size())));
+        r._bin_size = bin_size * c.size();
+        return r;
+      }
+
+      /// Get HDF5 scheme name
+      static std::string hdf5_format() { return "LogBinning"; }
+
+      /// Write to HDF5
+      friend void h5_write(h5::group g, std::string const &name, log_binning const &a) {
+        auto gr = g.create_group(name);
+        write_hdf5_format(gr, a);
+        h5_write(gr, "count", a._count);
+        h5_write(gr, "mean", a._mean);
+        h5_write(gr, "m2", a._m2);
+        h5_write(gr, "pending", a._pending);
+        h5_write(gr, "has_pending", a._has_pending);
+        h5_write(gr, "max_n_bins", a._max_n_bins);
+        h5_write(gr, "bin_size", a._bin_size);
+        h5_write(gr, "bins", a._bins);
+        h5_write(gr, "current_count", a._current_count);
+        if (a._current_count > 0) h5_write(gr, "current_sum", a._current_sum);
+      }
+
+      /// Read from HDF5
+      friend void h5_read(h5::group g, std::string const &name, log_binning &a) {
+        auto gr = g.open_group(name);
+        h5_read(gr, "count", a._count);
+        h5_read(gr, "mean", a._mean);
+        h5_read(gr, "m2", a._m2);
+        h5_read(gr, "pending", a._pending);
+        h5_read(gr, "has_pending", a._has_pending);
+        h5_read(gr, "max_n_bins", a._max_n_bins);
+        h5_read(gr, "bin_size", a._bin_size);
+        h5_read(gr, "bins", a._bins);
+        h5_read(gr, "current_count", a._current_count);
+        if (a._current_count > 0) h5_read(gr, "current_sum", a._current_sum);
+      }
+    };
+
+    template <typename T> struct is_time_series<log_binning<T>> : std::true_type {};
+
+    // -------------  average, average_and_error, and the leaves of the expressions --------------------------
+
+    /// The mean of all the measures
+    template <typename T> T average(log_binning<T> const &obs) { return obs.mean(); }
+
+    /// Jackknife on the bins
+    template <typename T> value_and_error_bar<T> average_and_error(log_binning<T> const &obs) {
+      return empirical_average_and_error(make_jackknife(obs));
+    }
+
+    template <typename T> auto eval(log_binning<T> const &obs, repl_by_jack) DECL_AND_RETURN(make_jackknife(obs));
+
+    // the distributed jackknife on the bins : each bin has bin_size() measures
+    template <typename T> observable<T> eval(log_binning<T> const &obs, repl_by_mpi_jack const &info) {
+      return detail::mpi_jackknife(obs, obs.bin_size(), info);
+    }
+
+  } // namespace statistics
+} // namespace triqs
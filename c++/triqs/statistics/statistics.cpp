@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include "../statistics.hpp"
+#include <triqs/gfs/transform/fourier_common.hpp>
+#include <climits>
+#include <vector>
+
+namespace triqs {
+  namespace statistics {
+
+    namespace {
+      // The smallest m >= n of the form 2^a 3^b 5^c, for which fftw is fast
+      long fft_size(long n) {
+        for (long m = n;; ++m) {
+          long r = m;
+          for (long p : {2, 3, 5})
+            while (r % p == 0) r /= p;
+          if (r == 1) return m;
+        }
+      }
+    } // namespace
+
+    // Wiener-Khinchin : the autocovariance is the inverse transform of the power spectrum |FFT(x - avg)|^2.
+    // The series are padded with zeros to a size M >= 2N, so that the circular correlation is the linear one.
+    // We use the (cached) real to complex transforms of the Fourier module. The power spectrum P is real and even,
+    // hence its inverse transform is the real part of its forward transform, divided by M.
+    void _autocovariance_fft(double *x, long N, long n) {
+      if ((N == 0) or (n == 0)) return;
+      long M = fft_size(2 * N);
+      if (M > INT_MAX) TRIQS_RUNTIME_ERROR << "autocorrelation : the time series is too long (" << N << ")";
+
+      std::vector<double> avg(n, 0);
+      for (long i = 0; i < N; ++i)
+        for (long s = 0; s < n; ++s) avg[s] += x[i * n + s];
+      for (auto &v : avg) v /= N;
+
+      // the transforms are along the first dimension, for each series s
+      arrays::array<double, 2> a(M, n);
+      a() = 0;
+      for (long i = 0; i < N; ++i)
+        for (long s = 0; s < n; ++s) a(i, s) = x[i * n + s] - avg[s];
+
+      arrays::array<std::complex<double>, 2> f(M / 2 + 1, n);
+      int dims[] = {int(M)};
+      gfs::_fourier_base(a, f, 1, dims, n);
+
+      for (long j = 0; j <= M / 2; ++j)
+        for (long s = 0; s < n; ++s) a(j, s) = std::norm(f(j, s));
+      for (long j = M / 2 + 1; j < M; ++j)
+        for (long s = 0; s < n; ++s) a(j, s) = a(M - j, s);
+
+      gfs::_fourier_base(a, f, 1, dims, n);
+
+      // N - 1 <= M / 2
+      for (long k = 0; k < N; ++k)
+        for (long s = 0; s < n; ++s) x[k * n + s] = std::real(f(k, s)) / M;
+    }
+
+  } // namespace statistics
+} // namespace triqs
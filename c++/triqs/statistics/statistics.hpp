@@ -20,6 +20,8 @@
 #pragma once
 #include <triqs/utility/exceptions.hpp>
 #include <triqs/utility/tuple_tools.hpp>
+#include <mpi/mpi.hpp>
+#include <complex>
 #include <type_traits>
 #include <vector>
 #include <cmath>
@@ -353,6 +355,81 @@ namespace triqs {
       return empirical_average_and_error(make_immutable_time_series(expr_bin_jack));
     }
 
+    // -------------  Jackknife distributed over the nodes --------------------------
+
+    struct repl_by_mpi_jack {
+      mpi::communicator c;
+      int n_bins;
+    };
+
+    namespace detail {
+
+      /*
+       * The jackknife series of the observable distributed over the nodes of c, each node having its own series t.
+       * The local series is cut in n_bins bins. The sums of the bins of the same index and their number of measures are reduced
+       * over the nodes (each element of t counting as weight measures), and the jackknife series is
+       * jack_b = (S - S_b) / (n - n_b), with S_b, n_b the sum and number of measures of the bin b, S and n the totals.
+       * The jackknife series is the same on all nodes.
+       */
+      template <typename TimeSeries> auto mpi_jackknife(TimeSeries const &t, long weight, repl_by_mpi_jack const &info) {
+        using T  = typename TimeSeries::value_type;
+        auto &c  = info.c;
+        int nb   = info.n_bins;
+        long N   = t.size();
+        if (nb < 2) TRIQS_RUNTIME_ERROR << "Distributed jackknife : the number of bins (" << nb << ") must be at least 2";
+        if (mpi::all_reduce(N, c, MPI_MIN) == 0) TRIQS_RUNTIME_ERROR << "Distributed jackknife : an observable is empty on some node";
+
+        // the local bins
+        std::vector<T> S(nb, T(0 * t[0]));
+        std::vector<long> n(nb, 0);
+        for (int b = 0; b < nb; ++b) {
+          for (long i = b * N / nb; i < (b + 1) * N / nb; ++i) S[b] += t[i];
+          S[b] *= double(weight);
+          n[b] = weight * ((b + 1) * N / nb - b * N / nb);
+        }
+
+        // reduction of the bins, in one call for the scalars
+        n = mpi::all_reduce(n, c);
+        if constexpr (std::is_arithmetic_v<T> or std::is_same_v<T, std::complex<double>>)
+          S = mpi::all_reduce(S, c);
+        else
+          for (auto &x : S) x = mpi::all_reduce(x, c); // in place for the arrays
+
+        T S_tot    = S[0];
+        long n_tot = n[0];
+        for (int b = 1; b < nb; ++b) {
+          S_tot += S[b];
+          n_tot += n[b];
+        }
+        std::vector<T> jack;
+        for (int b = 0; b < nb; ++b) {
+          if ((n[b] == 0) or (n[b] == n_tot))
+            TRIQS_RUNTIME_ERROR << "Distributed jackknife : too few measures (" << n_tot << ") for " << nb << " bins";
+          jack.push_back(T((S_tot - S[b]) / double(n_tot - n[b])));
+        }
+        return observable<T>(std::move(jack));
+      }
+    } // namespace detail
+
+    template <typename T> observable<T> eval(observable<T> const &obs, repl_by_mpi_jack const &info) { return detail::mpi_jackknife(obs, 1, info); }
+
+    /**
+     * Average and error bar of an observable, or of an expression of observables (e.g. A / sign), measured on all the nodes of c.
+     *
+     * Each node holds its own series (of the same size for all the observables of the expression).
+     * The series are binned locally in n_bins bins, and only the sums of the bins are reduced over c, not the series.
+     * The expression is then evaluated on the jackknife series of the bins of all the nodes.
+     * Collective : the result is the same on all the nodes.
+     */
+    template <typename ObservableExpr>
+    std::enable_if_t<clef::is_clef_expression<ObservableExpr>::value or is_time_series<ObservableExpr>::value,
+                     value_and_error_bar<get_value_type<ObservableExpr>>>
+    mpi_average_and_error(ObservableExpr const &obs, mpi::communicator c = {}, int n_bins = 64) {
+      get_size(obs); // check that the observables have the same size on this node
+      auto expr_jack = eval(obs, repl_by_mpi_jack{c, n_bins});
+      return empirical_average_and_error(make_immutable_time_series(expr_jack));
+    }
+
     /* *********************************************************
   *
   *  Auto-correlations
@@ -384,13 +461,100 @@ namespace triqs {
       return {std::forward<TimeSeries>(t)};
     }
 
+    // ------  All the lags of the autocorrelation, by FFT (Wiener-Khinchin) in O(N log N) --------------------
+
+    // Autocovariance of n series of length N, in place : x[i * n + s] is the element i of the series s.
+    // It is replaced by sum_{j=0}^{N-i-1} (x_{j+i} - avg)(x_j - avg), for all i. Implemented with fftw in statistics.cpp
+    void _autocovariance_fft(double *x, long N, long n);
+
+    namespace detail {
+
+      // The components of a value of a time series : a real number, or an array of real numbers
+      template <typename T> long n_components(T const &x) {
+        if constexpr (std::is_arithmetic_v<T>)
+          return 1;
+        else
+          return x.size();
+      }
+
+      template <typename T> void get_components(T const &x, double *out) {
+        if constexpr (std::is_arithmetic_v<T>)
+          *out = x;
+        else
+          for (auto const &v : x) *out++ = v;
+      }
+
+      template <typename T> void set_components(T &x, double const *in) {
+        if constexpr (std::is_arithmetic_v<T>)
+          x = *in;
+        else
+          for (auto &v : x) v = *in++;
+      }
+
+      // The normalized autocorrelation of the n components of t for all the lags, r[k * n + s]
+      template <typename TimeSeries> std::vector<double> normalized_autocorrelation_components(TimeSeries const &t, long &n) {
+        long N = t.size();
+        if (N < 2) TRIQS_RUNTIME_ERROR << "autocorrelation of a time series of size " << N;
+        n = n_components(t[0]);
+        std::vector<double> r(N * n);
+        for (long i = 0; i < N; ++i) get_components(t[i], r.data() + i * n);
+        _autocovariance_fft(r.data(), N, n);
+        for (long s = 0; s < n; ++s) {
+          double c0 = r[s];
+          for (long k = 0; k < N; ++k) r[k * n + s] *= N / ((N - k) * c0);
+        }
+        return r;
+      }
+    } // namespace detail
+
+    /// The normalized autocorrelation (as make_normalized_autocorrelation) for all the lags k = 0 ... N-1, in O(N log N)
+    template <typename TimeSeries> auto normalized_autocorrelation_fft(TimeSeries const &a) {
+      auto const &t = make_immutable_time_series(a);
+      using value_t = typename std::decay_t<decltype(t)>::value_type;
+      long n;
+      auto r = detail::normalized_autocorrelation_components(t, n);
+      std::vector<value_t> res(t.size(), t[0]);
+      for (long k = 0; k < long(t.size()); ++k) detail::set_components(res[k], r.data() + k * n);
+      return res;
+    }
+
+    // ------  Auto-correlation time with automatic windowing --------------------
+
+    /**
+     * Integrated autocorrelation time tau(W) = sum_{k=1}^{W} r_k from the normalized autocorrelation r_k (computed by FFT),
+     * with the automatic windowing of Madras and Sokal : W is the smallest lag with W >= c tau(W).
+     * Same convention as autocorrelation_time_from_binning : the error on the mean is multiplied by sqrt(1 + 2 tau).
+     * For an array valued series, the window is chosen for each component.
+     */
+    template <typename TimeSeries> auto autocorrelation_time_from_fft(TimeSeries const &a, double c = 6) {
+      auto const &t = make_immutable_time_series(a);
+      using value_t = typename std::decay_t<decltype(t)>::value_type;
+      long n, N = t.size();
+      auto r = detail::normalized_autocorrelation_components(t, n);
+      std::vector<double> tau(n, 0);
+      for (long s = 0; s < n; ++s) {
+        long W = 1;
+        for (; W < N; ++W) {
+          tau[s] += r[W * n + s];
+          if (W >= c * tau[s]) break;
+        }
+        if (W == N) TRIQS_RUNTIME_ERROR << "autocorrelation_time_from_fft : no window found, the series (size " << N << ") is too short";
+      }
+      value_t res = t[0];
+      detail::set_components(res, tau.data());
+      return res;
+    }
+
     // ------  Auto-correlation time from the computation of the autocorrelation --------------------
 
+    // All the lags are computed by FFT, although the sum stops at the window l_max ~ 6 t_int (usually << N) :
+    // the O(N log N) cost of the FFT does not depend on the number of lags used, and is below the O(N l_max) of a direct sum.
     template <typename TimeSeries> int autocorrelation_time(TimeSeries const &a) {
-      auto normalized_autocorr = make_normalized_autocorrelation(make_immutable_time_series(a)); // is a N*dim_f matrix...
-      double t_int             = normalized_autocorr[0];                                         // in principle, a vector dim_f
-      double coeff_tau         = 6;                                                              // if exponential decay -> 0.25 % precision
-      for (int l_max = 1; l_max < coeff_tau * t_int; l_max++) t_int += normalized_autocorr[l_max];
+      auto normalized_autocorr = normalized_autocorrelation_fft(a);
+      double t_int             = normalized_autocorr[0];            // in principle, a vector dim_f
+      double coeff_tau         = 6;                                 // if exponential decay -> 0.25 % precision
+      int size                 = normalized_autocorr.size();
+      for (int l_max = 1; (l_max < coeff_tau * t_int) and (l_max < size); l_max++) t_int += normalized_autocorr[l_max];
       return int(t_int);
     }
 
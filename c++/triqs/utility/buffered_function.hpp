@@ -19,12 +19,31 @@
 
 #pragma once
 #include "./first_include.hpp"
+#include "./exceptions.hpp"
 #include <vector>
 #include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
 
 namespace triqs {
   namespace utility {
 
+    namespace detail {
+      // The state of a function object f can be written with os << f and read with is >> f
+      template <typename F, typename = void> struct has_stream_state : std::false_type {};
+      template <typename F>
+      struct has_stream_state<F, std::void_t<decltype(std::declval<std::ostream &>() << std::declval<F const &>()),
+                                             decltype(std::declval<std::istream &>() >> std::declval<F &>())>> : std::true_type {};
+
+      // f.fill(first, n) writes the next n values of f in [first, first + n)
+      template <typename F, typename R, typename = void> struct has_fill : std::false_type {};
+      template <typename F, typename R>
+      struct has_fill<F, R, std::void_t<decltype(std::declval<F &>().fill(std::declval<R *>(), size_t()))>> : std::true_type {};
+    } // namespace detail
+
     /**
   * A simple buffer for a generator.
   * Given a function, it provides a buffer of this function
@@ -32,6 +51,12 @@ namespace triqs {
   *  - do not pay the indirection cost at each call, but once every size call.
   *  - erase the function type
   * It is a semi-regular type.
+  *
+  * If the function has a method fill(R *first, size_t n), which writes the next n values at once
+  * (e.g. with vectorized loops), it is used to refill the buffer.
+  *
+  * If the state of the function can be written and read with << and >> (e.g. a random generator),
+  * the state of the buffered function can be saved and restored, cf get_state, set_state.
   */
     template <typename R> struct buffered_function {
 
@@ -45,30 +70,83 @@ namespace triqs {
    * @param size : size of the buffer [optional]
    */
       template <typename Function> buffered_function(Function f, size_t size = 1000) : buffer(size) {
-        refill = [f](buffered_function *bf) mutable { // without the mutable, the () of the lambda object is const, hence f
-          for (auto &x : bf->buffer) x = f();
-          bf->index= 0;
+        // without the mutable, the () of the lambda object is const, hence f
+        impl = [f](buffered_function *bf, action a, std::string *state) mutable {
+          switch (a) {
+            case action::refill:
+              if constexpr (detail::has_fill<Function, R>::value)
+                f.fill(bf->buffer.data(), bf->buffer.size());
+              else
+                for (auto &x : bf->buffer) x = f();
+              bf->index = 0;
+              break;
+            case action::save:
+            case action::load:
+              if constexpr (detail::has_stream_state<Function>::value) {
+                if (a == action::save) {
+                  std::ostringstream os;
+                  os << f << '\n'; // some readers (e.g. boost engines) skip the whitespaces after the last number
+                  *state = os.str();
+                } else {
+                  std::istringstream is(*state);
+                  is >> f;
+                  if (is.fail()) TRIQS_RUNTIME_ERROR << "buffered_function : can not read the state of the function";
+                }
+              } else
+                TRIQS_RUNTIME_ERROR << "buffered_function : the state of this function can not be saved";
+          }
         };
-        refill(this); // first filling of the buffer
+        impl(this, action::refill, nullptr); // first filling of the buffer
       }
 
       /// Returns the next element. Refills the buffer if necessary.
       R operator()() {
-        if (index > buffer.size() - 1) refill(this);
+        if (index > buffer.size() - 1) impl(this, action::refill, nullptr);
         return buffer[index++];
       }
 
       /// Returns the future next element, without increasing the index. Refills the buffer if necessary.
       R preview() {
-        if (index > buffer.size() - 1) refill(this);
+        if (index > buffer.size() - 1) impl(this, action::refill, nullptr);
         return buffer[index];
       }
 
+      /**
+   * The state : the state of the function, and the elements of the buffer not yet returned.
+   * Restored with set_state, the buffered function returns exactly the same sequence.
+   */
+      std::string get_state() const {
+        std::string f_state;
+        impl(const_cast<buffered_function *>(this), action::save, &f_state); // NB : save does not modify the object
+        std::ostringstream os;
+        os << std::setprecision(std::numeric_limits<R>::max_digits10) << (buffer.size() - index) << ' ' << buffer.size();
+        for (size_t i = index; i < buffer.size(); ++i) os << ' ' << buffer[i];
+        os << '\n' << f_state;
+        return os.str();
+      }
+
+      /// Restore a state given by get_state. The function must be of the same type.
+      void set_state(std::string const &state) {
+        std::istringstream is(state);
+        size_t n_left = 0, size = 0;
+        is >> n_left >> size;
+        if (is.fail() or n_left > size) TRIQS_RUNTIME_ERROR << "buffered_function : invalid state";
+        buffer.resize(size);
+        index = size - n_left;
+        for (size_t i = index; i < size; ++i) is >> buffer[i];
+        if (is.fail()) TRIQS_RUNTIME_ERROR << "buffered_function : invalid state";
+        is.ignore(1); // the newline
+        std::string f_state{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+        impl(this, action::load, &f_state);
+      }
+
       private:
+      enum class action { refill, save, load };
       size_t index;
       std::vector<R> buffer;
-      std::function<void(buffered_function *)> refill; // this refills the buffer and reset index of a buffered_function.
-                                                       // NB : cannot capture this in refill because we want the object to be copyable and movable
+      // refills the buffer and reset index of a buffered_function, or saves/loads the state of the function.
+      // NB : cannot capture this in impl because we want the object to be copyable and movable
+      std::function<void(buffered_function *, action, std::string *)> impl;
     };
   } // namespace utility
 } // namespace triqs
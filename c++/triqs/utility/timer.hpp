@@ -44,6 +44,8 @@ namespace triqs {
         running = false;
       }
       bool is_running() const { return running; }
+      /// Add a time measured elsewhere, e.g. in a previous run restored from a checkpoint
+      void add(double seconds) { total_time += std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(seconds)); }
       operator double() const {
         std::chrono::duration<double> total_time_seconds(total_time);
         if (is_running()) total_time_seconds += clock_t::now() - start_time;
@@ -22,6 +22,7 @@
 
 #include <iomanip>
 #include <chrono>
+#include <cstdint>
 #include <sstream>
 
 namespace triqs {
@@ -46,8 +47,8 @@ namespace triqs {
       return os.str();
     }
 
-    std::string inline estimate_time_left(int Ntot, int iter, timer &Timer) {
-      double eta = (Ntot - 1 - iter) * double(Timer) / (iter + 1);
+    std::string inline estimate_time_left(uint64_t Ntot, uint64_t iter, timer &Timer) {
+      double eta = (double(Ntot) - 1 - double(iter)) * double(Timer) / (double(iter) + 1);
       return hours_minutes_seconds_from_seconds(eta);
     }
 
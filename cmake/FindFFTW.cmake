@@ -9,6 +9,7 @@
 #
 # This module looks for fftw.
 # It sets up : FFTW_INCLUDE_DIR, FFTW_LIBRARIES
+# and, if the threaded fftw library is found, FFTW_THREADS_LIBRARY
 # Use FFTW3_ROOT to specify a particular location
 #
 
@@ -56,13 +57,38 @@ find_library(FFTW_LIBRARIES
   DOC "FFTW library"
 )
 
+find_library(FFTW_THREADS_LIBRARY
+  NAMES fftw3_threads
+  PATHS
+    ${FFTW_INCLUDE_DIR}/../lib
+    ${FFTW3_ROOT}/lib
+    ${FFTW_ROOT}/lib
+    $ENV{FFTW3_ROOT}/lib
+    $ENV{FFTW_ROOT}/lib
+    $ENV{FFTW3_BASE}/lib
+    $ENV{FFTW_BASE}/lib
+    ENV LIBRARY_PATH
+    ENV LD_LIBRARY_PATH
+    /usr/lib
+    /usr/local/lib
+    /opt/local/lib
+    /sw/lib
+  DOC "FFTW threads library (optional)"
+)
+
 include(FindPackageHandleStandardArgs)
 FIND_PACKAGE_HANDLE_STANDARD_ARGS(FFTW DEFAULT_MSG FFTW_LIBRARIES FFTW_INCLUDE_DIR)
 
-mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARIES)
+mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARIES FFTW_THREADS_LIBRARY)
 
 # Interface target
 # We refrain from creating an imported target since those cannot be exported
 add_library(fftw INTERFACE)
+if(FFTW_THREADS_LIBRARY)
+  # The threads library has to precede the serial one
+  message(STATUS "FFTW threads library: ${FFTW_THREADS_LIBRARY}")
+  target_link_libraries(fftw INTERFACE ${FFTW_THREADS_LIBRARY})
+  target_compile_definitions(fftw INTERFACE TRIQS_FFTW_THREADS)
+endif()
 target_link_libraries(fftw INTERFACE ${FFTW_LIBRARIES})
 target_include_directories(fftw SYSTEM INTERFACE ${FFTW_INCLUDE_DIR})
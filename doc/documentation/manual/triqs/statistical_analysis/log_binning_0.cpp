@@ -0,0 +1,13 @@
+#include <triqs/statistics.hpp>
+using namespace triqs::statistics;
+int main() {
+  log_binning<double> A, B;
+  for (int i = 0; i < 100000; ++i) {
+    A << std::cos(i * 0.01);
+    B << 2.;
+  }
+  std::cout << A.mean() << " +/- " << A.error(8) << std::endl;
+  std::cout << "autocorrelation time : " << A.autocorrelation_time() << std::endl;
+  std::cout << average_and_error(A / B) << std::endl;
+  return 0;
+}
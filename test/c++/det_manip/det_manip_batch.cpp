@@ -0,0 +1,112 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+using d_t = triqs::det_manip::det_manip<fun>;
+
+// The batch ratios are the ones of the individual try, and a candidate chosen in the batch
+// is completed as if it had been tried alone.
+TEST(DetManipBatch, Insert) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+
+  auto d  = d_t{fun{}, 100};
+  auto d2 = d_t{fun{}, 100};
+
+  for (int n = 0; n < 30; ++n) {
+    long N = d.size();
+    auto i = std::uniform_int_distribution<long>(0, N)(gen), j = std::uniform_int_distribution<long>(0, N)(gen);
+    std::vector<double> X(8), Y(8);
+    for (int k = 0; k < 8; ++k) {
+      X[k] = dis(gen);
+      Y[k] = dis(gen);
+    }
+
+    auto ratios = d.try_insert_batch(i, j, X, Y);
+    EXPECT_EQ(ratios.size(), 8);
+
+    // Choose the candidate with the largest ratio
+    int k_max = 0;
+    for (int k = 0; k < 8; ++k) {
+      auto r = d2.try_insert(i, j, X[k], Y[k]);
+      d2.reject_last_try();
+      EXPECT_NEAR(ratios(k), r, 1.e-12 * std::max(1.0, std::abs(r)));
+      if (std::abs(ratios(k)) > std::abs(ratios(k_max))) k_max = k;
+    }
+
+    auto r = d.try_insert_from_batch(k_max);
+    EXPECT_EQ(r, ratios(k_max));
+    d.complete_operation();
+    d2.insert(i, j, X[k_max], Y[k_max]);
+    EXPECT_ARRAY_NEAR(d.inverse_matrix(), d2.inverse_matrix(), 1.e-10);
+    EXPECT_NEAR(d.determinant(), d2.determinant(), 1.e-10 * std::abs(d2.determinant()));
+  }
+}
+
+TEST(DetManipBatch, ChangeCol) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+
+  std::vector<double> X0(10), Y0(10);
+  for (int k = 0; k < 10; ++k) {
+    X0[k] = dis(gen);
+    Y0[k] = dis(gen);
+  }
+  auto d  = d_t{fun{}, X0, Y0};
+  auto d2 = d_t{fun{}, X0, Y0};
+
+  for (int n = 0; n < 20; ++n) {
+    auto j = std::uniform_int_distribution<long>(0, d.size() - 1)(gen);
+    std::vector<double> Y(5);
+    for (auto &y : Y) y = dis(gen);
+
+    auto ratios = d.try_change_col_batch(j, Y);
+    int k_max   = 0;
+    for (int k = 0; k < 5; ++k) {
+      auto r = d2.try_change_col(j, Y[k]);
+      d2.reject_last_try();
+      EXPECT_NEAR(ratios(k), r, 1.e-12 * std::max(1.0, std::abs(r)));
+      if (std::abs(ratios(k)) > std::abs(ratios(k_max))) k_max = k;
+    }
+
+    d.try_change_col_from_batch(k_max);
+    d.complete_operation();
+    d2.try_change_col(j, Y[k_max]);
+    d2.complete_operation();
+    EXPECT_ARRAY_NEAR(d.inverse_matrix(), d2.inverse_matrix(), 1.e-10);
+  }
+}
+
+MAKE_MAIN;
@@ -0,0 +1,147 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+using d_t = triqs::det_manip::det_manip<fun>;
+
+// The tolerance of the agreement with the immediate updates, stated in the doc of set_n_delayed_updates.
+// Relative for the ratios and the determinant, absolute for the elements of the inverse.
+const double tol = 1.e-10;
+
+// Run the same random sequence of try, complete and reject on a det_manip with immediate updates
+// and one with delayed updates of rank k, and compare the ratios, the determinants, their signs and the inverse matrices.
+void test_delayed(size_t k) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+  auto rnd = [&gen](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); };
+
+  auto d  = d_t{fun{}, 100};
+  auto dd = d_t{fun{}, 100};
+  dd.set_n_delayed_updates(k);
+  EXPECT_EQ(dd.get_n_delayed_updates(), k);
+
+  for (int n = 0; n < 2000; ++n) {
+    size_t N = d.size();
+    double r = 0, rd = 0;
+    switch (rnd(7)) {
+      case 0: {
+        if (N > 30) continue;
+        auto i = rnd(N + 1), j = rnd(N + 1);
+        auto x = dis(gen), y = dis(gen);
+        r  = d.try_insert(i, j, x, y);
+        rd = dd.try_insert(i, j, x, y);
+        break;
+      }
+      case 1: {
+        if (N > 30) continue;
+        auto i0 = rnd(N + 1), j0 = rnd(N + 1), i1 = rnd(N + 2), j1 = rnd(N + 2);
+        if (i0 == i1 or j0 == j1) continue;
+        auto x0 = dis(gen), x1 = dis(gen), y0 = dis(gen), y1 = dis(gen);
+        r  = d.try_insert2(i0, i1, j0, j1, x0, x1, y0, y1);
+        rd = dd.try_insert2(i0, i1, j0, j1, x0, x1, y0, y1);
+        break;
+      }
+      case 2: {
+        if (N < 1) continue;
+        auto i = rnd(N), j = rnd(N);
+        r  = d.try_remove(i, j);
+        rd = dd.try_remove(i, j);
+        break;
+      }
+      case 3: {
+        if (N < 2) continue;
+        auto i0 = rnd(N), j0 = rnd(N), i1 = rnd(N), j1 = rnd(N);
+        if (i0 == i1 or j0 == j1) continue;
+        r  = d.try_remove2(i0, i1, j0, j1);
+        rd = dd.try_remove2(i0, i1, j0, j1);
+        break;
+      }
+      case 4: {
+        if (N < 1) continue;
+        auto j = rnd(N);
+        auto y = dis(gen);
+        r      = d.try_change_col(j, y);
+        rd     = dd.try_change_col(j, y);
+        break;
+      }
+      case 5: {
+        if (N < 1) continue;
+        auto i = rnd(N);
+        auto x = dis(gen);
+        r      = d.try_change_row(i, x);
+        rd     = dd.try_change_row(i, x);
+        break;
+      }
+      case 6: {
+        if (N < 1) continue;
+        auto i = rnd(N), j = rnd(N);
+        auto x = dis(gen), y = dis(gen);
+        r  = d.try_change_col_row(i, j, x, y);
+        rd = dd.try_change_col_row(i, j, x, y);
+        break;
+      }
+    }
+
+    EXPECT_NEAR(r, rd, tol * std::max(1.0, std::abs(r)));
+
+    // Accept the moves which keep the matrix well conditioned
+    if (std::abs(r) > 0.1 and std::abs(r) < 10) {
+      d.complete_operation();
+      dd.complete_operation();
+    } else {
+      d.reject_last_try();
+      dd.reject_last_try();
+    }
+
+    if (n % 100 == 0 and d.size() > 0) {
+      EXPECT_EQ(d.size(), dd.size());
+      EXPECT_NEAR(d.inverse_matrix(0, 0), dd.inverse_matrix(0, 0), tol);
+      EXPECT_ARRAY_NEAR(d.inverse_matrix(), dd.inverse_matrix(), tol);
+      // the const access does not apply the pending updates, it adds them to a copy
+      d_t const &cdd = dd;
+      EXPECT_ARRAY_NEAR(d.inverse_matrix_internal_order(), cdd.inverse_matrix_internal_order(), tol);
+      double det = d.determinant(), ddet = dd.determinant();
+      EXPECT_EQ(det > 0, ddet > 0);
+      EXPECT_NEAR(det, ddet, tol * std::abs(det));
+    }
+  }
+  EXPECT_ARRAY_NEAR(d.inverse_matrix(), dd.inverse_matrix(), tol);
+  EXPECT_NEAR(d.determinant(), dd.determinant(), tol * std::abs(d.determinant()));
+}
+
+TEST(DetManipDelayed, Rank1) { test_delayed(1); }
+TEST(DetManipDelayed, Rank8) { test_delayed(8); }
+
+MAKE_MAIN;
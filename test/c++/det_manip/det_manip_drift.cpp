@@ -0,0 +1,84 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+using d_t = triqs::det_manip::det_manip<fun>;
+
+// Insertions, removals and changes of columns, accepted if the ratio is not too small
+void run(d_t &d, int n_steps) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+  auto rnd = [&gen](long n) { return std::uniform_int_distribution<long>(0, n - 1)(gen); };
+  for (int n = 0; n < n_steps; ++n) {
+    long N   = d.size();
+    double r = 0;
+    if (N < 10 or (N < 30 and n % 3 == 0))
+      r = d.try_insert(rnd(N + 1), rnd(N + 1), dis(gen), dis(gen));
+    else if (n % 3 == 1)
+      r = d.try_remove(rnd(N), rnd(N));
+    else
+      r = d.try_change_col(rnd(N), dis(gen));
+    if (std::abs(r) > 0.1)
+      d.complete_operation();
+    else
+      d.reject_last_try();
+  }
+}
+
+TEST(DetManipDrift, Adaptive) {
+  auto d_fixed = d_t{fun{}, 100};
+  run(d_fixed, 5000);
+  EXPECT_EQ(d_fixed.get_drift_stats().n_checks, 0);
+  EXPECT_GT(d_fixed.get_drift_stats().n_regenerations, 10);
+
+  auto d = d_t{fun{}, 100};
+  d.set_drift_tolerance(1.e-9);
+  EXPECT_EQ(d.get_drift_tolerance(), 1.e-9);
+  run(d, 5000);
+
+  // Same moves, far less regenerations
+  auto const &stats = d.get_drift_stats();
+  EXPECT_GT(stats.n_checks, 0);
+  EXPECT_LT(stats.n_regenerations, d_fixed.get_drift_stats().n_regenerations);
+  EXPECT_GE(stats.max_drift, stats.last_drift);
+
+  // The inverse is still accurate
+  EXPECT_EQ(d.size(), d_fixed.size());
+  triqs::arrays::matrix<double> Minv = inverse(d.matrix());
+  EXPECT_ARRAY_NEAR(d.inverse_matrix(), Minv, 1.e-7);
+  EXPECT_ARRAY_NEAR(d.inverse_matrix(), d_fixed.inverse_matrix(), 1.e-7);
+}
+
+MAKE_MAIN;
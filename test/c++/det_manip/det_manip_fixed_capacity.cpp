@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <random>
+
+// Count the allocations through operator new in this program
+static long n_new = 0;
+void *operator new(std::size_t s) {
+  ++n_new;
+  if (void *p = std::malloc(s)) return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+using d_t = triqs::det_manip::det_manip<fun>;
+
+// Random moves, accepted if the ratio is not too small
+void run(d_t &d, std::mt19937 &gen, int n_steps) {
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+  auto rnd = [&gen](long n) { return std::uniform_int_distribution<long>(0, n - 1)(gen); };
+  for (int n = 0; n < n_steps; ++n) {
+    long N   = d.size();
+    double r = 0;
+    switch (n % 7) {
+      case 0:
+        if (N > 15) continue;
+        r = d.try_insert(rnd(N + 1), rnd(N + 1), dis(gen), dis(gen));
+        break;
+      case 1:
+        if (N > 15) continue;
+        r = d.try_insert2(0, N + 1, 0, N + 1, dis(gen), dis(gen), dis(gen), dis(gen));
+        break;
+      case 2:
+        if (N < 1) continue;
+        r = d.try_remove(rnd(N), rnd(N));
+        break;
+      case 3:
+        if (N < 2) continue;
+        r = d.try_remove2(0, N - 1, 0, N - 1);
+        break;
+      case 4:
+        if (N < 1) continue;
+        r = d.try_change_col(rnd(N), dis(gen));
+        break;
+      case 5:
+        if (N < 1) continue;
+        r = d.try_change_row(rnd(N), dis(gen));
+        break;
+      case 6:
+        if (N < 1) continue;
+        r = d.try_change_col_row(rnd(N), rnd(N), dis(gen), dis(gen));
+        break;
+    }
+    if (std::abs(r) > 0.1)
+      d.complete_operation();
+    else
+      d.reject_last_try();
+  }
+}
+
+TEST(DetManipFixedCapacity, NoAllocation) {
+  std::mt19937 gen(23432);
+  auto d = d_t{fun{}, 4};
+  d.set_fixed_capacity(20);
+
+  run(d, gen, 200); // warm up
+  auto p = d.inverse_matrix_internal_order().data_start();
+
+  // with the default period of the checks, which regenerate the inverse
+  long n0   = n_new;
+  auto n_rg = d.get_drift_stats().n_regenerations;
+  run(d, gen, 2000);
+  double s = 0;
+  for (auto const &x : d.get_x_view()) s += x;
+  EXPECT_EQ(n_new, n0);
+  EXPECT_GT(d.get_drift_stats().n_regenerations, n_rg);
+  EXPECT_EQ(d.inverse_matrix_internal_order().data_start(), p);
+
+  // The views are the ones of get_x, get_y, without copy
+  auto X = d.get_x(), Y = d.get_y();
+  auto vx = d.get_x_view(), vy = d.get_y_view();
+  ASSERT_EQ(vx.size(), X.size());
+  for (size_t i = 0; i < X.size(); ++i) {
+    EXPECT_EQ(vx[i], X[i]);
+    EXPECT_EQ(vy[i], Y[i]);
+  }
+  EXPECT_NEAR(s, std::accumulate(X.begin(), X.end(), 0.0), 1.e-12);
+}
+
+TEST(DetManipFixedCapacity, Overflow) {
+  auto d = d_t{fun{}, 2};
+  d.set_fixed_capacity(3);
+  for (int i = 0; i < 3; ++i) d.insert(i, i, 3.3 * i, 0.1 + 3.3 * i);
+  EXPECT_THROW(d.try_insert(0, 0, 1.0, 2.0), triqs::runtime_error);
+}
+
+MAKE_MAIN;
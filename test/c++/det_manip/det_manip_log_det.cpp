@@ -0,0 +1,108 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+// Large diagonal : the determinant of a 200 x 200 matrix overflows a double
+struct fun_large {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const { return (x == y ? 1.e5 : 1 / (1 + std::abs(x - y))); }
+};
+
+using triqs::det_manip::det_manip;
+
+TEST(DetManipLogDet, SameRatios) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+
+  auto d  = det_manip<fun>{fun{}, 100};
+  auto dl = det_manip<fun, true>{fun{}, 100};
+
+  for (int n = 0; n < 500; ++n) {
+    size_t N = d.size();
+    double r, rl;
+    if (N < 2 or (N < 20 and n % 3 != 0)) {
+      auto i = std::uniform_int_distribution<size_t>(0, N)(gen), j = std::uniform_int_distribution<size_t>(0, N)(gen);
+      auto x = dis(gen), y = dis(gen);
+      r  = d.try_insert(i, j, x, y);
+      rl = dl.try_insert(i, j, x, y);
+    } else {
+      auto i = std::uniform_int_distribution<size_t>(0, N - 1)(gen), j = std::uniform_int_distribution<size_t>(0, N - 1)(gen);
+      r  = d.try_remove(i, j);
+      rl = dl.try_remove(i, j);
+    }
+    EXPECT_NEAR(r, rl, 1.e-12 * std::max(1.0, std::abs(r)));
+    if (std::abs(r) > 0.1) {
+      d.complete_operation();
+      dl.complete_operation();
+    } else {
+      d.reject_last_try();
+      dl.reject_last_try();
+    }
+    auto det = d.determinant();
+    EXPECT_NEAR(det, dl.determinant().value(), 1.e-10 * std::abs(det));
+  }
+
+  // The refill ratio is computed from the logs
+  std::vector<double> X{1, 2.5, 4}, Y{0.5, 3, 7};
+  auto r  = d.try_refill(X, Y);
+  auto rl = dl.try_refill(X, Y);
+  EXPECT_NEAR(r, rl, 1.e-10 * std::abs(r));
+  d.complete_operation();
+  dl.complete_operation();
+  EXPECT_NEAR(d.determinant(), dl.determinant().value(), 1.e-10 * std::abs(d.determinant()));
+}
+
+TEST(DetManipLogDet, Overflow) {
+  int N = 200;
+  std::vector<double> X(N);
+  for (int i = 0; i < N; ++i) X[i] = i;
+
+  auto dl = det_manip<fun_large, true>{fun_large{}, X, X};
+  auto det = dl.determinant();
+  EXPECT_NEAR(det.log_abs(), N * std::log(1.e5), 1.e-3);
+  EXPECT_EQ(det.phase(), 1.0);
+
+  // A move on such a matrix, and the determinant after a regeneration
+  auto r = dl.try_change_col(3, 0.5);
+  dl.complete_operation();
+  EXPECT_NEAR(dl.determinant().log_abs(), det.log_abs() + std::log(std::abs(r)), 1.e-8);
+  dl.regenerate();
+  EXPECT_NEAR(dl.determinant().log_abs(), det.log_abs() + std::log(std::abs(r)), 1.e-8);
+}
+
+MAKE_MAIN;
@@ -0,0 +1,98 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+using d_t = triqs::det_manip::det_manip<fun>;
+
+// The det of the matrix built from the sorted x, y
+double sorted_det(std::vector<double> X, std::vector<double> Y) {
+  std::sort(X.begin(), X.end());
+  std::sort(Y.begin(), Y.end());
+  return d_t{fun{}, X, Y}.determinant();
+}
+
+void check_sorted(d_t &d) {
+  auto X = d.get_x(), Y = d.get_y();
+  EXPECT_TRUE(std::is_sorted(X.begin(), X.end()));
+  EXPECT_TRUE(std::is_sorted(Y.begin(), Y.end()));
+  EXPECT_NEAR(d.determinant(), sorted_det(X, Y), 1.e-10 * std::abs(d.determinant()));
+}
+
+TEST(DetManipSorted, InsertAndShift) {
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> dis(0.0, 10.0);
+  auto d = d_t{fun{}, 100};
+
+  for (int n = 0; n < 12; ++n) {
+    double x = dis(gen), y = dis(gen);
+    auto X   = d.get_x();
+    EXPECT_EQ(d.row_position(x), std::lower_bound(X.begin(), X.end(), x) - X.begin());
+    auto r = d.try_insert_sorted(x, y);
+    d.complete_operation();
+    EXPECT_NE(r, 0);
+    check_sorted(d);
+  }
+
+  // Shift of rows, cols, and both : the ratio is the one of the sorted matrices
+  for (int n = 0; n < 30; ++n) {
+    long N   = d.size();
+    auto i   = std::uniform_int_distribution<long>(0, N - 1)(gen);
+    auto j   = std::uniform_int_distribution<long>(0, N - 1)(gen);
+    double x = dis(gen), y = dis(gen);
+    auto X = d.get_x(), Y = d.get_y();
+    double det = d.determinant();
+    double r   = 0;
+    switch (n % 3) {
+      case 0:
+        r    = d.try_shift_row(i, x);
+        X[i] = x;
+        break;
+      case 1:
+        r    = d.try_shift_col(j, y);
+        Y[j] = y;
+        break;
+      case 2:
+        r    = d.try_shift_col_row(i, j, x, y);
+        X[i] = x;
+        Y[j] = y;
+        break;
+    }
+    EXPECT_NEAR(r, sorted_det(X, Y) / det, 1.e-8 * std::max(1.0, std::abs(r)));
+    d.complete_operation();
+    check_sorted(d);
+  }
+}
+
+MAKE_MAIN;
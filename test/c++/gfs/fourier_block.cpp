@@ -19,6 +19,7 @@
 
 #include <triqs/gfs.hpp>
 #include <triqs/test_tools/gfs.hpp>
+#include <random>
 using namespace triqs::gfs;
 
 template <int TARGET_RANK> void test_fourier() {
@@ -98,6 +99,54 @@ template <int TARGET_RANK> void test_fourier() {
   EXPECT_BLOCK2_GF_NEAR(block2_giw, block2_giw_2, precision);
 }
 
+// Blocks with identical meshes are transformed together : compare with the transform of each block
+TEST(FourierBlock, Batched) {
+  triqs::clef::placeholder<0> iw_;
+  double beta = 10;
+  auto m1     = gf_mesh<imfreq>{beta, Fermion, 100};
+  auto m2     = gf_mesh<imfreq>{beta, Fermion, 150};
+
+  std::vector<gf<imfreq, matrix_valued>> giw_vec = {{m1, {2, 2}}, {m2, {2, 2}}, {m1, {2, 2}}, {m1, {2, 2}}};
+  for (int b : range(4)) giw_vec[b](iw_) << 1.0 / (iw_ - b + 1.5) + 0.5 / (iw_ + b);
+  auto block_giw = make_block_gf({"0", "1", "2", "3"}, giw_vec);
+
+  // One plan per group of blocks with identical meshes
+  clear_fourier_plan_cache();
+  auto block_gtau = make_gf_from_fourier(block_giw);
+  EXPECT_EQ(fourier_plan_cache_size(), 2);
+  for (int b : range(4)) EXPECT_GF_NEAR(block_gtau[b], make_gf_from_fourier(giw_vec[b]), 1e-12);
+
+  // Common output mesh and known moments for each block
+  std::vector<array<dcomplex, 3>> known_moments;
+  for (int b : range(4)) {
+    known_moments.push_back(make_zero_tail(giw_vec[b], 2));
+    for (int i : range(2)) known_moments[b](1, i, i) = 1.5;
+  }
+  auto block_giw_2 = make_gf_from_fourier(block_gtau, m1, known_moments);
+  for (int b : range(4)) EXPECT_GF_NEAR(block_giw_2[b], make_gf_from_fourier(block_gtau[b], m1, known_moments[b]), 1e-12);
+}
+
+// The tail of each block is fitted on its own data : a noisy block does not change the transform of the others
+TEST(FourierBlock, BatchedNoisyBlock) {
+  triqs::clef::placeholder<0> iw_;
+  double beta = 10;
+  auto m      = gf_mesh<imfreq>{beta, Fermion, 100};
+
+  std::vector<gf<imfreq, matrix_valued>> giw_vec = {{m, {2, 2}}, {m, {2, 2}}};
+  for (int b : range(2)) giw_vec[b](iw_) << 1.0 / (iw_ - b + 1.5) + 0.5 / (iw_ + b);
+  auto block_gtau = make_gf_from_fourier(make_block_gf({"noisy", "clean"}, giw_vec));
+
+  std::mt19937 rng(23);
+  std::uniform_real_distribution<double> noise(-1e-3, 1e-3);
+  auto &dat = block_gtau[0].data();
+  for (int k : range(first_dim(dat)))
+    for (int i : range(2))
+      for (int j : range(2)) dat(k, i, j) += noise(rng);
+
+  auto block_giw = make_gf_from_fourier(block_gtau);
+  for (int b : range(2)) EXPECT_GF_NEAR(block_giw[b], make_gf_from_fourier(block_gtau[b]), 1e-12);
+}
+
 TEST(FourierBlock, Scalar) { test_fourier<0>(); }
 TEST(FourierBlock, Matrix) { test_fourier<2>(); }
 TEST(FourierBlock, Tensor3) { test_fourier<3>(); }
@@ -57,6 +57,16 @@ template <int TARGET_RANK> void test_fourier() {
   auto Gr2b = make_gf_from_fourier(Gk2);
   EXPECT_GF_NEAR(Gk1, Gk2, precision);
   EXPECT_GF_NEAR(Grb, Gr2b, precision);
+
+  // Real-valued input
+  using target_real_t = typename _target_from_type_rank<double, TARGET_RANK>::type;
+  for (int n_k : {2, 5}) {
+    auto Gr_real = gf<cyclic_lattice, target_real_t>{{bl, n_k}, shape};
+    Gr_real(r_) << exp(-r_(0)) + 0.5 * r_(1);
+    auto Gr_cplx = gf<cyclic_lattice, target_t>{{bl, n_k}, shape};
+    Gr_cplx(r_) << exp(-r_(0)) + 0.5 * r_(1);
+    EXPECT_GF_NEAR(make_gf_from_fourier(Gr_real), make_gf_from_fourier(Gr_cplx), precision);
+  }
 }
 
 TEST(FourierLattice, Scalar) { test_fourier<0>(); }
@@ -95,6 +95,12 @@ template <int TARGET_RANK> void test_fourier(statistic_enum statistic) {
   Gw1b() = fourier(Gt1_real);
   EXPECT_GF_NEAR(Gw1, Gw1b, precision);
 
+  // Same with an even number of tau intervals
+  auto Gt1_real_even = gf<imtime, target_real_t>{{beta, statistic, N_tau + 1}, shape};
+  for (auto const &t : Gt1_real_even.mesh()) { Gt1_real_even[t] = one_pole(E, t) + one_pole(-2 * E, t) - 4.5 * one_pole(1.25 * E, t); }
+  Gw1b() = fourier(Gt1_real_even);
+  EXPECT_GF_NEAR(Gw1, Gw1b, precision);
+
   // === Test Green function with a self-energy ===
 
   auto Sigma = Gw1;
@@ -0,0 +1,124 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/gfs.hpp>
+#include <atomic>
+#include <thread>
+
+TEST(FourierPlanCache, Reuse) {
+  triqs::clef::placeholder<0> iw_;
+  double beta = 10;
+  int N_iw    = 100;
+  int N_tau   = 6 * N_iw + 1;
+
+  auto Gw = gf<imfreq>{{beta, Fermion, N_iw}, {2, 2}};
+  Gw(iw_) << 1 / (iw_ - 1) + 1 / (iw_ + 2);
+
+  clear_fourier_plan_cache();
+  EXPECT_EQ(fourier_plan_cache_size(), 0);
+
+  auto Gt = make_gf_from_fourier(Gw, N_tau);
+  auto n  = fourier_plan_cache_size();
+  EXPECT_GT(n, 0);
+
+  // Same geometry : no new plan
+  for (int i : range(5)) Gt = make_gf_from_fourier(Gw, N_tau);
+  EXPECT_EQ(fourier_plan_cache_size(), n);
+
+  // The tables of the tail model are cleared with the plans, and recomputed
+  auto Gw2 = make_gf_from_fourier(Gt, N_iw);
+  clear_fourier_plan_cache();
+  EXPECT_GF_NEAR(Gt, make_gf_from_fourier(Gw, N_tau), 1e-14);
+  EXPECT_GF_NEAR(Gw2, make_gf_from_fourier(Gt, N_iw), 1e-14);
+
+  // Measured plans give the same result
+  set_fourier_plan_rigor(fourier_plan_rigor::measure);
+  EXPECT_EQ(get_fourier_plan_rigor(), fourier_plan_rigor::measure);
+  auto Gt_measure = make_gf_from_fourier(Gw, N_tau);
+  EXPECT_GF_NEAR(Gt, Gt_measure, 1e-12);
+  EXPECT_GT(fourier_plan_cache_size(), n);
+  set_fourier_plan_rigor(fourier_plan_rigor::estimate);
+
+  // Wisdom round trip
+  export_fourier_wisdom("fourier_plan_cache.wisdom");
+  clear_fourier_plan_cache();
+  EXPECT_TRUE(import_fourier_wisdom("fourier_plan_cache.wisdom"));
+  EXPECT_FALSE(import_fourier_wisdom("non_existing_file.wisdom"));
+}
+
+TEST(FourierPlanCache, Threads) {
+  triqs::clef::placeholder<0> iw_;
+  triqs::clef::placeholder<1> w_;
+  double beta = 10;
+  int N_iw    = 100;
+  int N_tau   = 6 * N_iw + 1;
+
+  auto Gw = gf<imfreq>{{beta, Fermion, N_iw}, {2, 2}};
+  Gw(iw_) << 1 / (iw_ - 1) + 1 / (iw_ + 2);
+  auto Gw_real = gf<refreq>{{-10, 10, 1001}, {1, 1}};
+  Gw_real(w_) << 1 / (w_ + 0.5i);
+
+  auto Gt      = make_gf_from_fourier(Gw, N_tau);
+  auto Gw2     = make_gf_from_fourier(Gt, N_iw);
+  auto Gt_real = make_gf_from_fourier(Gw_real);
+
+  EXPECT_EQ(get_fourier_n_threads(), 1);
+  {
+    auto _ = fourier_n_threads_guard{3};
+    EXPECT_EQ(get_fourier_n_threads(), 3);
+    EXPECT_GF_NEAR(Gt, make_gf_from_fourier(Gw, N_tau), 1e-12);
+    EXPECT_GF_NEAR(Gw2, make_gf_from_fourier(Gt, N_iw), 1e-12);
+    EXPECT_GF_NEAR(Gt_real, make_gf_from_fourier(Gw_real), 1e-12);
+
+    // the small transforms above run on one thread, this one is large enough to be split
+    auto Gw_large = gf<imfreq>{{beta, Fermion, 2000}, {4, 4}};
+    Gw_large(iw_) << 1 / (iw_ - 1) + 1 / (iw_ + 2);
+    auto Gt_large = make_gf_from_fourier(Gw_large);
+    {
+      auto _1 = fourier_n_threads_guard{1};
+      EXPECT_GF_NEAR(Gt_large, make_gf_from_fourier(Gw_large), 1e-12);
+    }
+  }
+  EXPECT_EQ(get_fourier_n_threads(), 1);
+
+  set_fourier_n_threads(0);
+  EXPECT_GE(get_fourier_n_threads(), 1);
+  EXPECT_GF_NEAR(Gt, make_gf_from_fourier(Gw, N_tau), 1e-12);
+  set_fourier_n_threads(1);
+
+  EXPECT_THROW(set_fourier_n_threads(-1), triqs::runtime_error);
+}
+
+TEST(FourierPlanCache, ClearWhileRunning) {
+  triqs::clef::placeholder<0> iw_;
+  double beta = 10;
+  int N_iw    = 100;
+  int N_tau   = 6 * N_iw + 1;
+
+  auto Gw = gf<imfreq>{{beta, Fermion, N_iw}, {2, 2}};
+  Gw(iw_) << 1 / (iw_ - 1) + 1 / (iw_ + 2);
+  auto Gt = make_gf_from_fourier(Gw, N_tau);
+
+  // the plans executed by the transforms of this thread are destroyed by the other one only when they are done
+  std::atomic<bool> stop = false;
+  std::thread clearer([&stop]() {
+    while (not stop) clear_fourier_plan_cache();
+  });
+  for (int i : range(200)) EXPECT_GF_NEAR(Gt, make_gf_from_fourier(Gw, N_tau), 1e-14);
+  stop = true;
+  clearer.join();
+}
+
+MAKE_MAIN;
@@ -0,0 +1,99 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/gfs.hpp>
+
+// Green function with poles in [-omega_max, omega_max] : compare the transforms with the exact result
+void test_sparse_fourier(statistic_enum statistic) {
+  double precision = 1e-8;
+  triqs::clef::placeholder<0> iw_;
+  double beta      = 100;
+  double omega_max = 10;
+  int N_tau        = 2001;
+  std::vector<double> E = {-1, 2.5, -7.3};
+
+  auto iw_mesh  = gf_mesh<sparse_imfreq>{beta, statistic, beta * omega_max, 1e-12};
+  auto tau_mesh = gf_mesh<imtime>{beta, statistic, N_tau};
+  EXPECT_LT(iw_mesh.size(), 100);
+  EXPECT_EQ(iw_mesh.size(), iw_mesh.basis().rank());
+
+  auto Gw = gf<sparse_imfreq, matrix_valued>{iw_mesh, {2, 2}};
+  Gw(iw_) << 1 / (iw_ - E[0]) + 0.5 / (iw_ - E[1]) + 2 / (iw_ - E[2]);
+
+  // Exact G(tau)
+  auto Gt_exact = gf<imtime, matrix_valued>{tau_mesh, {2, 2}};
+  double s      = (statistic == Fermion ? -1 : 1);
+  auto one_pole = [&](double E, double t) {
+    if (E > 0)
+      return -exp(-E * t) / (1 - s * exp(-E * beta));
+    else
+      return s * exp(E * (beta - t)) / (1 - s * exp(E * beta));
+  };
+  for (auto const &t : tau_mesh) Gt_exact[t] = one_pole(E[0], t) + 0.5 * one_pole(E[1], t) + 2 * one_pole(E[2], t);
+
+  auto Gt = make_gf_from_fourier(Gw, tau_mesh);
+  EXPECT_GF_NEAR(Gt, Gt_exact, precision);
+
+  // Back to the sparse mesh
+  auto Gw2 = make_gf_from_fourier(Gt_exact, iw_mesh);
+  EXPECT_GF_NEAR(Gw, Gw2, precision);
+
+  // Lazy form
+  Gw2() = 0.0;
+  Gw2() = fourier(Gt);
+  EXPECT_GF_NEAR(Gw, Gw2, precision);
+  Gt() = fourier(Gw);
+  EXPECT_GF_NEAR(Gt, Gt_exact, precision);
+
+  // Value on the nodes
+  auto n = iw_mesh.matsubara_index(iw_mesh.size() / 2);
+  EXPECT_ARRAY_NEAR(Gw(matsubara_freq{n, beta, statistic}), Gw[iw_mesh.size() / 2]);
+}
+
+TEST(FourierSparse, Fermion) { test_sparse_fourier(Fermion); }
+TEST(FourierSparse, Boson) { test_sparse_fourier(Boson); }
+
+TEST(FourierSparse, Block) {
+  triqs::clef::placeholder<0> iw_;
+  double beta  = 50;
+  auto iw_mesh = gf_mesh<sparse_imfreq>{beta, Fermion, 500};
+
+  std::vector<gf<sparse_imfreq, matrix_valued>> giw_vec;
+  for (int b : range(3)) {
+    giw_vec.emplace_back(iw_mesh, make_shape(1, 1));
+    giw_vec[b](iw_) << 1.0 / (iw_ - b + 0.5);
+  }
+  auto block_giw = make_block_gf({"0", "1", "2"}, giw_vec);
+
+  auto block_gtau = make_gf_from_fourier(block_giw, gf_mesh<imtime>{beta, Fermion, 1001});
+  for (int b : range(3)) EXPECT_GF_NEAR(block_gtau[b], make_gf_from_fourier(giw_vec[b], gf_mesh<imtime>{beta, Fermion, 1001}), 1e-12);
+
+  auto block_giw_2 = make_gf_from_fourier(block_gtau, iw_mesh);
+  EXPECT_BLOCK_GF_NEAR(block_giw, block_giw_2, 1e-7);
+}
+
+TEST(FourierSparse, H5) {
+  auto m = gf_mesh<sparse_imfreq>{10, Fermion, 100, 1e-10};
+  auto g = gf<sparse_imfreq, scalar_valued>{m};
+  for (auto const &w : m) g[w] = 1.0 / (dcomplex(w) - 1.0);
+  auto g2 = rw_h5(g, "fourier_sparse_imfreq", "g");
+  EXPECT_EQ(g.mesh(), g2.mesh());
+  EXPECT_GF_NEAR(g, g2, 1e-15);
+
+  // Transform with the default imaginary time mesh
+  EXPECT_EQ(make_gf_from_fourier(g).mesh(), make_adjoint_mesh(m));
+}
+
+MAKE_MAIN;
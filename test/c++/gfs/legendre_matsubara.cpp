@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/gfs.hpp>
+
+TEST(LegendreMatsubara, Direct) {
+  double beta = 10;
+  int n_l     = 30;
+
+  auto gl = gf<legendre, matrix_valued>{{beta, Fermion, n_l}, {2, 2}};
+  for (auto const &l : gl.mesh()) gl[l] = matrix<dcomplex>{{1.0 / (l.index() + 1), 0.5i}, {-0.5i, (l.index() % 2 ? 0.1 : -0.2)}};
+
+  // Matsubara : compare with the sum over the T_{nl}
+  auto gw = gf<imfreq, matrix_valued>{{beta, Fermion, 100}, {2, 2}};
+  gw()    = legendre_to_imfreq(gl);
+
+  auto gw_ref = gw;
+  gw_ref()    = 0.0;
+  for (auto const &w : gw.mesh())
+    for (auto const &l : gl.mesh()) gw_ref[w] += triqs::utility::legendre_T(w.index(), l.index()) * gl[l];
+  EXPECT_GF_NEAR(gw, gw_ref, 1e-13);
+
+  // Imaginary time : compare with the sum over the Legendre polynomials
+  auto gt = gf<imtime, matrix_valued>{{beta, Fermion, 501}, {2, 2}};
+  gt()    = legendre_to_imtime(gl);
+
+  auto gt_ref = gt;
+  gt_ref()    = 0.0;
+  triqs::utility::legendre_generator L;
+  for (auto const &t : gt.mesh()) {
+    L.reset(2 * t / beta - 1);
+    for (auto const &l : gl.mesh()) gt_ref[t] += std::sqrt(2 * l.index() + 1) / beta * gl[l] * L.next();
+  }
+  EXPECT_GF_NEAR(gt, gt_ref, 1e-13);
+
+  // The matrices are computed once per geometry
+  EXPECT_EQ(legendre_T_matrix(gw.mesh(), n_l), legendre_T_matrix(gw.mesh(), n_l));
+  // T does not depend on the statistic : the same indices share the matrix
+  auto opt = matsubara_mesh_opt::positive_frequencies_only;
+  EXPECT_EQ(legendre_T_matrix(gf_mesh<imfreq>{beta, Fermion, 100, opt}, n_l), legendre_T_matrix(gf_mesh<imfreq>{beta, Boson, 100, opt}, n_l));
+  EXPECT_EQ(legendre_P_matrix(gt.mesh(), n_l), legendre_P_matrix(gt.mesh(), n_l));
+}
+
+TEST(LegendreMatsubara, Inverse) {
+  triqs::clef::placeholder<0> tau_;
+  double beta = 5;
+  int n_l     = 40;
+
+  // Smooth G(tau), well represented by n_l coefficients
+  auto gt = gf<imtime, scalar_valued>{{beta, Fermion, 10001}};
+  gt(tau_) << -exp(-0.5 * tau_) / (1 + exp(-0.5 * beta));
+
+  auto gl = gf<legendre, scalar_valued>{{beta, Fermion, n_l}};
+  gl()    = imtime_to_legendre(gt);
+
+  auto gt2 = gt;
+  gt2()    = legendre_to_imtime(gl);
+  EXPECT_GF_NEAR(gt, gt2, 1e-6);
+
+  // Real-valued gf, done with real gemm
+  auto gt_real = gf<imtime, scalar_real_valued>{gt.mesh()};
+  gt_real(tau_) << -exp(-0.5 * tau_) / (1 + exp(-0.5 * beta));
+  auto gl_real = gf<legendre, scalar_real_valued>{gl.mesh()};
+  gl_real()    = imtime_to_legendre(gt_real);
+  EXPECT_ARRAY_NEAR(gl_real.data(), array<double, 1>(real(gl.data())), 1e-13);
+}
+
+MAKE_MAIN;
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/counter_based_rng.hpp>
+#include <triqs/mc_tools/random_generator.hpp>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace triqs::mc_tools;
+using namespace triqs::mc_tools::RandomGenerators;
+
+template <typename B> std::vector<typename B::word_t> bijection(std::vector<typename B::word_t> const &c, std::array<typename B::word_t, B::n_keys> k) {
+  typename B::word_t x[B::n_words][1];
+  for (int i = 0; i < B::n_words; ++i) x[i][0] = c[i];
+  B::template apply<1>(x, k);
+  std::vector<typename B::word_t> r(B::n_words);
+  for (int i = 0; i < B::n_words; ++i) r[i] = x[i][0];
+  return r;
+}
+
+// Known answers of Random123
+TEST(CounterBasedRng, KnownAnswers) {
+  EXPECT_EQ(bijection<philox4x32_10>({0, 0, 0, 0}, {0, 0}), (std::vector<uint32_t>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+  EXPECT_EQ(bijection<philox4x32_10>({~0u, ~0u, ~0u, ~0u}, {~0u, ~0u}), (std::vector<uint32_t>{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+  EXPECT_EQ(bijection<philox4x32_10>({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+            (std::vector<uint32_t>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+  EXPECT_EQ(bijection<threefry4x64_20>({0, 0, 0, 0}, {0, 0, 0, 0}),
+            (std::vector<uint64_t>{0x09218ebde6c85537, 0x55941f5266d86105, 0x4bd25e16282434dc, 0xee29ec846bd2e40b}));
+  EXPECT_EQ(bijection<threefry4x64_20>({~0ull, ~0ull, ~0ull, ~0ull}, {~0ull, ~0ull, ~0ull, ~0ull}),
+            (std::vector<uint64_t>{0x29c24097942bba1b, 0x0371bbfb0f6f4e11, 0x3c231ffa33f83a1c, 0xcd29113fde32d168}));
+}
+
+template <typename E> void check_engine() {
+  // jump ahead
+  E e1(12, 3), e2(12, 3);
+  for (int i = 0; i < 12345; ++i) e1();
+  e2.discard(12345);
+  EXPECT_EQ(e1(), e2());
+
+  // streams
+  E s0(12, 0), s1(12, 1);
+  int n_equal = 0;
+  for (int i = 0; i < 1000; ++i) n_equal += (s0() == s1());
+  EXPECT_LT(n_equal, 2);
+
+  // the bulk fill gives the same sequence as uniform, from any position : at the start of a block (vectorized loop),
+  // an even number of words (the start of a double, loop after the first block) and an odd one (no loop for philox)
+  std::vector<double> v(1001), w(1001);
+  for (int n_words : {0, 1, 2, 6}) {
+    E f1(5, 7), f2(5, 7);
+    f1.discard(n_words);
+    f2.discard(n_words);
+    for (int r = 0; r < 3; ++r) {
+      f1.fill_uniform(v.data(), v.data() + v.size());
+      for (auto &x : w) x = f2.uniform();
+      EXPECT_EQ(v, w);
+    }
+    EXPECT_TRUE(f1 == f2);
+  }
+  for (auto x : v) {
+    EXPECT_GE(x, 0.0);
+    EXPECT_LT(x, 1.0);
+  }
+
+  // compact state, after a fill
+  E f1(5, 7);
+  f1.fill_uniform(v.data(), v.data() + v.size());
+  std::stringstream ss;
+  ss << f1;
+  E f3(0, 0);
+  ss >> f3;
+  EXPECT_TRUE(f3 == f1);
+  EXPECT_EQ(f3.uniform(), f1.uniform());
+}
+
+TEST(CounterBasedRng, Philox) { check_engine<philox4x32>(); }
+
+TEST(CounterBasedRng, Threefry) { check_engine<threefry4x64>(); }
+
+TEST(CounterBasedRng, RandomGenerator) {
+  for (std::string name : {"philox4x32", "threefry4x64"}) {
+    random_generator r1(name, 23, 4), r2(name, 23, 4), r3(name, 23, 5);
+    double s = 0;
+    for (int i = 0; i < 5000; ++i) {
+      double x = r1();
+      EXPECT_EQ(x, r2());
+      EXPECT_NE(x, r3());
+      s += x;
+    }
+    EXPECT_NEAR(s / 5000, 0.5, 0.02);
+
+    // the state
+    r2.set_state(r1.get_state());
+    for (int i = 0; i < 3000; ++i) EXPECT_EQ(r1(), r2());
+  }
+
+  // For the boost generators, the stream 0 is the seed itself
+  random_generator m1("mt19937", 23), m2("mt19937", 23, 0), m3("mt19937", 23, 1);
+  double x = m1();
+  EXPECT_EQ(x, m2());
+  EXPECT_NE(x, m3());
+
+  auto names = random_generator_names_list();
+  EXPECT_EQ(std::count(names.begin(), names.end(), "philox4x32"), 1);
+}
+
+MAKE_MAIN;
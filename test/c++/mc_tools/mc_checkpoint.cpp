@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/mc_generic.hpp>
+
+using namespace triqs::mc_tools;
+
+struct configuration {
+  long x = 0;
+};
+
+// Jump to a random position in [0,4), with weight x + 1
+struct move_jump {
+  configuration *config;
+  random_generator *RNG;
+  long x_new = 0;
+
+  double attempt() {
+    x_new = (*RNG)(4);
+    return double(x_new + 1) / (config->x + 1);
+  }
+  double accept() {
+    config->x = x_new;
+    return 1;
+  }
+  void reject() {}
+};
+
+struct result_t {
+  double sum = 0;
+  long count = 0;
+};
+
+// The accumulated sum is saved in the checkpoint
+struct measure_x {
+  configuration *config;
+  result_t *r;
+
+  void accumulate(double) {
+    r->sum += config->x * 0.1;
+    ++r->count;
+  }
+  void collect_results(mpi::communicator const &) {}
+
+  friend void h5_write(h5::group g, std::string const &name, measure_x const &m) {
+    auto gr = g.create_group(name);
+    h5_write(gr, "sum", m.r->sum);
+    h5_write(gr, "count", m.r->count);
+  }
+  friend void h5_read(h5::group g, std::string const &name, measure_x &m) {
+    auto gr = g.open_group(name);
+    h5_read(gr, "sum", m.r->sum);
+    h5_read(gr, "count", m.r->count);
+  }
+};
+
+long n_warmup = 50, n_cycles = 500, length_cycle = 10;
+
+struct simulation {
+  configuration config;
+  result_t result;
+  std::unique_ptr<mc_generic<double>> mc = std::make_unique<mc_generic<double>>("mt19937", 42, 0);
+
+  simulation() {
+    mc->add_move(move_jump{&config, &mc->get_rng()}, "jump");
+    mc->add_measure(measure_x{&config, &result}, "x");
+  }
+
+  void set_checkpoint(std::string const &filename, double period) {
+    mc->set_checkpoint(
+       filename, period, [this](h5::group g) { h5_write(g, "x", config.x); }, [this](h5::group g) { h5_read(g, "x", config.x); });
+  }
+};
+
+// Interrupt the run after n_stop cycles, resume it from the checkpoint in a new simulation,
+// and compare with an uninterrupted run
+void check_resume(long n_stop) {
+  mpi::communicator world;
+  std::string filename = "mc_checkpoint_" + std::to_string(n_stop) + ".h5";
+
+  simulation ref;
+  EXPECT_EQ(ref.mc->warmup_and_accumulate(n_warmup, n_cycles, length_cycle, []() { return false; }), 0);
+  ref.mc->collect_results(world);
+
+  {
+    simulation s;
+    s.set_checkpoint(filename, 1.e6);
+    long n = 0;
+    EXPECT_EQ(s.mc->warmup_and_accumulate(n_warmup, n_cycles, length_cycle, [&n, n_stop]() { return ++n >= n_stop; }), 1);
+  }
+
+  simulation s;
+  s.set_checkpoint(filename, 1.e6);
+  EXPECT_EQ(s.mc->resume(filename, n_warmup, n_cycles, length_cycle, []() { return false; }), 0);
+  s.mc->collect_results(world);
+
+  EXPECT_EQ(s.result.count, ref.result.count);
+  EXPECT_EQ(s.result.sum, ref.result.sum);
+  EXPECT_EQ(s.config.x, ref.config.x);
+  EXPECT_EQ(s.mc->get_config_id(), ref.mc->get_config_id());
+  EXPECT_EQ(s.mc->get_current_cycle_number(), ref.mc->get_current_cycle_number());
+  EXPECT_EQ(s.mc->get_acceptance_rates(), ref.mc->get_acceptance_rates());
+  EXPECT_EQ(s.mc->get_rng()(), ref.mc->get_rng()());
+}
+
+TEST(McCheckpoint, ResumeInWarmup) { check_resume(20); }
+
+TEST(McCheckpoint, ResumeInAccumulation) { check_resume(200); }
+
+TEST(McCheckpoint, RngState) {
+  random_generator r1("mt19937", 23), r2("mt19937", 5), r3("lagged_fibonacci607", 5), r4("", 5);
+  for (int i = 0; i < 10; ++i) r1();
+  r2.set_state(r1.get_state());
+  for (int i = 0; i < 5000; ++i) EXPECT_EQ(r1(), r2());
+
+  // Another generator, or the generator "" whose state can not be saved
+  EXPECT_THROW(r3.set_state(r1.get_state()), triqs::runtime_error);
+  EXPECT_THROW(r4.get_state(), triqs::runtime_error);
+}
+
+MAKE_MAIN;
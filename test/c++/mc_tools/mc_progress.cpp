@@ -0,0 +1,121 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/mc_generic.hpp>
+
+using namespace triqs::mc_tools;
+
+struct configuration {
+  long x = 0;
+};
+
+// Flip a spin with weights 1 (x = 0) and -0.5 (x = 1) : the average sign is 1/3
+struct move_flip {
+  configuration *config;
+  double attempt() { return (config->x == 0 ? -0.5 : -2); }
+  double accept() {
+    config->x = 1 - config->x;
+    return 1;
+  }
+  void reject() {}
+};
+
+struct measure_x {
+  configuration *config;
+  double *sum;
+  long *count;
+  void accumulate(double) {
+    *sum += config->x;
+    ++*count;
+  }
+  void collect_results(mpi::communicator const &) {}
+};
+
+auto make_mc(configuration &config, double &sum, long &count, mpi::communicator world) {
+  auto mc = std::make_unique<mc_generic<double>>("mt19937", 1234 + 17 * world.rank(), 0);
+  mc->add_move(move_flip{&config}, "flip");
+  mc->add_measure(measure_x{&config, &sum, &count}, "x");
+  return mc;
+}
+
+TEST(McProgress, Statistics) {
+  mpi::communicator world;
+  configuration config;
+  double sum = 0;
+  long count = 0;
+  auto mc    = make_mc(config, sum, count, world);
+
+  EXPECT_THROW(mc->get_progress(), triqs::runtime_error);
+  EXPECT_THROW(mc->stop_when(0.1), triqs::runtime_error);
+
+  mc->set_progress_channel(world, 0.0);
+  mc->add_progress_summary("x", [&]() { return sum / count; });
+  long n_cycles = 20000;
+  EXPECT_EQ(mc->accumulate(n_cycles, 1, []() { return false; }), 0);
+
+  // The last reduction is done after all nodes have finished
+  auto const &p = mc->get_progress();
+  EXPECT_GT(p.n_rounds, 0);
+  EXPECT_EQ(p.n_measures, uint64_t(n_cycles * world.size()));
+  EXPECT_EQ(p.n_nodes, world.size());
+  EXPECT_NEAR(p.average_sign, 1 / 3.0, 0.05);
+  EXPECT_NEAR(p.summaries.at("x").first, 1 / 3.0, 0.05);
+  if (world.size() == 1) EXPECT_TRUE(std::isinf(p.average_sign_error));
+}
+
+TEST(McProgress, StopWhen) {
+  mpi::communicator world;
+  configuration config;
+  double sum = 0;
+  long count = 0;
+  auto mc    = make_mc(config, sum, count, world);
+
+  mc->set_progress_channel(world, 0.0);
+  mc->stop_when([](progress_info const &p) { return p.n_measures >= 1000; });
+  EXPECT_EQ(mc->accumulate(1000000, 1, []() { return false; }), 3);
+  EXPECT_GE(mc->get_progress().n_measures, uint64_t(1000));
+  EXPECT_LT(count, 1000000);
+
+  // A precision on the average sign, which needs at least 2 nodes
+  sum   = 0;
+  count = 0;
+  mc->stop_when(0.01);
+  int status = mc->accumulate(200000, 1, []() { return false; });
+  if (world.size() == 1)
+    EXPECT_EQ(status, 0);
+  else
+    EXPECT_TRUE(status == 0 or status == 3);
+}
+
+// A node without any cycle to do takes part in the reductions : the other nodes do not wait for it forever
+TEST(McProgress, NodeWithoutCycles) {
+  mpi::communicator world;
+  configuration config;
+  double sum = 0;
+  long count = 0;
+  auto mc    = make_mc(config, sum, count, world);
+
+  mc->set_progress_channel(world, 0.0);
+  long n_cycles = (world.rank() == 0 ? 0 : 2000);
+  EXPECT_EQ(mc->accumulate(n_cycles, 1, []() { return false; }), 0);
+
+  auto const &p = mc->get_progress();
+  EXPECT_GT(p.n_rounds, 0);
+  EXPECT_EQ(p.n_measures, uint64_t(2000 * (world.size() - 1)));
+  EXPECT_EQ(p.n_nodes, world.size() - 1);
+}
+
+MAKE_MAIN;
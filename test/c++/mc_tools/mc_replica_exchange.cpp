@@ -0,0 +1,136 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/mc_replica_exchange.hpp>
+
+using namespace triqs::mc_tools;
+
+// The energy of the 4 states, with a barrier between states 0 and 3
+std::vector<double> energy = {0, 4, 4, 0.5};
+
+struct configuration {
+  long x = 0;
+};
+
+// Move to a neighbouring state, at inverse temperature beta
+struct move_step {
+  configuration *config;
+  random_generator *RNG;
+  double beta;
+  long x_new = 0;
+
+  double attempt() {
+    x_new = config->x + ((*RNG)(2) ? 1 : -1);
+    if (x_new < 0 or x_new > 3) return 0;
+    return std::exp(-beta * (energy[x_new] - energy[config->x]));
+  }
+  double accept() {
+    config->x = x_new;
+    return 1;
+  }
+  void reject() {}
+};
+
+struct measure_histo {
+  configuration *config;
+  std::vector<double> *histo;
+  long count = 0;
+
+  void accumulate(double) {
+    (*histo)[config->x] += 1;
+    ++count;
+  }
+  void collect_results(mpi::communicator const &c) {
+    for (auto &h : *histo) h = mpi::all_reduce(h, c) / mpi::all_reduce(count, c);
+  }
+};
+
+TEST(McReplicaExchange, Boltzmann) {
+  mpi::communicator world;
+  std::vector<double> betas = {0.2, 1, 5};
+  int K                     = betas.size();
+
+  mc_replica_exchange<double> mc(K, "mt19937", 1234 + 17 * world.rank(), 0);
+  EXPECT_EQ(mc.n_replicas(), K);
+
+  std::vector<configuration> configs(K);
+  std::vector<std::vector<double>> histos(K, std::vector<double>(4, 0));
+  for (int k = 0; k < K; ++k) {
+    auto &r = mc.replica(k);
+    r.add_move(move_step{&configs[k], &r.get_rng(), betas[k]}, "step");
+    r.add_measure(measure_histo{&configs[k], &histos[k]}, "histo");
+  }
+  auto swap_ratio = [&](int k, int l) { return std::exp((betas[k] - betas[l]) * (energy[configs[k].x] - energy[configs[l].x])); };
+  auto swap       = [&](int k, int l) { std::swap(configs[k], configs[l]); };
+  mc.set_swap(swap_ratio, swap, 2);
+
+  EXPECT_THROW(mc.get_acceptance_rates(3), std::out_of_range);
+  EXPECT_EQ(mc.get_swap_acceptance_rates().at("swap 0 <-> 1"), -1);
+
+  long n_warmup = 100, n_cycles = 50000;
+  EXPECT_EQ(mc.warmup_and_accumulate(n_warmup, n_cycles, 5, []() { return false; }), 0);
+  mc.collect_results(world);
+
+  EXPECT_EQ(mc.get_n_swap_rounds(), uint64_t(n_warmup + n_cycles) / 2);
+
+  // Each replica samples the Boltzmann distribution at its temperature
+  for (int k = 0; k < K; ++k) {
+    double Z = 0;
+    for (auto e : energy) Z += std::exp(-betas[k] * e);
+    for (int x = 0; x < 4; ++x) EXPECT_NEAR(histos[k][x], std::exp(-betas[k] * energy[x]) / Z, 0.02);
+  }
+
+  for (auto const &[name, rate] : mc.get_swap_acceptance_rates()) {
+    EXPECT_GT(rate, 0);
+    EXPECT_LE(rate, 1);
+  }
+  EXPECT_GT(mc.get_acceptance_rates(0).at("step"), 0);
+
+  // Checkpoint of the replicas and of the swap statistics
+  {
+    h5::file file("mc_replica_exchange.h5", 'w');
+    h5_write(file, "mc", mc);
+  }
+  mc_replica_exchange<double> mc2(K, "mt19937", 1234, 0);
+  for (int k = 0; k < K; ++k) mc2.replica(k).add_move(move_step{&configs[k], &mc2.replica(k).get_rng(), betas[k]}, "step");
+  {
+    h5::file file("mc_replica_exchange.h5", 'r');
+    h5_read(file, "mc", mc2);
+  }
+  EXPECT_EQ(mc2.get_n_swap_rounds(), mc.get_n_swap_rounds());
+}
+
+TEST(McReplicaExchange, StopAndErrors) {
+  mc_replica_exchange<double> mc(4, "mt19937", 1234, 0);
+  std::vector<configuration> configs(4);
+  for (int k = 0; k < 4; ++k) {
+    auto &r = mc.replica(k);
+    r.add_move(move_step{&configs[k], &r.get_rng(), 1.0}, "step");
+  }
+
+  // The swap functions are required
+  EXPECT_THROW(mc.accumulate(10, 10, []() { return false; }), triqs::runtime_error);
+
+  // The first call of the callback stops all replicas, without a deadlock at the swaps
+  mc.set_swap([](int, int) { return 1.0; }, [](int, int) {}, 3);
+  EXPECT_EQ(mc.accumulate(1000000, 10, []() { return true; }), 1);
+
+  // An error in the swap stops all replicas, and is rethrown
+  mc.set_swap([](int, int) -> double { TRIQS_RUNTIME_ERROR << "swap error"; }, [](int, int) {}, 1);
+  EXPECT_THROW(mc.accumulate(1000, 10, []() { return false; }), triqs::runtime_error);
+}
+
+MAKE_MAIN;
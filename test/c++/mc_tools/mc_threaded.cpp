@@ -0,0 +1,163 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/mc_threaded.hpp>
+#include <numeric>
+
+using namespace triqs::mc_tools;
+
+// Read-only data shared by all walkers : the weight of the positions of a walker on [0, n)
+struct model {
+  std::vector<double> weights;
+};
+
+struct configuration {
+  long x = 0;
+};
+
+// Move to a random position, with the Metropolis ratio of the weights
+struct move_jump {
+  model const *m;
+  configuration *config;
+  random_generator *RNG;
+  long x_new = 0;
+
+  double attempt() {
+    x_new = (*RNG)(long(m->weights.size()));
+    return m->weights[x_new] / m->weights[config->x];
+  }
+  double accept() {
+    config->x = x_new;
+    return 1;
+  }
+  void reject() {}
+};
+
+// The histogram of the positions
+struct measure_histo {
+  configuration *config;
+  std::vector<double> *histo;
+  long count = 0;
+
+  void accumulate(double) {
+    (*histo)[config->x] += 1;
+    ++count;
+  }
+  void merge(measure_histo const &x) {
+    for (size_t i = 0; i < histo->size(); ++i) (*histo)[i] += (*x.histo)[i];
+    count += x.count;
+  }
+  void collect_results(mpi::communicator const &c) {
+    for (auto &h : *histo) h = mpi::all_reduce(h, c);
+    count = mpi::all_reduce(count, c);
+    for (auto &h : *histo) h /= count;
+  }
+};
+
+// Without merge, hence not usable with several walkers
+struct measure_x {
+  configuration *config;
+  void accumulate(double) {}
+  void collect_results(mpi::communicator const &) {}
+};
+
+TEST(McThreaded, Histogram) {
+  mpi::communicator world;
+  model m{{1, 2, 3, 4}};
+  int n_walkers = 4;
+  long n_cycles = 20000;
+
+  mc_threaded<double> mc(n_walkers, "mt19937", 1234 + 17 * world.rank(), 0);
+  EXPECT_EQ(mc.n_walkers(), n_walkers);
+
+  std::vector<configuration> configs(n_walkers);
+  std::vector<std::vector<double>> histos(n_walkers, std::vector<double>(4, 0));
+  for (int k = 0; k < n_walkers; ++k) {
+    auto &w = mc.walker(k);
+    w.add_move(move_jump{&m, &configs[k], &w.get_rng()}, "jump");
+    w.add_measure(measure_histo{&configs[k], &histos[k]}, "histo");
+  }
+  EXPECT_EQ(mc.warmup_and_accumulate(100, n_cycles, 5, []() { return false; }), 0);
+  mc.collect_results(world);
+
+  // The result is in the measure of walker 0
+  EXPECT_NEAR(std::accumulate(histos[0].begin(), histos[0].end(), 0.0), 1.0, 1.e-12);
+  for (int i = 0; i < 4; ++i) EXPECT_NEAR(histos[0][i], (i + 1) / 10.0, 0.01);
+
+  EXPECT_THROW(mc.collect_results(world), triqs::runtime_error);
+}
+
+TEST(McThreaded, OneWalkerIsMcGeneric) {
+  mpi::communicator world;
+  model m{{1, 5, 2}};
+
+  configuration c1, c2;
+  std::vector<double> h1(3, 0), h2(3, 0);
+
+  mc_generic<double> mc1("mt19937", 42, 0);
+  mc1.add_move(move_jump{&m, &c1, &mc1.get_rng()}, "jump");
+  mc1.add_measure(measure_histo{&c1, &h1}, "histo");
+  mc1.warmup_and_accumulate(10, 1000, 3, []() { return false; });
+  mc1.collect_results(world);
+
+  mc_threaded<double> mc2(1, "mt19937", 42, 0);
+  auto &w = mc2.walker(0);
+  w.add_move(move_jump{&m, &c2, &w.get_rng()}, "jump");
+  w.add_measure(measure_histo{&c2, &h2}, "histo");
+  mc2.warmup_and_accumulate(10, 1000, 3, []() { return false; });
+  mc2.collect_results(world);
+
+  EXPECT_EQ(h1, h2);
+  EXPECT_EQ(mc1.get_acceptance_rates(), mc2.get_acceptance_rates());
+}
+
+TEST(McThreaded, StopAndErrors) {
+  mpi::communicator world;
+  model m{{1, 1}};
+  mc_threaded<double> mc(3, "mt19937", 42, 0);
+  std::vector<configuration> configs(3);
+  for (int k = 0; k < 3; ++k) {
+    auto &w = mc.walker(k);
+    w.add_move(move_jump{&m, &configs[k], &w.get_rng()}, "jump");
+    w.add_measure(measure_x{&configs[k]}, "x");
+  }
+
+  // The first call of the callback stops all walkers
+  EXPECT_EQ(mc.accumulate(1000000, 10, []() { return true; }), 1);
+
+  // measure_x has no merge
+  EXPECT_THROW(mc.collect_results(world), triqs::runtime_error);
+}
+
+// The moves of the walkers must have the same structure : a move_set can not be merged with a simple move
+TEST(McThreaded, MergeDifferentMoves) {
+  model m{{1, 2}};
+  configuration c1, c2;
+  std::vector<double> h1(2, 0), h2(2, 0);
+
+  mc_generic<double> w1("mt19937", 42, 0), w2("mt19937", 43, 0);
+  move_set<double> ms(w1.get_rng());
+  ms.add(move_jump{&m, &c1, &w1.get_rng()}, "jump", 1.0);
+  w1.add_move(std::move(ms), "jumps");
+  w1.add_measure(measure_histo{&c1, &h1}, "histo");
+  w2.add_move(move_jump{&m, &c2, &w2.get_rng()}, "jumps");
+  w2.add_measure(measure_histo{&c2, &h2}, "histo");
+
+  EXPECT_THROW(w1.merge(w2), triqs::runtime_error);
+  EXPECT_THROW(w2.merge(w1), triqs::runtime_error);
+}
+
+MAKE_MAIN;
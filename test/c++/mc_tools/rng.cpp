@@ -21,6 +21,7 @@
 #include <random>
 #include <vector>
 #include <triqs/mc_tools/MersenneRNG.hpp>
+#include <triqs/mc_tools/random_generator.hpp>
 #include <boost/random/uniform_real.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/lagged_fibonacci.hpp>
@@ -59,6 +60,24 @@ TEST(Random, Mersenne) {
   for (int i = 0; i < 100; ++i) EXPECT_EQ(result[i], gb());
 }
 
+// The buffer of random_generator is refilled at once : the numbers are still those of the boost variate_generator
+template <typename Engine> void check_bulk_fill(std::string const &name) {
+  int seed = 1352;
+  boost::variate_generator<Engine, boost::uniform_real<>> gb(Engine(seed), boost::uniform_real<>{});
+  triqs::mc_tools::random_generator r1(name, seed), r2(name, seed, 0, 7);
+  for (int i = 0; i < 3000; ++i) {
+    double x = gb();
+    EXPECT_EQ(x, r1());
+    EXPECT_EQ(x, r2());
+  }
+}
+
+TEST(Random, BulkFill) {
+  check_bulk_fill<boost::mt19937>("mt19937");
+  check_bulk_fill<boost::lagged_fibonacci607>("lagged_fibonacci607");
+  check_bulk_fill<boost::ranlux3>("ranlux3");
+}
+
 #ifdef RANDOM_TEST_UNIFORM
 TEST(Random, MersenneUniform) {
 
@@ -0,0 +1,115 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools/mc_generic.hpp>
+#include <triqs/mc_tools/static_mc_generic.hpp>
+
+using namespace triqs::mc_tools;
+
+// A walker on the integers, with weight (-1)^x exp(-x^2 / 50)
+struct configuration {
+  long x = 0;
+};
+
+double weight(long x) { return std::exp(-x * x / 50.0); }
+
+// Move by a random step in [1, max_step], in the direction dir
+struct move_step {
+  configuration *config;
+  random_generator *RNG;
+  long dir, max_step;
+  long step = 0;
+
+  double attempt() {
+    step = dir * (1 + (*RNG)(max_step));
+    double r = weight(config->x + step) / weight(config->x);
+    return (step % 2 ? -r : r);
+  }
+  double accept() {
+    config->x += step;
+    return 1;
+  }
+  void reject() {}
+};
+
+// Move to -x, which has the same weight and the same sign. The sign is returned by accept.
+struct move_flip {
+  configuration *config;
+  double attempt() { return 1; }
+  double accept() {
+    config->x = -config->x;
+    return 1;
+  }
+  void reject() {}
+};
+
+struct measure_x {
+  configuration *config;
+  std::vector<long> *history;
+  double *sum_sign;
+  void accumulate(double sign) {
+    history->push_back(config->x);
+    *sum_sign += sign;
+  }
+  void collect_results(mpi::communicator const &) {}
+};
+
+TEST(StaticMcGeneric, SameChainAsMcGeneric) {
+  mpi::communicator world;
+  long n_cycles = 2000, length_cycle = 10;
+
+  std::vector<long> h1, h2;
+  double s1 = 0, s2 = 0;
+
+  configuration c1;
+  mc_generic<double> mc1("mt19937", 2342, 0);
+  mc1.add_move(move_step{&c1, &mc1.get_rng(), -1, 3}, "left", 1.0);
+  mc1.add_move(move_step{&c1, &mc1.get_rng(), 1, 3}, "right", 2.0);
+  mc1.add_move(move_flip{&c1}, "flip", 0.5);
+  mc1.add_measure(measure_x{&c1, &h1, &s1}, "x");
+  mc1.warmup_and_accumulate(100, n_cycles, length_cycle, []() { return false; });
+  mc1.collect_results(world);
+
+  configuration c2;
+  static_mc_generic<double, move_step, move_step, move_flip> mc2("mt19937", 2342, 0);
+  mc2.set_moves({move_step{&c2, &mc2.get_rng(), -1, 3}, move_step{&c2, &mc2.get_rng(), 1, 3}, move_flip{&c2}}, {"left", "right", "flip"},
+                {1.0, 2.0, 0.5});
+  mc2.add_measure(measure_x{&c2, &h2, &s2}, "x");
+  mc2.warmup_and_accumulate(100, n_cycles, length_cycle, []() { return false; });
+  mc2.collect_results(world);
+
+  EXPECT_EQ(h1.size(), size_t(n_cycles));
+  EXPECT_EQ(h1, h2);
+  EXPECT_EQ(s1, s2);
+  EXPECT_EQ(mc1.get_acceptance_rates(), mc2.get_acceptance_rates());
+  EXPECT_EQ(mc2.get_current_cycle_number(), n_cycles + 100);
+  EXPECT_EQ(mc2.get_config_id(), (n_cycles + 100) * length_cycle);
+
+  // The flip move is always accepted
+  auto n_prop = mc2.get_n_proposed();
+  auto n_acc  = mc2.get_n_accepted();
+  EXPECT_EQ(n_prop[2], n_acc[2]);
+  EXPECT_EQ(n_prop[0] + n_prop[1] + n_prop[2], (n_cycles + 100) * length_cycle);
+}
+
+TEST(StaticMcGeneric, Errors) {
+  static_mc_generic<double, move_flip> mc("mt19937", 2342, 0);
+  EXPECT_THROW(mc.accumulate(10, 10, []() { return false; }), triqs::runtime_error);
+  configuration c;
+  EXPECT_THROW(mc.set_moves({move_flip{&c}}, {"flip"}, {0.0}), triqs::runtime_error);
+}
+
+MAKE_MAIN;
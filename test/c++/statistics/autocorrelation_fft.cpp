@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/statistics.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+using namespace triqs::statistics;
+
+// x_i = f x_{i-1} + sqrt(1 - f^2) xi_i + avg, with f = exp(-1/L) : sum_{k>0} r_k = f / (1 - f)
+std::vector<double> correlated_gaussian_vector(int N, int seed, double L, double avg) {
+  boost::variate_generator<boost::mt19937, boost::normal_distribution<>> generator((boost::mt19937(seed)), (boost::normal_distribution<>()));
+  std::vector<double> t(N);
+  double f = std::exp(-1 / L), x = generator();
+  for (auto &y : t) {
+    x = f * x + std::sqrt(1 - f * f) * generator();
+    y = x + avg;
+  }
+  return t;
+}
+
+// ------------------------
+
+TEST(AutocorrelationFFT, AllLags) {
+  int N  = 2000;
+  auto a = correlated_gaussian_vector(N, 1567, 10, 2);
+
+  auto r_fft = normalized_autocorrelation_fft(a);
+  auto r     = make_normalized_autocorrelation(a);
+  EXPECT_EQ(r_fft.size(), N);
+  EXPECT_NEAR(r_fft[0], 1, 1.e-12);
+  for (int k = 0; k < N; ++k) EXPECT_NEAR(r_fft[k], r[k], 1.e-8);
+
+  // on an expression of observables
+  observable<double> A;
+  for (auto x : a) A << x;
+  auto r2_fft = normalized_autocorrelation_fft(A * A);
+  auto r2     = make_normalized_autocorrelation(make_immutable_time_series(A * A));
+  for (int k = 0; k < N; k += 7) EXPECT_NEAR(r2_fft[k], r2[k], 1.e-8);
+}
+
+// ------------------------
+
+TEST(AutocorrelationFFT, Array) {
+  int N  = 1000;
+  auto a = correlated_gaussian_vector(N, 12, 5, 0);
+  auto b = correlated_gaussian_vector(N, 13, 20, 1);
+
+  observable<triqs::arrays::array<double, 1>> A;
+  for (int i = 0; i < N; ++i) A << triqs::arrays::array<double, 1>{a[i], b[i]};
+
+  auto r  = normalized_autocorrelation_fft(A);
+  auto ra = normalized_autocorrelation_fft(a), rb = normalized_autocorrelation_fft(b);
+  for (int k = 0; k < N; ++k) {
+    EXPECT_NEAR(r[k](0), ra[k], 1.e-12);
+    EXPECT_NEAR(r[k](1), rb[k], 1.e-12);
+  }
+
+  auto tau = autocorrelation_time_from_fft(A);
+  EXPECT_NEAR(tau(0), autocorrelation_time_from_fft(a), 1.e-12);
+  EXPECT_NEAR(tau(1), autocorrelation_time_from_fft(b), 1.e-12);
+}
+
+// ------------------------
+
+TEST(AutocorrelationFFT, Windowing) {
+  int N = 200000, L = 20;
+  auto a = correlated_gaussian_vector(N, 1567, L, 2);
+
+  double f = std::exp(-1. / L);
+  EXPECT_NEAR(autocorrelation_time_from_fft(a) / (f / (1 - f)), 1, 0.1);
+
+  log_binning<double> A;
+  for (auto x : a) A << x;
+  EXPECT_NEAR(autocorrelation_time_from_fft(a) / A.autocorrelation_time(), 1, 0.2);
+
+  EXPECT_THROW(autocorrelation_time_from_fft(std::vector<double>{1.}), triqs::runtime_error);
+}
+
+// ------------------------
+
+// autocorrelation_time sums the r_k from k = 0 up to the window 6 t_int : 1 + f / (1 - f) = 1 / (1 - f) for the AR(1) series.
+// The truncation at the window is exp(-6 t_int / L) ~ 0.25 % of t_int.
+TEST(AutocorrelationFFT, AutocorrelationTime) {
+  int N = 200000;
+  for (double L : {5., 20.}) {
+    auto a   = correlated_gaussian_vector(N, 1567, L, 2);
+    double f = std::exp(-1. / L);
+    EXPECT_NEAR(autocorrelation_time(a), 1 / (1 - f), 0.1 / (1 - f) + 1); // + 1 : the result is truncated to an int
+
+    // the same window on the direct autocorrelation
+    auto r       = make_normalized_autocorrelation(a);
+    double t_int = 1;
+    for (int l = 1; (l < 6 * t_int) and (l < N); ++l) t_int += r[l];
+    EXPECT_EQ(autocorrelation_time(a), int(t_int));
+  }
+}
+
+MAKE_MAIN;
@@ -0,0 +1,143 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/statistics.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+using namespace triqs::statistics;
+
+// x_i = f x_{i-1} + sqrt(1 - f^2) xi_i + avg, with f = exp(-1/L) : tau_int = (1 + f) / (1 - f) / 2
+std::vector<double> correlated_gaussian_vector(int N, int seed, double L, double avg) {
+  boost::variate_generator<boost::mt19937, boost::normal_distribution<>> generator((boost::mt19937(seed)), (boost::normal_distribution<>()));
+  std::vector<double> t(N);
+  double f = std::exp(-1 / L), x = generator();
+  for (auto &y : t) {
+    x = f * x + std::sqrt(1 - f * f) * generator();
+    y = x + avg;
+  }
+  return t;
+}
+
+// ------------------------
+
+TEST(LogBinning, Levels) {
+  int N  = 100000;
+  auto a = correlated_gaussian_vector(N, 1567, 20, 2);
+
+  log_binning<double> A;
+  for (auto x : a) A << x;
+
+  EXPECT_EQ(A.n_measures(), N);
+  EXPECT_EQ(A.n_levels(), 17);
+  EXPECT_NEAR(A.mean(), empirical_average(a), 1.e-12);
+
+  // the level l is the binned series of bin size 2^l
+  for (int l = 0; l < 12; ++l) {
+    auto b = make_binned_series(a, 1 << l);
+    EXPECT_EQ(A.n_blocks(l), b.size());
+    EXPECT_NEAR(A.variance(l), empirical_variance(b) * b.size() / (b.size() - 1), 1.e-10);
+  }
+
+  double f = std::exp(-1 / 20.), tau = (1 + f) / (1 - f) / 2;
+  EXPECT_NEAR(A.autocorrelation_time() / tau, 1, 0.2);
+  EXPECT_NEAR(A.autocorrelation_time(10), A.variance(10) * 1024 / A.variance(0) / 2 - 0.5, 1.e-10);
+  EXPECT_NEAR(A.error(10), std::sqrt(A.variance(10) / A.n_blocks(10)), 1.e-14);
+  EXPECT_THROW(log_binning<double>{}.autocorrelation_time(), triqs::runtime_error);
+}
+
+// ------------------------
+
+TEST(LogBinning, Bins) {
+  int N  = 1000;
+  auto a = correlated_gaussian_vector(N, 12, 5, 0);
+
+  log_binning<double> A(16), B(16);
+  for (auto x : a) {
+    A << x;
+    B << 2;
+  }
+
+  // 1000 = 15 * 64 + 40 measures
+  EXPECT_EQ(A.bin_size(), 64);
+  EXPECT_EQ(A.size(), 15);
+  auto b = make_binned_series(a, 64);
+  for (int i = 0; i < A.size(); ++i) EXPECT_NEAR(A[i], b[i], 1.e-12);
+
+  // jackknife on the bins, also in the expressions
+  auto r = average_and_error(A);
+  auto s = empirical_average_and_error(make_jackknife(make_binned_series(a, 64)));
+  EXPECT_NEAR(r.value, s.value, 1.e-12);
+  EXPECT_NEAR(r.error_bar, s.error_bar, 1.e-12);
+
+  auto q = average_and_error(A / B);
+  EXPECT_NEAR(q.value, r.value / 2, 1.e-12);
+  EXPECT_NEAR(q.error_bar, r.error_bar / 2, 1.e-12);
+
+  EXPECT_THROW(log_binning<double>(15), triqs::runtime_error);
+}
+
+// ------------------------
+
+TEST(LogBinning, H5) {
+  auto a = correlated_gaussian_vector(2000, 3, 5, 1);
+
+  log_binning<double> A(8), B;
+  for (int i = 0; i < 1001; ++i) A << a[i];
+  {
+    h5::file file("log_binning.h5", 'w');
+    h5_write(file, "A", A);
+  }
+  {
+    h5::file file("log_binning.h5", 'r');
+    h5_read(file, "A", B);
+  }
+
+  // B continues the accumulation exactly as A
+  for (int i = 1001; i < 2000; ++i) {
+    A << a[i];
+    B << a[i];
+  }
+  EXPECT_EQ(B.n_measures(), A.n_measures());
+  EXPECT_EQ(B.mean(), A.mean());
+  for (int l = 0; l < A.n_levels(); ++l) EXPECT_EQ(B.n_blocks(l), A.n_blocks(l));
+  EXPECT_EQ(B.variance(5), A.variance(5));
+  EXPECT_EQ(B.bin_size(), A.bin_size());
+  EXPECT_EQ(B.bins(), A.bins());
+}
+
+// ------------------------
+
+TEST(LogBinning, MpiReduce) {
+  mpi::communicator world;
+
+  // the same series on all nodes
+  auto a = correlated_gaussian_vector(5000, 7, 5, 1);
+  log_binning<double> A(32);
+  for (auto x : a) A << x;
+
+  auto R = mpi::all_reduce(A, world);
+
+  EXPECT_EQ(R.n_measures(), A.n_measures() * world.size());
+  EXPECT_NEAR(R.mean(), A.mean(), 1.e-12);
+  EXPECT_NEAR(R.variance(3), A.variance(3) * (A.n_blocks(3) - 1) * world.size() / (R.n_blocks(3) - 1), 1.e-12);
+  EXPECT_EQ(R.bin_size(), A.bin_size() * world.size());
+  EXPECT_EQ(R.size(), A.size());
+  for (int i = 0; i < R.size(); ++i) EXPECT_NEAR(R[i], A[i], 1.e-12);
+}
+
+MAKE_MAIN;
@@ -0,0 +1,154 @@
+// Copyright (c) 2020 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/statistics.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+using namespace triqs::statistics;
+
+// The measures of the node r, of size 1000 + 37 r : a correlated sign, and A = sign * x
+struct measures {
+  std::vector<double> A, sign;
+};
+
+measures make_measures(int r) {
+  boost::variate_generator<boost::mt19937, boost::normal_distribution<>> generator((boost::mt19937(100 + r)), (boost::normal_distribution<>()));
+  measures m;
+  double f = std::exp(-1 / 5.), x = 0;
+  for (int i = 0; i < 1000 + 37 * r; ++i) {
+    x        = f * x + std::sqrt(1 - f * f) * generator();
+    double s = (x > -1 ? 1 : -1);
+    m.sign.push_back(s);
+    m.A.push_back(s * (x + 2));
+  }
+  return m;
+}
+
+// Serial reference : the bins of all the nodes, with their sums and numbers of measures, for A and sign
+struct bins_t {
+  std::vector<double> SA, Ss;
+  std::vector<long> n;
+  bins_t(int nb) : SA(nb, 0), Ss(nb, 0), n(nb, 0) {}
+
+  void add(std::vector<double> const &A, std::vector<double> const &s, long weight) {
+    long N = A.size(), nb = n.size();
+    for (long b = 0; b < nb; ++b)
+      for (long i = b * N / nb; i < (b + 1) * N / nb; ++i) {
+        SA[b] += weight * A[i];
+        Ss[b] += weight * s[i];
+        n[b] += weight;
+      }
+  }
+
+  // jackknife of <A> / <sign>
+  value_and_error_bar<double> ratio() const {
+    int nb     = n.size();
+    double SAt = 0, Sst = 0;
+    long nt    = 0;
+    for (int b = 0; b < nb; ++b) {
+      SAt += SA[b];
+      Sst += Ss[b];
+      nt += n[b];
+    }
+    std::vector<double> jack(nb);
+    for (int b = 0; b < nb; ++b) jack[b] = ((SAt - SA[b]) / (nt - n[b])) / ((Sst - Ss[b]) / (nt - n[b]));
+    return empirical_average_and_error(jack);
+  }
+};
+
+// ------------------------
+
+TEST(MpiJackknife, Observable) {
+  mpi::communicator world;
+  int nb = 16;
+
+  auto m = make_measures(world.rank());
+  observable<double> A, sign;
+  for (int i = 0; i < m.A.size(); ++i) {
+    A << m.A[i];
+    sign << m.sign[i];
+  }
+
+  bins_t ref(nb);
+  for (int r = 0; r < world.size(); ++r) {
+    auto mr = make_measures(r);
+    ref.add(mr.A, mr.sign, 1);
+  }
+  auto ve_ref = ref.ratio();
+
+  auto ve = mpi_average_and_error(A / sign, world, nb);
+  EXPECT_NEAR(ve.value, ve_ref.value, 1.e-12);
+  EXPECT_NEAR(ve.error_bar, ve_ref.error_bar, 1.e-12);
+
+  // a single observable : A / 1
+  bins_t ref1(nb);
+  for (int r = 0; r < world.size(); ++r) {
+    auto mr = make_measures(r);
+    ref1.add(mr.A, std::vector<double>(mr.A.size(), 1), 1);
+  }
+  auto ve1 = mpi_average_and_error(A, world, nb);
+  EXPECT_NEAR(ve1.value, ref1.ratio().value, 1.e-12);
+  EXPECT_NEAR(ve1.error_bar, ref1.ratio().error_bar, 1.e-12);
+
+  // On one node, with bins of the same size, the usual jackknife on the binned series
+  if (world.size() == 1) {
+    observable<double> B;
+    for (int i = 0; i < 992; ++i) B << m.A[i];
+    auto ve2 = mpi_average_and_error(B, world, 16);
+    auto ve3 = average_and_error(B, 62);
+    EXPECT_NEAR(ve2.value, ve3.value, 1.e-12);
+    EXPECT_NEAR(ve2.error_bar, ve3.error_bar, 1.e-12);
+  }
+
+  // observables of different sizes on a node, too many bins
+  observable<double> C;
+  C << 1.;
+  EXPECT_THROW(mpi_average_and_error(A / C, world, nb), triqs::runtime_error);
+  EXPECT_THROW(mpi_average_and_error(C, world, nb), triqs::runtime_error);
+}
+
+// ------------------------
+
+TEST(MpiJackknife, LogBinning) {
+  mpi::communicator world;
+  int nb = 8;
+
+  // the nodes have bins of different sizes
+  auto make_log_binning = [](std::vector<double> const &v) {
+    log_binning<double> L(16);
+    for (auto x : v) L << x;
+    return L;
+  };
+
+  auto m = make_measures(world.rank());
+  auto A = make_log_binning(m.A), sign = make_log_binning(m.sign);
+
+  bins_t ref(nb);
+  for (int r = 0; r < world.size(); ++r) {
+    auto mr = make_measures(r);
+    auto Ar = make_log_binning(mr.A), sr = make_log_binning(mr.sign);
+    ref.add(Ar.bins(), sr.bins(), Ar.bin_size());
+  }
+  auto ve_ref = ref.ratio();
+
+  auto ve = mpi_average_and_error(A / sign, world, nb);
+  EXPECT_NEAR(ve.value, ve_ref.value, 1.e-12);
+  EXPECT_NEAR(ve.error_bar, ve_ref.error_bar, 1.e-12);
+}
+
+MAKE_MAIN;
@@ -28,4 +28,26 @@ TEST(BufferedFunction, All) {
   auto gen = triqs::utility::buffered_function<double>(f, 5);
   for (int u = 0; u < 22; ++u) EXPECT_EQ(gen(), u * u);
 }
+
+// A function which can fill the buffer at once
+struct squares {
+  int x        = 0;
+  int *n_fills = nullptr;
+  double operator()() {
+    auto res = x * x;
+    x++;
+    return res;
+  }
+  void fill(double *first, size_t n) {
+    for (size_t i = 0; i < n; ++i) first[i] = (*this)();
+    ++*n_fills;
+  }
+};
+
+TEST(BufferedFunction, Fill) {
+  int n_fills = 0;
+  auto gen    = triqs::utility::buffered_function<double>(squares{0, &n_fills}, 5);
+  for (int u = 0; u < 22; ++u) EXPECT_EQ(gen(), u * u);
+  EXPECT_EQ(n_fills, 5);
+}
 MAKE_MAIN;